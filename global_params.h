@@ -72,6 +72,14 @@ typedef struct {
 } sensor_control_mail_t;
 extern Mail<sensor_control_mail_t, 64> sensor_control_mail_box;
 
+typedef struct {
+    char* param;
+    char* value;        // raw string value, e.g. a base64 model chunk
+    char* msg_id;
+    char* endpoint_id;
+} model_update_mail_t;
+extern Mail<model_update_mail_t, 32> model_update_mail_box;
+
 /* For passing pointers to Subscription Manager Thread */
 typedef struct{
     MQTT::Client<MQTTNetwork, Countdown> **mqtt_client_ptr;
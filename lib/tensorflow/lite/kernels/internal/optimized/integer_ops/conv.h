@@ -0,0 +1,159 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_CONV_H_
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/mac.h"
+
+namespace tflite {
+namespace optimized_integer_ops {
+
+// Number of int16 values of the im2col buffer needed by ConvPerChannel().
+inline int ConvIm2ColDepth(const RuntimeShape& filter_shape) {
+  return filter_shape.Dims(1) * filter_shape.Dims(2) * filter_shape.Dims(3);
+}
+
+// Writes the receptive field of one output pixel as (input + input_offset),
+// in the OHWI order of a filter row, with zeros for the padding.
+inline void Im2ColRow(const ConvParams& params, const RuntimeShape& input_shape,
+                      const int8* input_data, int batch, int in_y_origin,
+                      int in_x_origin, int filter_height, int filter_width,
+                      int16_t* im2col_data) {
+  const int32 input_offset = params.input_offset;
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  int16_t* dst = im2col_data;
+  for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+    const int in_y = in_y_origin + params.dilation_height_factor * filter_y;
+    for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+      const int in_x = in_x_origin + params.dilation_width_factor * filter_x;
+      if ((in_x >= 0) && (in_x < input_width) && (in_y >= 0) &&
+          (in_y < input_height)) {
+        const int8* src =
+            input_data + Offset(input_shape, batch, in_y, in_x, 0);
+        for (int c = 0; c < input_depth; ++c) {
+          dst[c] = static_cast<int16_t>(src[c] + input_offset);
+        }
+      } else {
+        // Zero padding contributes nothing, as in the reference kernel.
+        for (int c = 0; c < input_depth; ++c) {
+          dst[c] = 0;
+        }
+      }
+      dst += input_depth;
+    }
+  }
+}
+
+// Output channels of one output pixel from its im2col row (ConvIm2ColDepth()
+// values, already through ReorderForDualMac()), two channels at a time.
+// filter_pairs_packed tells whether filter_data went through PackFilterPairs().
+inline void ConvPixelPerChannel(const ConvParams& params,
+                                const int32* output_multiplier,
+                                const int32* output_shift,
+                                const int16_t* im2col_data, int depth,
+                                const int8* filter_data, const int32* bias_data,
+                                int output_depth, int8* out,
+                                bool filter_pairs_packed = false) {
+  const int32 output_offset = params.output_offset;
+  const int32 output_activation_min = params.quantized_activation_min;
+  const int32 output_activation_max = params.quantized_activation_max;
+  int out_channel = 0;
+  for (; out_channel + 2 <= output_depth; out_channel += 2) {
+    int32 acc0 = bias_data ? bias_data[out_channel] : 0;
+    int32 acc1 = bias_data ? bias_data[out_channel + 1] : 0;
+    const int8* filter0 = filter_data + out_channel * depth;
+    if (filter_pairs_packed) {
+      MacInt16Int8x2Packed(im2col_data, filter0, depth, &acc0, &acc1);
+    } else {
+      MacInt16Int8x2(im2col_data, filter0, filter0 + depth, depth, &acc0,
+                     &acc1);
+    }
+    out[out_channel] = Requantize(
+        acc0, output_multiplier[out_channel], output_shift[out_channel],
+        output_offset, output_activation_min, output_activation_max);
+    out[out_channel + 1] = Requantize(
+        acc1, output_multiplier[out_channel + 1], output_shift[out_channel + 1],
+        output_offset, output_activation_min, output_activation_max);
+  }
+  if (out_channel < output_depth) {
+    int32 acc = MacInt16Int8(im2col_data, filter_data + out_channel * depth,
+                             depth, bias_data ? bias_data[out_channel] : 0);
+    out[out_channel] = Requantize(
+        acc, output_multiplier[out_channel], output_shift[out_channel],
+        output_offset, output_activation_min, output_activation_max);
+  }
+}
+
+// Fixed-point per-channel-quantization convolution, bit-exact with
+// reference_integer_ops::ConvPerChannel. The receptive field of each output
+// pixel is copied once into im2col_data (ConvIm2ColDepth() int16 values),
+// then every output channel is a dot product of that row with a filter row,
+// two channels at a time. The filter may be in the PackFilterPairs() layout.
+inline void ConvPerChannel(
+    const ConvParams& params, const int32* output_multiplier,
+    const int32* output_shift, const RuntimeShape& input_shape,
+    const int8* input_data, const RuntimeShape& filter_shape,
+    const int8* filter_data, const RuntimeShape& bias_shape,
+    const int32* bias_data, const RuntimeShape& output_shape,
+    int8* output_data, int16_t* im2col_data,
+    bool filter_pairs_packed = false) {
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  MatchingDim(input_shape, 3, filter_shape, 3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int depth = ConvIm2ColDepth(filter_shape);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin = (out_y * stride_height) - pad_height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin = (out_x * stride_width) - pad_width;
+        Im2ColRow(params, input_shape, input_data, batch, in_y_origin,
+                  in_x_origin, filter_height, filter_width, im2col_data);
+        ReorderForDualMac(im2col_data, depth);
+        ConvPixelPerChannel(
+            params, output_multiplier, output_shift, im2col_data, depth,
+            filter_data, bias_data, output_depth,
+            output_data + Offset(output_shape, batch, out_y, out_x, 0),
+            filter_pairs_packed);
+      }
+    }
+  }
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_CONV_H_
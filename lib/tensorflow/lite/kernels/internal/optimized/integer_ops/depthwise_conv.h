@@ -0,0 +1,194 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DEPTHWISE_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DEPTHWISE_CONV_H_
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/mac.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/depthwise_conv.h"
+
+namespace tflite {
+namespace optimized_integer_ops {
+
+// Whether DepthwiseConvPerChannel() takes a specialised 3x3 path: 3x3 filter,
+// depth multiplier 1, no dilation and a horizontal stride of 1 or 2.
+inline bool IsDepthwiseConv3x3(const DepthwiseParams& params,
+                               const RuntimeShape& filter_shape) {
+  return filter_shape.Dims(1) == 3 && filter_shape.Dims(2) == 3 &&
+         params.depth_multiplier == 1 && params.dilation_width_factor == 1 &&
+         params.dilation_height_factor == 1 &&
+         (params.stride_width == 1 || params.stride_width == 2);
+}
+
+// One output row of kChannels channels starting at channel. The 3x3 window of
+// (input + input_offset) slides along the row in locals, so each step loads
+// only the kStrideWidth new columns; padding is held as zeros.
+template <int kStrideWidth, int kChannels>
+inline void DepthwiseConv3x3Row(
+    const DepthwiseParams& params, const int32* output_multiplier,
+    const int32* output_shift, const RuntimeShape& input_shape,
+    const int8* input_data, const int8* filter_data, const int32* bias_data,
+    const RuntimeShape& output_shape, int8* output_data, int batch, int out_y,
+    int channel) {
+  const int32 input_offset = params.input_offset;
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int depth = input_shape.Dims(3);
+  const int output_width = output_shape.Dims(2);
+
+  const int8* rows[3];
+  const int in_y_origin = (out_y * params.stride_height) -
+                          params.padding_values.height;
+  for (int r = 0; r < 3; ++r) {
+    const int in_y = in_y_origin + r;
+    rows[r] = (in_y >= 0 && in_y < input_height)
+                  ? input_data + Offset(input_shape, batch, in_y, 0, channel)
+                  : nullptr;
+  }
+
+  int32 filter[3][3][kChannels];
+  for (int r = 0; r < 3; ++r) {
+    for (int k = 0; k < 3; ++k) {
+      for (int c = 0; c < kChannels; ++c) {
+        filter[r][k][c] = filter_data[(r * 3 + k) * depth + channel + c];
+      }
+    }
+  }
+
+  int32 window[3][3][kChannels];
+  auto load_column = [&](int col, int in_x) {
+    const bool inside_x = in_x >= 0 && in_x < input_width;
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < kChannels; ++c) {
+        window[r][col][c] = (inside_x && rows[r] != nullptr)
+                                ? rows[r][in_x * depth + c] + input_offset
+                                : 0;
+      }
+    }
+  };
+  auto move_column = [&](int to, int from) {
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < kChannels; ++c) {
+        window[r][to][c] = window[r][from][c];
+      }
+    }
+  };
+
+  int in_x_origin = -params.padding_values.width;
+  load_column(0, in_x_origin);
+  load_column(1, in_x_origin + 1);
+  load_column(2, in_x_origin + 2);
+  int8* out = output_data + Offset(output_shape, batch, out_y, 0, channel);
+  for (int out_x = 0; out_x < output_width; ++out_x) {
+    if (out_x > 0) {
+      in_x_origin += kStrideWidth;
+      if (kStrideWidth == 1) {
+        move_column(0, 1);
+        move_column(1, 2);
+      } else {
+        move_column(0, 2);
+        load_column(1, in_x_origin + 1);
+      }
+      load_column(2, in_x_origin + 2);
+    }
+    for (int c = 0; c < kChannels; ++c) {
+      int32 acc = bias_data ? bias_data[channel + c] : 0;
+      for (int r = 0; r < 3; ++r) {
+        for (int k = 0; k < 3; ++k) {
+          acc += filter[r][k][c] * window[r][k][c];
+        }
+      }
+      out[c] = Requantize(acc, output_multiplier[channel + c],
+                          output_shift[channel + c], params.output_offset,
+                          params.quantized_activation_min,
+                          params.quantized_activation_max);
+    }
+    out += depth;
+  }
+}
+
+template <int kStrideWidth>
+inline void DepthwiseConv3x3PerChannel(
+    const DepthwiseParams& params, const int32* output_multiplier,
+    const int32* output_shift, const RuntimeShape& input_shape,
+    const int8* input_data, const int8* filter_data, const int32* bias_data,
+    const RuntimeShape& output_shape, int8* output_data) {
+  // Four channels per pass keep the window and the filter in registers on
+  // Cortex-M and give the host compiler a vector to work on.
+  constexpr int kChannels = 4;
+  const int batches = input_shape.Dims(0);
+  const int depth = input_shape.Dims(3);
+  const int output_height = output_shape.Dims(1);
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      int channel = 0;
+      for (; channel + kChannels <= depth; channel += kChannels) {
+        DepthwiseConv3x3Row<kStrideWidth, kChannels>(
+            params, output_multiplier, output_shift, input_shape, input_data,
+            filter_data, bias_data, output_shape, output_data, batch, out_y,
+            channel);
+      }
+      for (; channel < depth; ++channel) {
+        DepthwiseConv3x3Row<kStrideWidth, 1>(
+            params, output_multiplier, output_shift, input_shape, input_data,
+            filter_data, bias_data, output_shape, output_data, batch, out_y,
+            channel);
+      }
+    }
+  }
+}
+
+// Fixed-point per-channel-quantization depthwise convolution, bit-exact with
+// reference_integer_ops::DepthwiseConvPerChannel. The 3x3 shapes of
+// IsDepthwiseConv3x3() run specialised kernels; every other shape runs the
+// reference kernel.
+inline void DepthwiseConvPerChannel(
+    const DepthwiseParams& params, const int32* output_multiplier,
+    const int32* output_shift, const RuntimeShape& input_shape,
+    const int8* input_data, const RuntimeShape& filter_shape,
+    const int8* filter_data, const RuntimeShape& bias_shape,
+    const int32* bias_data, const RuntimeShape& output_shape,
+    int8* output_data) {
+  if (!IsDepthwiseConv3x3(params, filter_shape)) {
+    reference_integer_ops::DepthwiseConvPerChannel(
+        params, output_multiplier, output_shift, input_shape, input_data,
+        filter_shape, filter_data, bias_shape, bias_data, output_shape,
+        output_data);
+    return;
+  }
+
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  MatchingDim(input_shape, 0, output_shape, 0);
+  MatchingDim(input_shape, 3, filter_shape, 3);
+  MatchingDim(filter_shape, 3, output_shape, 3);
+  if (params.stride_width == 1) {
+    DepthwiseConv3x3PerChannel<1>(params, output_multiplier, output_shift,
+                                  input_shape, input_data, filter_data,
+                                  bias_data, output_shape, output_data);
+  } else {
+    DepthwiseConv3x3PerChannel<2>(params, output_multiplier, output_shift,
+                                  input_shape, input_data, filter_data,
+                                  bias_data, output_shape, output_data);
+  }
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DEPTHWISE_CONV_H_
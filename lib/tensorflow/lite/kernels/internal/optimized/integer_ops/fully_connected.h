@@ -0,0 +1,96 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_FULLY_CONNECTED_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_FULLY_CONNECTED_H_
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/mac.h"
+
+namespace tflite {
+namespace optimized_integer_ops {
+
+// Precomputes the constant part of the fully-connected accumulator, once per
+// model. Expanding the reference sum
+//   sum((filter + filter_offset) * (input + input_offset)) + bias
+// gives dot(filter, input) + filter_offset * sum(input) + folded_bias, where
+//   folded_bias = bias + input_offset * sum(filter)
+//                 + accum_depth * filter_offset * input_offset.
+// folded_bias holds output_depth values; bias_data may be null.
+inline void FoldFilterSumsIntoBias(const FullyConnectedParams& params,
+                                   const RuntimeShape& filter_shape,
+                                   const int8_t* filter_data,
+                                   const int32* bias_data, int output_depth,
+                                   int32* folded_bias) {
+  const int accum_depth = filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+  for (int out_c = 0; out_c < output_depth; ++out_c) {
+    int32 filter_sum = 0;
+    for (int d = 0; d < accum_depth; ++d) {
+      filter_sum += filter_data[out_c * accum_depth + d];
+    }
+    folded_bias[out_c] = (bias_data ? bias_data[out_c] : 0) +
+                         params.input_offset * filter_sum +
+                         accum_depth * params.weights_offset *
+                             params.input_offset;
+  }
+}
+
+// Int8 fully-connected layer, bit-exact with
+// reference_integer_ops::FullyConnected, given the folded_bias computed by
+// FoldFilterSumsIntoBias() for the same parameters and filter. Only the raw
+// int8 dot product remains per output; the input sum is needed once per batch,
+// and only for asymmetric filters.
+inline void FullyConnected(const FullyConnectedParams& params,
+                           const RuntimeShape& input_shape,
+                           const int8_t* input_data,
+                           const RuntimeShape& filter_shape,
+                           const int8_t* filter_data, const int32* folded_bias,
+                           const RuntimeShape& output_shape,
+                           int8_t* output_data) {
+  const int32 filter_offset = params.weights_offset;
+  TFLITE_DCHECK_GE(filter_shape.DimensionsCount(), 2);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 2);
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  const int filter_dim_count = filter_shape.DimensionsCount();
+  const int batches = output_shape.Dims(0);
+  const int output_depth = output_shape.Dims(1);
+  TFLITE_DCHECK_LE(output_depth, filter_shape.Dims(filter_dim_count - 2));
+  const int accum_depth = filter_shape.Dims(filter_dim_count - 1);
+  for (int b = 0; b < batches; ++b) {
+    const int8_t* input = input_data + b * accum_depth;
+    int32 input_term = 0;
+    if (filter_offset != 0) {
+      int32 input_sum = 0;
+      for (int d = 0; d < accum_depth; ++d) {
+        input_sum += input[d];
+      }
+      input_term = filter_offset * input_sum;
+    }
+    for (int out_c = 0; out_c < output_depth; ++out_c) {
+      const int32 acc =
+          MacInt8Int8(input, filter_data + out_c * accum_depth, accum_depth,
+                      folded_bias[out_c] + input_term);
+      output_data[out_c + output_depth * b] = Requantize(
+          acc, params.output_multiplier, params.output_shift,
+          params.output_offset, params.quantized_activation_min,
+          params.quantized_activation_max);
+    }
+  }
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_FULLY_CONNECTED_H_
@@ -0,0 +1,329 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_MAC_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_MAC_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+
+// Cores with the DSP extension (e.g. Cortex-M4/M7) multiply two pairs of
+// 16-bit values per instruction with SMLAD. Elsewhere the portable loops below
+// are left to the compiler's auto-vectoriser.
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+#include <arm_acle.h>
+#define TFLITE_OPTIMIZED_DUAL_MAC 1
+#else
+#define TFLITE_OPTIMIZED_DUAL_MAC 0
+#endif
+
+namespace tflite {
+namespace optimized_integer_ops {
+
+// Number of leading values of an int16 vector of length depth that
+// ReorderForDualMac() permutes; the remaining tail keeps its natural order.
+inline int DualMacDepth(int depth) {
+  return TFLITE_OPTIMIZED_DUAL_MAC ? (depth & ~3) : 0;
+}
+
+// Prepares an int16 vector that will be multiplied with int8 vectors by
+// MacInt16Int8(). SXTB16 splits four int8 values into the even pair (0, 2)
+// and the odd pair (1, 3), so every group of four int16 values is stored as
+// (0, 2, 1, 3) to match. A no-op without the DSP extension.
+inline void ReorderForDualMac(int16_t* data, int depth) {
+  const int reordered = DualMacDepth(depth);
+  for (int i = 0; i < reordered; i += 4) {
+    const int16_t tmp = data[i + 1];
+    data[i + 1] = data[i + 2];
+    data[i + 2] = tmp;
+  }
+}
+
+#if TFLITE_OPTIMIZED_DUAL_MAC
+inline int32_t ReadInt32(const void* data) {
+  int32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// acc += dot(four int8 values in word, four reordered int16 values in lhs).
+inline int32_t DualMac4(uint32_t word, const int16_t* lhs, int32_t acc) {
+  acc = __smlad(__sxtb16(word), ReadInt32(lhs), acc);
+  return __smlad(__sxtb16(__ror(word, 8)), ReadInt32(lhs + 2), acc);
+}
+#endif
+
+// Returns acc + dot(lhs, rhs), where lhs went through ReorderForDualMac().
+// Bit-exact with a scalar int32 loop as long as the sum does not overflow.
+inline int32_t MacInt16Int8(const int16_t* lhs, const int8_t* rhs, int depth,
+                            int32_t acc) {
+  int i = 0;
+#if TFLITE_OPTIMIZED_DUAL_MAC
+  for (; i < DualMacDepth(depth); i += 4) {
+    acc = DualMac4(ReadInt32(rhs + i), lhs + i, acc);
+  }
+#endif
+  for (; i < depth; ++i) {
+    acc += lhs[i] * rhs[i];
+  }
+  return acc;
+}
+
+// Two dot products sharing lhs, so that every lhs load feeds two MACs.
+inline void MacInt16Int8x2(const int16_t* lhs, const int8_t* rhs0,
+                           const int8_t* rhs1, int depth, int32_t* acc0,
+                           int32_t* acc1) {
+  int32_t sum0 = *acc0;
+  int32_t sum1 = *acc1;
+  int i = 0;
+#if TFLITE_OPTIMIZED_DUAL_MAC
+  for (; i < DualMacDepth(depth); i += 4) {
+    const int32_t lhs02 = ReadInt32(lhs + i);
+    const int32_t lhs13 = ReadInt32(lhs + i + 2);
+    const uint32_t word0 = ReadInt32(rhs0 + i);
+    const uint32_t word1 = ReadInt32(rhs1 + i);
+    sum0 = __smlad(__sxtb16(word0), lhs02, sum0);
+    sum0 = __smlad(__sxtb16(__ror(word0, 8)), lhs13, sum0);
+    sum1 = __smlad(__sxtb16(word1), lhs02, sum1);
+    sum1 = __smlad(__sxtb16(__ror(word1, 8)), lhs13, sum1);
+  }
+#endif
+  for (; i < depth; ++i) {
+    sum0 += lhs[i] * rhs0[i];
+    sum1 += lhs[i] * rhs1[i];
+  }
+  *acc0 = sum0;
+  *acc1 = sum1;
+}
+
+// 2x2 block of a matrix product: acc[2 * i + j] += dot(lhs_i, rhs_j), where
+// lhs0 and lhs1 went through ReorderForDualMac(). Every load feeds two MACs.
+inline void MacInt16Int8x2x2(const int16_t* lhs0, const int16_t* lhs1,
+                             const int8_t* rhs0, const int8_t* rhs1, int depth,
+                             int32_t* acc) {
+  int32_t sum00 = acc[0];
+  int32_t sum01 = acc[1];
+  int32_t sum10 = acc[2];
+  int32_t sum11 = acc[3];
+  int i = 0;
+#if TFLITE_OPTIMIZED_DUAL_MAC
+  for (; i < DualMacDepth(depth); i += 4) {
+    const uint32_t word0 = ReadInt32(rhs0 + i);
+    const uint32_t word1 = ReadInt32(rhs1 + i);
+    const int32_t rhs0_even = __sxtb16(word0);
+    const int32_t rhs0_odd = __sxtb16(__ror(word0, 8));
+    const int32_t rhs1_even = __sxtb16(word1);
+    const int32_t rhs1_odd = __sxtb16(__ror(word1, 8));
+    const int32_t lhs0_even = ReadInt32(lhs0 + i);
+    const int32_t lhs0_odd = ReadInt32(lhs0 + i + 2);
+    const int32_t lhs1_even = ReadInt32(lhs1 + i);
+    const int32_t lhs1_odd = ReadInt32(lhs1 + i + 2);
+    sum00 = __smlad(rhs0_even, lhs0_even, sum00);
+    sum00 = __smlad(rhs0_odd, lhs0_odd, sum00);
+    sum01 = __smlad(rhs1_even, lhs0_even, sum01);
+    sum01 = __smlad(rhs1_odd, lhs0_odd, sum01);
+    sum10 = __smlad(rhs0_even, lhs1_even, sum10);
+    sum10 = __smlad(rhs0_odd, lhs1_odd, sum10);
+    sum11 = __smlad(rhs1_even, lhs1_even, sum11);
+    sum11 = __smlad(rhs1_odd, lhs1_odd, sum11);
+  }
+#endif
+  for (; i < depth; ++i) {
+    sum00 += lhs0[i] * rhs0[i];
+    sum01 += lhs0[i] * rhs1[i];
+    sum10 += lhs1[i] * rhs0[i];
+    sum11 += lhs1[i] * rhs1[i];
+  }
+  acc[0] = sum00;
+  acc[1] = sum01;
+  acc[2] = sum10;
+  acc[3] = sum11;
+}
+
+// Filter rows are read two output channels at a time by MacInt16Int8x2() and
+// MacInt16Int8x2x2(). PackFilterPairs() interleaves each pair of rows in
+// blocks of four values (row 0, then row 1), with the tails of both rows at
+// the end of the pair, so that the *Packed variants below read the pair as a
+// single sequential stream. Pairs keep their offset of out_channel * depth and
+// an odd last row is copied as is.
+inline void PackFilterPairs(const int8_t* filter_data, int output_depth,
+                            int depth, int8_t* packed_data) {
+  const int blocked = depth & ~3;
+  const int tail = depth - blocked;
+  int out_channel = 0;
+  for (; out_channel + 2 <= output_depth; out_channel += 2) {
+    const int8_t* row0 = filter_data + out_channel * depth;
+    const int8_t* row1 = row0 + depth;
+    int8_t* dst = packed_data + out_channel * depth;
+    for (int i = 0; i < blocked; i += 4) {
+      std::memcpy(dst, row0 + i, 4);
+      std::memcpy(dst + 4, row1 + i, 4);
+      dst += 8;
+    }
+    std::memcpy(dst, row0 + blocked, tail);
+    std::memcpy(dst + tail, row1 + blocked, tail);
+  }
+  if (out_channel < output_depth) {
+    std::memcpy(packed_data + out_channel * depth,
+                filter_data + out_channel * depth, depth);
+  }
+}
+
+// MacInt16Int8x2() on a pair of filter rows packed by PackFilterPairs().
+inline void MacInt16Int8x2Packed(const int16_t* lhs, const int8_t* rhs_pair,
+                                 int depth, int32_t* acc0, int32_t* acc1) {
+  const int blocked = depth & ~3;
+  int32_t sum0 = *acc0;
+  int32_t sum1 = *acc1;
+  int i = 0;
+#if TFLITE_OPTIMIZED_DUAL_MAC
+  for (; i < blocked; i += 4) {
+    const int32_t lhs02 = ReadInt32(lhs + i);
+    const int32_t lhs13 = ReadInt32(lhs + i + 2);
+    const uint32_t word0 = ReadInt32(rhs_pair + 2 * i);
+    const uint32_t word1 = ReadInt32(rhs_pair + 2 * i + 4);
+    sum0 = __smlad(__sxtb16(word0), lhs02, sum0);
+    sum0 = __smlad(__sxtb16(__ror(word0, 8)), lhs13, sum0);
+    sum1 = __smlad(__sxtb16(word1), lhs02, sum1);
+    sum1 = __smlad(__sxtb16(__ror(word1, 8)), lhs13, sum1);
+  }
+#else
+  for (; i < blocked; i += 4) {
+    for (int k = 0; k < 4; ++k) {
+      sum0 += lhs[i + k] * rhs_pair[2 * i + k];
+      sum1 += lhs[i + k] * rhs_pair[2 * i + 4 + k];
+    }
+  }
+#endif
+  const int8_t* tail0 = rhs_pair + 2 * blocked;
+  const int8_t* tail1 = tail0 + (depth - blocked);
+  for (; i < depth; ++i) {
+    sum0 += lhs[i] * tail0[i - blocked];
+    sum1 += lhs[i] * tail1[i - blocked];
+  }
+  *acc0 = sum0;
+  *acc1 = sum1;
+}
+
+// MacInt16Int8x2x2() on a pair of filter rows packed by PackFilterPairs().
+inline void MacInt16Int8x2x2Packed(const int16_t* lhs0, const int16_t* lhs1,
+                                   const int8_t* rhs_pair, int depth,
+                                   int32_t* acc) {
+  const int blocked = depth & ~3;
+  int32_t sum00 = acc[0];
+  int32_t sum01 = acc[1];
+  int32_t sum10 = acc[2];
+  int32_t sum11 = acc[3];
+  int i = 0;
+#if TFLITE_OPTIMIZED_DUAL_MAC
+  for (; i < blocked; i += 4) {
+    const uint32_t word0 = ReadInt32(rhs_pair + 2 * i);
+    const uint32_t word1 = ReadInt32(rhs_pair + 2 * i + 4);
+    const int32_t rhs0_even = __sxtb16(word0);
+    const int32_t rhs0_odd = __sxtb16(__ror(word0, 8));
+    const int32_t rhs1_even = __sxtb16(word1);
+    const int32_t rhs1_odd = __sxtb16(__ror(word1, 8));
+    const int32_t lhs0_even = ReadInt32(lhs0 + i);
+    const int32_t lhs0_odd = ReadInt32(lhs0 + i + 2);
+    const int32_t lhs1_even = ReadInt32(lhs1 + i);
+    const int32_t lhs1_odd = ReadInt32(lhs1 + i + 2);
+    sum00 = __smlad(rhs0_even, lhs0_even, sum00);
+    sum00 = __smlad(rhs0_odd, lhs0_odd, sum00);
+    sum01 = __smlad(rhs1_even, lhs0_even, sum01);
+    sum01 = __smlad(rhs1_odd, lhs0_odd, sum01);
+    sum10 = __smlad(rhs0_even, lhs1_even, sum10);
+    sum10 = __smlad(rhs0_odd, lhs1_odd, sum10);
+    sum11 = __smlad(rhs1_even, lhs1_even, sum11);
+    sum11 = __smlad(rhs1_odd, lhs1_odd, sum11);
+  }
+#else
+  for (; i < blocked; i += 4) {
+    for (int k = 0; k < 4; ++k) {
+      const int32_t rhs0 = rhs_pair[2 * i + k];
+      const int32_t rhs1 = rhs_pair[2 * i + 4 + k];
+      sum00 += lhs0[i + k] * rhs0;
+      sum01 += lhs0[i + k] * rhs1;
+      sum10 += lhs1[i + k] * rhs0;
+      sum11 += lhs1[i + k] * rhs1;
+    }
+  }
+#endif
+  const int8_t* tail0 = rhs_pair + 2 * blocked;
+  const int8_t* tail1 = tail0 + (depth - blocked);
+  for (; i < depth; ++i) {
+    sum00 += lhs0[i] * tail0[i - blocked];
+    sum01 += lhs0[i] * tail1[i - blocked];
+    sum10 += lhs1[i] * tail0[i - blocked];
+    sum11 += lhs1[i] * tail1[i - blocked];
+  }
+  acc[0] = sum00;
+  acc[1] = sum01;
+  acc[2] = sum10;
+  acc[3] = sum11;
+}
+
+// Returns acc + dot(lhs, rhs) of two int8 vectors, in natural order. Four
+// independent accumulators break the dependency chain between MACs.
+inline int32_t MacInt8Int8(const int8_t* lhs, const int8_t* rhs, int depth,
+                           int32_t acc) {
+  int32_t sum0 = 0;
+  int32_t sum1 = 0;
+  int32_t sum2 = 0;
+  int32_t sum3 = 0;
+  int i = 0;
+#if TFLITE_OPTIMIZED_DUAL_MAC
+  for (; i + 8 <= depth; i += 8) {
+    const uint32_t lhs0 = ReadInt32(lhs + i);
+    const uint32_t rhs0 = ReadInt32(rhs + i);
+    const uint32_t lhs1 = ReadInt32(lhs + i + 4);
+    const uint32_t rhs1 = ReadInt32(rhs + i + 4);
+    sum0 = __smlad(__sxtb16(lhs0), __sxtb16(rhs0), sum0);
+    sum1 = __smlad(__sxtb16(__ror(lhs0, 8)), __sxtb16(__ror(rhs0, 8)), sum1);
+    sum2 = __smlad(__sxtb16(lhs1), __sxtb16(rhs1), sum2);
+    sum3 = __smlad(__sxtb16(__ror(lhs1, 8)), __sxtb16(__ror(rhs1, 8)), sum3);
+  }
+#else
+  for (; i + 4 <= depth; i += 4) {
+    sum0 += lhs[i] * rhs[i];
+    sum1 += lhs[i + 1] * rhs[i + 1];
+    sum2 += lhs[i + 2] * rhs[i + 2];
+    sum3 += lhs[i + 3] * rhs[i + 3];
+  }
+#endif
+  for (; i < depth; ++i) {
+    sum0 += lhs[i] * rhs[i];
+  }
+  return acc + ((sum0 + sum1) + (sum2 + sum3));
+}
+
+// Output stage shared by the optimized kernels, identical to the reference
+// kernels: rescale the accumulator, add the output zero point and clamp.
+inline int8_t Requantize(int32_t acc, int32_t output_multiplier,
+                         int32_t output_shift, int32_t output_offset,
+                         int32_t output_activation_min,
+                         int32_t output_activation_max) {
+  acc = MultiplyByQuantizedMultiplier(acc, output_multiplier, output_shift);
+  acc += output_offset;
+  acc = std::max(acc, output_activation_min);
+  acc = std::min(acc, output_activation_max);
+  return static_cast<int8_t>(acc);
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_MAC_H_
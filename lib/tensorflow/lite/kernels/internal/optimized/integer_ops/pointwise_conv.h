@@ -0,0 +1,144 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_POINTWISE_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_POINTWISE_CONV_H_
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/mac.h"
+
+namespace tflite {
+namespace optimized_integer_ops {
+
+// Whether a convolution is a plain matrix product: a 1x1 filter with stride 1
+// and no padding, so output pixel p only reads input pixel p.
+inline bool IsPointwiseConv(const ConvParams& params,
+                            const RuntimeShape& filter_shape) {
+  return filter_shape.Dims(1) == 1 && filter_shape.Dims(2) == 1 &&
+         params.stride_width == 1 && params.stride_height == 1 &&
+         params.padding_values.width == 0 && params.padding_values.height == 0;
+}
+
+// Number of int16 values of the packing buffer needed by
+// PointwiseConvPerChannel(): two packed input pixels.
+inline int PointwiseConvPackDepth(const RuntimeShape& filter_shape) {
+  return 2 * filter_shape.Dims(3);
+}
+
+inline void PackPointwiseRow(const int8* input, int depth, int32 input_offset,
+                             int16_t* packed) {
+  for (int c = 0; c < depth; ++c) {
+    packed[c] = static_cast<int16_t>(input[c] + input_offset);
+  }
+  ReorderForDualMac(packed, depth);
+}
+
+// 1x1 stride-1 convolution as a GEMM of the (pixels x input_depth) input with
+// the transposed (output_depth x input_depth) filter, bit-exact with
+// reference_integer_ops::ConvPerChannel. Pairs of input pixels are packed into
+// packed_data (PointwiseConvPackDepth() int16 values) with the input offset
+// applied, then multiplied in 2x2 register blocks of pixels and channels.
+// The filter may be in the PackFilterPairs() layout.
+inline void PointwiseConvPerChannel(
+    const ConvParams& params, const int32* output_multiplier,
+    const int32* output_shift, const RuntimeShape& input_shape,
+    const int8* input_data, const RuntimeShape& filter_shape,
+    const int8* filter_data, const RuntimeShape& bias_shape,
+    const int32* bias_data, const RuntimeShape& output_shape,
+    int8* output_data, int16_t* packed_data,
+    bool filter_pairs_packed = false) {
+  const int32 output_offset = params.output_offset;
+  const int32 output_activation_min = params.quantized_activation_min;
+  const int32 output_activation_max = params.quantized_activation_max;
+  TFLITE_DCHECK(IsPointwiseConv(params, filter_shape));
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  const int depth = MatchingDim(input_shape, 3, filter_shape, 3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  const int rows = MatchingFlatSizeSkipDim(input_shape, 3, output_shape);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+
+  auto store = [&](int8* out, int out_channel, int32 acc) {
+    out[out_channel] = Requantize(
+        acc, output_multiplier[out_channel], output_shift[out_channel],
+        output_offset, output_activation_min, output_activation_max);
+  };
+
+  int16_t* packed0 = packed_data;
+  int16_t* packed1 = packed_data + depth;
+  int row = 0;
+  for (; row + 2 <= rows; row += 2) {
+    PackPointwiseRow(input_data + row * depth, depth, params.input_offset,
+                     packed0);
+    PackPointwiseRow(input_data + (row + 1) * depth, depth,
+                     params.input_offset, packed1);
+    int8* out0 = output_data + row * output_depth;
+    int8* out1 = out0 + output_depth;
+    int out_channel = 0;
+    for (; out_channel + 2 <= output_depth; out_channel += 2) {
+      const int32 bias0 = bias_data ? bias_data[out_channel] : 0;
+      const int32 bias1 = bias_data ? bias_data[out_channel + 1] : 0;
+      int32 acc[4] = {bias0, bias1, bias0, bias1};
+      const int8* filter0 = filter_data + out_channel * depth;
+      if (filter_pairs_packed) {
+        MacInt16Int8x2x2Packed(packed0, packed1, filter0, depth, acc);
+      } else {
+        MacInt16Int8x2x2(packed0, packed1, filter0, filter0 + depth, depth,
+                         acc);
+      }
+      store(out0, out_channel, acc[0]);
+      store(out0, out_channel + 1, acc[1]);
+      store(out1, out_channel, acc[2]);
+      store(out1, out_channel + 1, acc[3]);
+    }
+    if (out_channel < output_depth) {
+      const int32 bias0 = bias_data ? bias_data[out_channel] : 0;
+      const int8* filter0 = filter_data + out_channel * depth;
+      store(out0, out_channel, MacInt16Int8(packed0, filter0, depth, bias0));
+      store(out1, out_channel, MacInt16Int8(packed1, filter0, depth, bias0));
+    }
+  }
+  if (row < rows) {
+    PackPointwiseRow(input_data + row * depth, depth, params.input_offset,
+                     packed0);
+    int8* out0 = output_data + row * output_depth;
+    int out_channel = 0;
+    for (; out_channel + 2 <= output_depth; out_channel += 2) {
+      int32 acc0 = bias_data ? bias_data[out_channel] : 0;
+      int32 acc1 = bias_data ? bias_data[out_channel + 1] : 0;
+      const int8* filter0 = filter_data + out_channel * depth;
+      if (filter_pairs_packed) {
+        MacInt16Int8x2Packed(packed0, filter0, depth, &acc0, &acc1);
+      } else {
+        MacInt16Int8x2(packed0, filter0, filter0 + depth, depth, &acc0, &acc1);
+      }
+      store(out0, out_channel, acc0);
+      store(out0, out_channel + 1, acc1);
+    }
+    if (out_channel < output_depth) {
+      store(out0, out_channel,
+            MacInt16Int8(packed0, filter_data + out_channel * depth, depth,
+                         bias_data ? bias_data[out_channel] : 0));
+    }
+  }
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_POINTWISE_CONV_H_
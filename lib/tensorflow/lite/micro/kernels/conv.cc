@@ -18,15 +18,22 @@ limitations under the License.
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/pointwise_conv.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/conv.h"
+#include "tensorflow/lite/micro/kernels/filter_repack.h"
 
 namespace tflite {
 namespace ops {
 namespace micro {
+
+int16_t im2col_buffer[kMaxIm2ColDepth];
+
 namespace conv {
 
 constexpr int kInputTensor = 0;
@@ -40,23 +47,6 @@ constexpr int kConvQuantizedDimension = 0;
 
 // This file has 2 implementation of Conv.
 
-struct OpData {
-  TfLitePaddingValues padding;
-  // The scaling factor from input to output (aka the 'real multiplier') can
-  // be represented as a fixed point multiplier plus a left shift.
-  int32_t output_multiplier;
-  int output_shift;
-
-  // Per channel output multiplier and shift.
-  int32_t* per_channel_output_multiplier;
-  int32_t* per_channel_output_shift;
-
-  // The range of the fused activation layer. For example for kNone and
-  // uint8_t these would be 0 and 255.
-  int32_t output_activation_min;
-  int32_t output_activation_max;
-};
-
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
   switch (padding) {
     case TfLitePadding::kTfLitePaddingSame:
@@ -163,9 +153,26 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                       affine_quantization->zero_point->size);
   }
 
-  return CalculateOpData(context, node, params, input_width, input_height,
-                         filter_width, filter_height, output_width,
-                         output_height, input->type, data);
+  TF_LITE_ENSURE_STATUS(CalculateOpData(
+      context, node, params, input_width, input_height, filter_width,
+      filter_height, output_width, output_height, input->type, data));
+
+  data->packed_filter = nullptr;
+#if defined(TF_LITE_MICRO_OPTIMIZED_KERNELS) && TF_LITE_MICRO_OPTIMIZED_KERNELS
+  // Only constant filters of layers that run on the optimized kernels.
+  if (input->type == kTfLiteInt8 && filter->allocation_type == kTfLiteMmapRo &&
+      optimized_integer_ops::ConvIm2ColDepth(GetTensorShape(filter)) <=
+          kMaxIm2ColDepth &&
+      ShouldRepackFilter(filter->bytes, output_height * output_width)) {
+    TF_LITE_ENSURE_STATUS(context->AllocatePersistentBuffer(
+        context, filter->bytes,
+        reinterpret_cast<void**>(&data->packed_filter)));
+    optimized_integer_ops::PackFilterPairs(
+        GetTensorData<int8_t>(filter), num_channels,
+        filter->bytes / num_channels, data->packed_filter);
+  }
+#endif
+  return kTfLiteOk;
 }  // namespace conv
 
 void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
@@ -220,6 +227,35 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
   op_params.quantized_activation_min = data.output_activation_min;
   op_params.quantized_activation_max = data.output_activation_max;
 
+#if defined(TF_LITE_MICRO_OPTIMIZED_KERNELS) && TF_LITE_MICRO_OPTIMIZED_KERNELS
+  const RuntimeShape filter_shape = GetTensorShape(filter);
+  const bool filter_pairs_packed = data.packed_filter != nullptr;
+  const int8* filter_data = filter_pairs_packed ? data.packed_filter
+                                                : GetTensorData<int8>(filter);
+  if (optimized_integer_ops::IsPointwiseConv(op_params, filter_shape) &&
+      optimized_integer_ops::PointwiseConvPackDepth(filter_shape) <=
+          kMaxIm2ColDepth) {
+    optimized_integer_ops::PointwiseConvPerChannel(
+        op_params, data.per_channel_output_multiplier,
+        data.per_channel_output_shift, GetTensorShape(input),
+        GetTensorData<int8>(input), filter_shape, filter_data,
+        GetTensorShape(bias), GetTensorData<int32>(bias),
+        GetTensorShape(output), GetTensorData<int8>(output), im2col_buffer,
+        filter_pairs_packed);
+    return;
+  }
+  if (optimized_integer_ops::ConvIm2ColDepth(filter_shape) <=
+      kMaxIm2ColDepth) {
+    optimized_integer_ops::ConvPerChannel(
+        op_params, data.per_channel_output_multiplier,
+        data.per_channel_output_shift, GetTensorShape(input),
+        GetTensorData<int8>(input), filter_shape, filter_data,
+        GetTensorShape(bias), GetTensorData<int32>(bias),
+        GetTensorShape(output), GetTensorData<int8>(output), im2col_buffer,
+        filter_pairs_packed);
+    return;
+  }
+#endif
   reference_integer_ops::ConvPerChannel(
       op_params, data.per_channel_output_multiplier,
       data.per_channel_output_shift, GetTensorShape(input),
@@ -0,0 +1,68 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_CONV_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_CONV_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+
+// Largest receptive field of one output pixel, in values, that the optimized
+// int8 convolution kernels take; larger filters fall back to the reference
+// kernel or are not fused.
+constexpr int kMaxIm2ColDepth = 1024;
+
+// im2col row of the optimized int8 kernel, or the packed input pixels of the
+// pointwise one. Nodes are invoked one at a time, so every CONV_2D and fused
+// convolution node shares it. Defined in conv.cc.
+extern int16_t im2col_buffer[kMaxIm2ColDepth];
+
+namespace conv {
+
+// User data of a CONV_2D node. Fused convolution nodes read the per-channel
+// parameters and activation range of the CONV_2D they replace from it.
+struct OpData {
+  TfLitePaddingValues padding;
+  // The scaling factor from input to output (aka the 'real multiplier') can
+  // be represented as a fixed point multiplier plus a left shift.
+  int32_t output_multiplier;
+  int output_shift;
+
+  // Per channel output multiplier and shift.
+  int32_t* per_channel_output_multiplier;
+  int32_t* per_channel_output_shift;
+
+  // Copy of the int8 filter in the PackFilterPairs() layout, or nullptr when
+  // the kernel reads the filter from the model.
+  int8_t* packed_filter;
+
+  // The range of the fused activation layer. For example for kNone and
+  // uint8_t these would be 0 and 255.
+  int32_t output_activation_min;
+  int32_t output_activation_max;
+};
+
+}  // namespace conv
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_CONV_H_
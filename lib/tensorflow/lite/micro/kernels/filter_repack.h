@@ -0,0 +1,47 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_FILTER_REPACK_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_FILTER_REPACK_H_
+
+// Largest filter, in bytes, that a layer copies into the arena in the
+// PackFilterPairs() layout at Prepare. 0 disables repacking.
+#ifndef TF_LITE_MICRO_REPACK_MAX_FILTER_BYTES
+#define TF_LITE_MICRO_REPACK_MAX_FILTER_BYTES 0
+#endif
+
+namespace tflite {
+namespace ops {
+namespace micro {
+
+// Output pixels below which a layer reads its filter too few times per
+// inference for a copy in the arena to pay off.
+constexpr int kMinRepackOutputPixels = 16;
+
+// Whether a convolution keeps a repacked copy of its filter in the arena. The
+// copy costs filter_bytes of arena for the life of the model and turns the
+// filter reads of every output pixel from two flash streams into one
+// sequential stream from RAM, so small filters of layers with many output
+// pixels gain the most per byte.
+inline bool ShouldRepackFilter(int filter_bytes, int output_pixels) {
+  return filter_bytes <= TF_LITE_MICRO_REPACK_MAX_FILTER_BYTES &&
+         output_pixels >= kMinRepackOutputPixels;
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_FILTER_REPACK_H_
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -40,6 +41,9 @@ struct OpData {
   int32_t output_activation_max;
   // The index of the temporary tensor where the quantized inputs are cached.
   int input_quantized_index;
+  // Int8 bias with the filter sums folded in at Prepare, or nullptr to run the
+  // reference kernel.
+  int32_t* folded_bias;
 };
 
 constexpr int kInputTensor = 0;
@@ -97,6 +101,24 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_MSG(context, input->type == filter->type,
                      "Hybrid models are not supported on TFLite Micro.");
 
+  data->folded_bias = nullptr;
+#if defined(TF_LITE_MICRO_OPTIMIZED_KERNELS) && TF_LITE_MICRO_OPTIMIZED_KERNELS
+  // The filter sums can only be folded once if filter and bias are constant.
+  if (input->type == kTfLiteInt8 && filter->allocation_type == kTfLiteMmapRo &&
+      (bias == nullptr || bias->allocation_type == kTfLiteMmapRo)) {
+    const int output_depth = SizeOfDimension(filter, 0);
+    TF_LITE_ENSURE_STATUS(context->AllocatePersistentBuffer(
+        context, output_depth * sizeof(int32_t),
+        reinterpret_cast<void**>(&data->folded_bias)));
+    tflite::FullyConnectedParams op_params;
+    op_params.input_offset = -input->params.zero_point;
+    op_params.weights_offset = -filter->params.zero_point;
+    optimized_integer_ops::FoldFilterSumsIntoBias(
+        op_params, GetTensorShape(filter), GetTensorData<int8_t>(filter),
+        GetTensorData<int32_t>(bias), output_depth, data->folded_bias);
+  }
+#endif
+
   return CalculateOpData(context, params->activation, input->type, input,
                          filter, bias, output, data);
 }
@@ -115,6 +137,16 @@ TfLiteStatus EvalQuantizedInt8(TfLiteContext* context, TfLiteNode* node,
   op_params.quantized_activation_min = data.output_activation_min;
   op_params.quantized_activation_max = data.output_activation_max;
 
+#if defined(TF_LITE_MICRO_OPTIMIZED_KERNELS) && TF_LITE_MICRO_OPTIMIZED_KERNELS
+  if (data.folded_bias != nullptr) {
+    optimized_integer_ops::FullyConnected(
+        op_params, GetTensorShape(input), GetTensorData<int8_t>(input),
+        GetTensorShape(filter), GetTensorData<int8_t>(filter),
+        data.folded_bias, GetTensorShape(output),
+        GetTensorData<int8_t>(output));
+    return kTfLiteOk;
+  }
+#endif
   reference_integer_ops::FullyConnected(
       op_params, GetTensorShape(input), GetTensorData<int8_t>(input),
       GetTensorShape(filter), GetTensorData<int8_t>(filter),
@@ -0,0 +1,257 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernels/fused_conv.h"
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/add.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/conv.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace fused_conv {
+
+// Nodes are invoked one at a time, so every fused node shares it, as it shares
+// im2col_buffer with the CONV_2D nodes.
+int8_t conv_output_buffer[kMaxOutputDepth];
+
+struct OpData {
+  ConvParams conv_params;
+  // User data of the CONV_2D this node replaces, which holds the per channel
+  // output multiplier and shift of the convolution.
+  const conv::OpData* conv_data;
+
+  bool has_residual;
+  ArithmeticParams add_params;
+};
+
+// Same arithmetic as add::CalculateOpData(), for the non-broadcast int8 case.
+TfLiteStatus CalculateAddParams(TfLiteContext* context,
+                                const TfLiteAddParams* params,
+                                const TfLiteTensor* input1,
+                                const TfLiteTensor* input2,
+                                TfLiteTensor* output,
+                                ArithmeticParams* op_params) {
+  op_params->input1_offset = -input1->params.zero_point;
+  op_params->input2_offset = -input2->params.zero_point;
+  op_params->output_offset = output->params.zero_point;
+  op_params->left_shift = 20;
+  const double twice_max_input_scale =
+      2 * static_cast<double>(
+              std::max(input1->params.scale, input2->params.scale));
+  const double real_input1_multiplier =
+      static_cast<double>(input1->params.scale) / twice_max_input_scale;
+  const double real_input2_multiplier =
+      static_cast<double>(input2->params.scale) / twice_max_input_scale;
+  const double real_output_multiplier =
+      twice_max_input_scale / ((1 << op_params->left_shift) *
+                               static_cast<double>(output->params.scale));
+
+  QuantizeMultiplierSmallerThanOneExp(real_input1_multiplier,
+                                      &op_params->input1_multiplier,
+                                      &op_params->input1_shift);
+  QuantizeMultiplierSmallerThanOneExp(real_input2_multiplier,
+                                      &op_params->input2_multiplier,
+                                      &op_params->input2_shift);
+  QuantizeMultiplierSmallerThanOneExp(real_output_multiplier,
+                                      &op_params->output_multiplier,
+                                      &op_params->output_shift);
+
+  int32_t output_activation_min;
+  int32_t output_activation_max;
+  TF_LITE_ENSURE_STATUS(CalculateActivationRangeQuantized(
+      context, params->activation, output, &output_activation_min,
+      &output_activation_max));
+  SetActivationParams(output_activation_min, output_activation_max, op_params);
+  return kTfLiteOk;
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  TFLITE_DCHECK(buffer == nullptr || length == sizeof(conv::OpData));
+  void* data = nullptr;
+  if (context->AllocatePersistentBuffer(context, sizeof(OpData), &data) ==
+      kTfLiteError) {
+    return nullptr;
+  }
+  static_cast<OpData*>(data)->conv_data =
+      reinterpret_cast<const conv::OpData*>(buffer);
+  return data;
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  TFLITE_DCHECK(node->builtin_data != nullptr);
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), kNumInputs);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  TF_LITE_ENSURE(context, node->intermediates != nullptr &&
+                              node->intermediates->size == 1);
+
+  OpData* data = static_cast<OpData*>(node->user_data);
+  TF_LITE_ENSURE(context, data->conv_data != nullptr);
+  const auto params = static_cast<const TfLiteConvParams*>(node->builtin_data);
+
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  const TfLiteTensor* filter = GetInput(context, node, kFilterTensor);
+  const TfLiteTensor* paddings =
+      GetOptionalInputTensor(context, node, kPaddingsTensor);
+  const TfLiteTensor* residual =
+      GetOptionalInputTensor(context, node, kResidualTensor);
+  TfLiteTensor* conv_output =
+      &context->tensors[node->intermediates->data[kConvOutputTensor]];
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+  TF_LITE_ENSURE_EQ(context, input->type, kTfLiteInt8);
+  TF_LITE_ENSURE_EQ(context, output->type, kTfLiteInt8);
+
+  const int output_depth = filter->dims->data[0];
+  TF_LITE_ENSURE(context, filter->dims->data[1] * filter->dims->data[2] *
+                                  filter->dims->data[3] <=
+                              kMaxIm2ColDepth);
+
+  // The PAD operator, if fused, only ever pads the height and width.
+  ConvParams& conv_params = data->conv_params;
+  if (paddings != nullptr) {
+    const int32_t* paddings_data = GetTensorData<int32_t>(paddings);
+    conv_params.padding_values.height = paddings_data[2];
+    conv_params.padding_values.width = paddings_data[4];
+  } else {
+    int out_height, out_width;
+    const TfLitePaddingValues padding = ComputePaddingHeightWidth(
+        params->stride_height, params->stride_width,
+        params->dilation_height_factor, params->dilation_width_factor,
+        input->dims->data[1], input->dims->data[2], filter->dims->data[1],
+        filter->dims->data[2], params->padding, &out_height, &out_width);
+    conv_params.padding_values.height = padding.height;
+    conv_params.padding_values.width = padding.width;
+  }
+  conv_params.stride_height = params->stride_height;
+  conv_params.stride_width = params->stride_width;
+  conv_params.dilation_height_factor = params->dilation_height_factor;
+  conv_params.dilation_width_factor = params->dilation_width_factor;
+  conv_params.input_offset = -input->params.zero_point;
+  conv_params.output_offset = conv_output->params.zero_point;
+
+  // The fused PAD keeps the scale and zero point of its input, so the
+  // quantization parameters the CONV_2D computed in its Prepare still hold.
+  conv_params.quantized_activation_min =
+      data->conv_data->output_activation_min;
+  conv_params.quantized_activation_max =
+      data->conv_data->output_activation_max;
+
+  data->has_residual = residual != nullptr;
+  if (data->has_residual) {
+    TF_LITE_ENSURE(context, output_depth <= kMaxOutputDepth);
+    TF_LITE_ENSURE(context, HaveSameShapes(conv_output, residual));
+    TF_LITE_ENSURE(context, HaveSameShapes(conv_output, output));
+    TF_LITE_ENSURE(context, node->custom_initial_data != nullptr);
+    const auto add_params =
+        static_cast<const TfLiteAddParams*>(node->custom_initial_data);
+    TF_LITE_ENSURE_STATUS(CalculateAddParams(context, add_params, conv_output,
+                                             residual, output,
+                                             &data->add_params));
+  }
+  return kTfLiteOk;
+}
+
+// Convolves one output pixel at a time. The convolution output only lives in
+// conv_output_buffer, from which the residual ADD writes the node output, so
+// neither the padded input nor the convolution output is ever materialised.
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  const ConvParams& conv_params = data.conv_params;
+  const conv::OpData& conv_data = *data.conv_data;
+
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  const TfLiteTensor* filter = GetInput(context, node, kFilterTensor);
+  const TfLiteTensor* bias = GetOptionalInputTensor(context, node, kBiasTensor);
+  const TfLiteTensor* residual =
+      GetOptionalInputTensor(context, node, kResidualTensor);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+
+  const RuntimeShape input_shape = GetTensorShape(input);
+  const RuntimeShape filter_shape = GetTensorShape(filter);
+  const RuntimeShape output_shape = GetTensorShape(output);
+  const int8* input_data = GetTensorData<int8>(input);
+  const int8* filter_data = GetTensorData<int8>(filter);
+  const int32* bias_data = GetTensorData<int32>(bias);
+  const int8* residual_data = GetTensorData<int8>(residual);
+  int8* output_data = GetTensorData<int8>(output);
+
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int depth = optimized_integer_ops::ConvIm2ColDepth(filter_shape);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin = (out_y * conv_params.stride_height) -
+                              conv_params.padding_values.height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin = (out_x * conv_params.stride_width) -
+                                conv_params.padding_values.width;
+        optimized_integer_ops::Im2ColRow(conv_params, input_shape, input_data,
+                                         batch, in_y_origin, in_x_origin,
+                                         filter_height, filter_width,
+                                         im2col_buffer);
+        optimized_integer_ops::ReorderForDualMac(im2col_buffer, depth);
+
+        const int offset = Offset(output_shape, batch, out_y, out_x, 0);
+        int8* conv_out =
+            data.has_residual ? conv_output_buffer : output_data + offset;
+        optimized_integer_ops::ConvPixelPerChannel(
+            conv_params, conv_data.per_channel_output_multiplier,
+            conv_data.per_channel_output_shift, im2col_buffer, depth,
+            filter_data, bias_data, output_depth, conv_out);
+        if (data.has_residual) {
+          reference_integer_ops::AddElementwise(
+              output_depth, data.add_params, conv_out, residual_data + offset,
+              output_data + offset);
+        }
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace fused_conv
+
+TfLiteRegistration* Register_FUSED_CONV_2D() {
+  static TfLiteRegistration r = {/*init=*/fused_conv::Init,
+                                 /*free=*/nullptr,
+                                 /*prepare=*/fused_conv::Prepare,
+                                 /*invoke=*/fused_conv::Eval,
+                                 /*profiling_string=*/nullptr,
+                                 /*builtin_code=*/BuiltinOperator_CUSTOM,
+                                 /*custom_name=*/"FUSED_CONV_2D",
+                                 /*version=*/0};
+  return &r;
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,56 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_FUSED_CONV_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_FUSED_CONV_H_
+
+namespace tflite {
+namespace ops {
+namespace micro {
+namespace fused_conv {
+
+// Node layout of the fused int8 convolution built by FuseOperators(), which
+// runs an optional PAD, a CONV_2D and an optional residual ADD as one kernel:
+//  - inputs: the (unpadded) input, the CONV_2D filter and bias, the PAD
+//    paddings and the other ADD input, the optional ones marked with
+//    kTfLiteOptionalTensor;
+//  - outputs: the output of the last fused operator;
+//  - intermediates: the CONV_2D output, whose quantization parameters are
+//    those of the convolution, but which is never written;
+//  - builtin_data: the TfLiteConvParams of the CONV_2D;
+//  - custom_initial_data: the TfLiteAddParams of the ADD, if any.
+// Init() takes the conv::OpData of the prepared CONV_2D as its buffer; the
+// node reuses its per-channel multipliers and shifts instead of computing and
+// allocating them again.
+constexpr int kInputTensor = 0;
+constexpr int kFilterTensor = 1;
+constexpr int kBiasTensor = 2;
+constexpr int kPaddingsTensor = 3;
+constexpr int kResidualTensor = 4;
+constexpr int kNumInputs = 5;
+constexpr int kOutputTensor = 0;
+constexpr int kConvOutputTensor = 0;
+
+// Output channels of one pixel before the residual is added, the limit of the
+// kernel's static buffer. The receptive field is limited by kMaxIm2ColDepth
+// of conv.h.
+constexpr int kMaxOutputDepth = 256;
+
+}  // namespace fused_conv
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_FUSED_CONV_H_
@@ -44,6 +44,7 @@ TfLiteRegistration* Register_DEQUANTIZE();
 TfLiteRegistration* Register_EQUAL();
 TfLiteRegistration* Register_FLOOR();
 TfLiteRegistration* Register_FULLY_CONNECTED();
+TfLiteRegistration* Register_FUSED_CONV_2D();
 TfLiteRegistration* Register_GREATER();
 TfLiteRegistration* Register_GREATER_EQUAL();
 TfLiteRegistration* Register_LESS();
@@ -51,6 +51,7 @@ struct AllocationInfo {
 constexpr int kBufferAlignment = 16;
 
 constexpr char kOfflineMemAllocMetadata[] = "OfflineMemoryAllocation";
+constexpr uint32_t kOfflineMemAllocVersion = 0;
 
 // Instance of a zero-length int to pass as tensor dims for a flatbuffer
 // Tensor with no shape. Note that the second member of a TfLiteArray is a
@@ -120,7 +121,7 @@ TfLiteStatus CheckOfflinePlannedOffsets(const Model* model,
               offline_planner_offsets[j]);
         }
 
-        if (version != 1) {
+        if (version != static_cast<int>(kOfflineMemAllocVersion)) {
           TF_LITE_REPORT_ERROR(error_reporter, "Version not supported! (%d)\n",
                                version);
           return kTfLiteError;
@@ -169,8 +170,11 @@ class AllocationInfoBuilder {
   TfLiteStatus GetOfflinePlannedOffsets(
       const Model* model, const int32_t** offline_planner_offsets);
 
-  // Add allocaiton information for the tensors.
+  // Add allocaiton information for the tensors. Lifetimes are taken from the
+  // runtime nodes rather than the flatbuffer operators, so that graph rewrites
+  // done before the memory plan (e.g. operator fusion) are taken into account.
   TfLiteStatus AddTensors(const SubGraph* subgraph,
+                          const NodeAndRegistration* node_and_registrations,
                           const int32_t* offline_offsets,
                           TfLiteTensor* runtime_tensors);
 
@@ -185,6 +189,12 @@ class AllocationInfoBuilder {
   // Allocate the output AllocationInfo array from the allocator_;
   TfLiteStatus Allocate();
 
+  // Offline plans are made from the operators of the flatbuffer, and graph
+  // rewrites can change tensor lifetimes at runtime. Moves the tensors whose
+  // offline offset is misaligned, or whose planned space is also used by a
+  // tensor live at the same time, back to online planning.
+  void ReplanConflictingOfflineOffsets();
+
   ErrorReporter* reporter_ = nullptr;
   SimpleMemoryAllocator* allocator_ = nullptr;
   size_t tensor_count_ = 0;
@@ -206,9 +216,9 @@ TfLiteStatus AllocationInfoBuilder::Allocate() {
   return kTfLiteOk;
 }
 
-TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
-                                               const int32_t* offline_offsets,
-                                               TfLiteTensor* runtime_tensors) {
+TfLiteStatus AllocationInfoBuilder::AddTensors(
+    const SubGraph* subgraph, const NodeAndRegistration* node_and_registrations,
+    const int32_t* offline_offsets, TfLiteTensor* runtime_tensors) {
   // Set up allocation info for all tensors.
   for (size_t i = 0; i < tensor_count_; ++i) {
     AllocationInfo* current = &info_[i];
@@ -241,16 +251,20 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
 
   // Figure out when the first and last use of each tensor is.
   for (int i = (subgraph->operators()->size() - 1); i >= 0; --i) {
-    const auto* op = subgraph->operators()->Get(i);
-    for (size_t n = 0; n < op->inputs()->size(); ++n) {
-      const int tensor_index = op->inputs()->Get(n);
+    const TfLiteNode& node = node_and_registrations[i].node;
+    for (int n = 0; n < node.inputs->size; ++n) {
+      const int tensor_index = node.inputs->data[n];
+      // Optional inputs are marked with a negative index.
+      if (tensor_index < 0) {
+        continue;
+      }
       AllocationInfo* current = &info_[tensor_index];
       if (((current->last_used == -1) || (current->last_used < i))) {
         current->last_used = i;
       }
     }
-    for (size_t n = 0; n < op->outputs()->size(); ++n) {
-      const int tensor_index = op->outputs()->Get(n);
+    for (int n = 0; n < node.outputs->size; ++n) {
+      const int tensor_index = node.outputs->data[n];
       AllocationInfo* current = &info_[tensor_index];
       if ((current->first_created == -1) || (current->first_created > i)) {
         current->first_created = i;
@@ -263,7 +277,11 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
     AllocationInfo* current = &info_[i];
     const bool is_read_only =
         (current->first_created == -1) && (current->last_used != -1);
-    if (is_read_only) {
+    // Tensors that no node reads or writes, such as the intermediate of two
+    // fused operators, take no space in the arena.
+    const bool is_unused =
+        (current->first_created == -1) && (current->last_used == -1);
+    if (is_read_only || is_unused) {
       current->needs_allocating = false;
     }
     const bool has_partial_lifetime =
@@ -278,9 +296,52 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
       return kTfLiteError;
     }
   }
+  if (offline_offsets) {
+    ReplanConflictingOfflineOffsets();
+  }
   return kTfLiteOk;
 }
 
+void AllocationInfoBuilder::ReplanConflictingOfflineOffsets() {
+  int replanned = 0;
+  for (size_t i = 0; i < tensor_count_; ++i) {
+    AllocationInfo* current = &info_[i];
+    if (!current->needs_allocating ||
+        current->offline_offset == kOnlinePlannedBuffer) {
+      continue;
+    }
+    bool conflict = current->offline_offset < 0 ||
+                    current->offline_offset % kBufferAlignment != 0;
+    const int32_t start = current->offline_offset;
+    const int32_t end =
+        start + static_cast<int32_t>(AlignSizeUp(current->bytes,
+                                                 kBufferAlignment));
+    for (size_t j = 0; j < i && !conflict; ++j) {
+      const AllocationInfo* other = &info_[j];
+      if (!other->needs_allocating ||
+          other->offline_offset == kOnlinePlannedBuffer ||
+          other->first_created > current->last_used ||
+          other->last_used < current->first_created) {
+        continue;
+      }
+      const int32_t other_end =
+          other->offline_offset +
+          static_cast<int32_t>(AlignSizeUp(other->bytes, kBufferAlignment));
+      conflict = start < other_end && other->offline_offset < end;
+    }
+    if (conflict) {
+      current->offline_offset = kOnlinePlannedBuffer;
+      ++replanned;
+    }
+  }
+  if (replanned > 0) {
+    TF_LITE_REPORT_ERROR(reporter_,
+                         "%d offline planned tensors conflict with the "
+                         "runtime tensor lifetimes, planned online\n",
+                         replanned);
+  }
+}
+
 // The tensor offsets will be encoded in the metadata:[Metadata] field of the
 // Model. The following encoding applies:
 //
@@ -312,6 +373,14 @@ TfLiteStatus AllocationInfoBuilder::GetOfflinePlannedOffsets(
         auto* array = buffer->data();
         const uint32_t* metadata_buffer =
             reinterpret_cast<const uint32_t*>(array->data());
+        if (metadata_buffer[0] != kOfflineMemAllocVersion ||
+            metadata_buffer[1] != 0) {
+          TF_LITE_REPORT_ERROR(reporter_,
+                               "Offline planner metadata version %d for "
+                               "subgraph %d not supported\n",
+                               metadata_buffer[0], metadata_buffer[1]);
+          return kTfLiteError;
+        }
         const size_t nbr_tensors = static_cast<size_t>(metadata_buffer[2]);
         *offline_planner_offsets =
             reinterpret_cast<const int32_t*>(&metadata_buffer[3]);
@@ -621,6 +690,7 @@ TfLiteStatus MicroAllocator::StartModelAllocation(
       AllocateNodeAndRegistrations(subgraph, node_and_registrations));
   TF_LITE_ENSURE_STATUS(PrepareNodeAndRegistrationDataFromFlatbuffer(
       model, subgraph, op_resolver, *node_and_registrations));
+  node_and_registrations_ = *node_and_registrations;
 
   return kTfLiteOk;
 }
@@ -909,7 +979,8 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(const Model* model,
     const int32_t* offline_planner_offsets = nullptr;
     TF_LITE_ENSURE_STATUS(
         builder.GetOfflinePlannedOffsets(model, &offline_planner_offsets));
-    TF_LITE_ENSURE_STATUS(builder.AddTensors(subgraph, offline_planner_offsets,
+    TF_LITE_ENSURE_STATUS(builder.AddTensors(subgraph, node_and_registrations_,
+                                             offline_planner_offsets,
                                              context->tensors));
 
     TF_LITE_ENSURE_STATUS(builder.AddScratchBuffers(scratch_buffer_handles_));
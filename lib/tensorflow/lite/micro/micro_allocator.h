@@ -199,6 +199,10 @@ class MicroAllocator {
   ErrorReporter* error_reporter_;
   bool model_is_allocating_;
 
+  // Nodes of the model being allocated. The memory plan takes the tensor
+  // lifetimes from them, once every kernel has been prepared.
+  NodeAndRegistration* node_and_registrations_ = nullptr;
+
   // In reverse order for efficiency.
   // i.e. scratch_buffer_handles_[0] is the handle for the last buffer,
   // corresponding to the last RequestScratchBufferInArena call.
@@ -0,0 +1,284 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/micro/micro_fusion.h"
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/conv.h"
+#include "tensorflow/lite/micro/kernels/fused_conv.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+
+namespace tflite {
+
+namespace {
+
+namespace fused_conv = ops::micro::fused_conv;
+
+constexpr int kNoNode = -1;
+
+// Registration left on the nodes absorbed into a fused node: they have no
+// tensors and are skipped by Invoke().
+const TfLiteRegistration* FusedAwayRegistration() {
+  static TfLiteRegistration r = {/*init=*/nullptr,
+                                 /*free=*/nullptr,
+                                 /*prepare=*/nullptr,
+                                 /*invoke=*/nullptr,
+                                 /*profiling_string=*/nullptr,
+                                 /*builtin_code=*/BuiltinOperator_CUSTOM,
+                                 /*custom_name=*/"FUSED_AWAY",
+                                 /*version=*/0};
+  return &r;
+}
+
+TfLiteStatus AllocateIntArray(TfLiteContext* context, int size,
+                              TfLiteIntArray** array) {
+  TF_LITE_ENSURE_STATUS(context->AllocatePersistentBuffer(
+      context, TfLiteIntArrayGetSizeInBytes(size),
+      reinterpret_cast<void**>(array)));
+  (*array)->size = size;
+  return kTfLiteOk;
+}
+
+// Producer/consumer queries over the runtime nodes, which reflect the fusions
+// done so far. Models are small enough for linear scans at init time.
+class GraphView {
+ public:
+  GraphView(TfLiteContext* context, const SubGraph* subgraph,
+            NodeAndRegistration* node_and_registrations)
+      : context_(context),
+        subgraph_(subgraph),
+        nodes_(node_and_registrations),
+        node_count_(subgraph->operators()->size()) {}
+
+  int node_count() const { return node_count_; }
+  TfLiteNode& node(int index) const { return nodes_[index].node; }
+  TfLiteTensor* tensor(int index) const { return &context_->tensors[index]; }
+
+  bool IsBuiltin(int index, BuiltinOperator op) const {
+    return index != kNoNode && nodes_[index].registration->builtin_code == op;
+  }
+
+  // Index of the node writing the tensor, or kNoNode for graph inputs and
+  // constants.
+  int Producer(int tensor_index) const {
+    for (int i = 0; i < node_count_; ++i) {
+      const TfLiteIntArray* outputs = nodes_[i].node.outputs;
+      for (int n = 0; n < outputs->size; ++n) {
+        if (outputs->data[n] == tensor_index) {
+          return i;
+        }
+      }
+    }
+    return kNoNode;
+  }
+
+  // Index of the only node reading the tensor, or kNoNode if it is read more
+  // than once or is an output of the graph.
+  int SoleConsumer(int tensor_index) const {
+    for (size_t i = 0; i < subgraph_->outputs()->size(); ++i) {
+      if (subgraph_->outputs()->Get(i) == tensor_index) {
+        return kNoNode;
+      }
+    }
+    int consumer = kNoNode;
+    int uses = 0;
+    for (int i = 0; i < node_count_; ++i) {
+      const TfLiteIntArray* inputs = nodes_[i].node.inputs;
+      for (int n = 0; n < inputs->size; ++n) {
+        if (inputs->data[n] == tensor_index) {
+          consumer = i;
+          ++uses;
+        }
+      }
+    }
+    return uses == 1 ? consumer : kNoNode;
+  }
+
+ private:
+  TfLiteContext* context_;
+  const SubGraph* subgraph_;
+  NodeAndRegistration* nodes_;
+  int node_count_;
+};
+
+// Returns the PAD node whose output only feeds the convolution, if it pads
+// the height and width with the zero point, or kNoNode.
+int FindPaddingInput(const GraphView& graph, int conv_index) {
+  const TfLiteNode& conv = graph.node(conv_index);
+  const auto params = static_cast<const TfLiteConvParams*>(conv.builtin_data);
+  if (params->padding != kTfLitePaddingValid) {
+    return kNoNode;
+  }
+  const int pad_index = graph.Producer(conv.inputs->data[0]);
+  if (!graph.IsBuiltin(pad_index, BuiltinOperator_PAD)) {
+    return kNoNode;
+  }
+  // Without a third input, PAD pads with the output zero point.
+  const TfLiteNode& pad = graph.node(pad_index);
+  if (pad.inputs->size != 2 || pad.outputs->size != 1 ||
+      graph.SoleConsumer(pad.outputs->data[0]) != conv_index) {
+    return kNoNode;
+  }
+  const TfLiteTensor* input = graph.tensor(pad.inputs->data[0]);
+  const TfLiteTensor* paddings = graph.tensor(pad.inputs->data[1]);
+  const TfLiteTensor* output = graph.tensor(pad.outputs->data[0]);
+  if (input->type != kTfLiteInt8 || NumDimensions(input) != 4 ||
+      paddings->type != kTfLiteInt32 || !IsConstantTensor(paddings) ||
+      NumElements(paddings) != 8 ||
+      input->params.zero_point != output->params.zero_point ||
+      input->params.scale != output->params.scale) {
+    return kNoNode;
+  }
+  const int32_t* paddings_data = GetTensorData<int32_t>(paddings);
+  if (paddings_data[0] != 0 || paddings_data[1] != 0 ||
+      paddings_data[6] != 0 || paddings_data[7] != 0) {
+    return kNoNode;
+  }
+  for (int i = 2; i < 6; ++i) {
+    if (paddings_data[i] < 0) {
+      return kNoNode;
+    }
+  }
+  return pad_index;
+}
+
+// Returns the ADD node that is the only consumer of the convolution output,
+// with the other operand in *residual_index, or kNoNode. The residual must
+// already exist when the convolution runs and have the output's shape.
+int FindResidualAdd(const GraphView& graph, int conv_index,
+                    int* residual_index) {
+  const int conv_output_index = graph.node(conv_index).outputs->data[0];
+  const int add_index = graph.SoleConsumer(conv_output_index);
+  if (!graph.IsBuiltin(add_index, BuiltinOperator_ADD)) {
+    return kNoNode;
+  }
+  const TfLiteNode& add = graph.node(add_index);
+  if (add.inputs->size != 2 || add.outputs->size != 1) {
+    return kNoNode;
+  }
+  const int residual = add.inputs->data[0] == conv_output_index
+                           ? add.inputs->data[1]
+                           : add.inputs->data[0];
+  if (residual == conv_output_index ||
+      graph.Producer(residual) >= conv_index) {
+    return kNoNode;
+  }
+  const TfLiteTensor* conv_output = graph.tensor(conv_output_index);
+  const TfLiteTensor* residual_tensor = graph.tensor(residual);
+  const TfLiteTensor* output = graph.tensor(add.outputs->data[0]);
+  if (residual_tensor->type != kTfLiteInt8 || output->type != kTfLiteInt8 ||
+      !HaveSameShapes(conv_output, residual_tensor) ||
+      !HaveSameShapes(conv_output, output) ||
+      conv_output->dims->data[3] > fused_conv::kMaxOutputDepth) {
+    return kNoNode;
+  }
+  *residual_index = residual;
+  return add_index;
+}
+
+bool IsFusableConv(const GraphView& graph, int conv_index) {
+  if (!graph.IsBuiltin(conv_index, BuiltinOperator_CONV_2D)) {
+    return false;
+  }
+  const TfLiteNode& conv = graph.node(conv_index);
+  if ((conv.inputs->size != 2 && conv.inputs->size != 3) ||
+      conv.outputs->size != 1) {
+    return false;
+  }
+  const TfLiteTensor* input = graph.tensor(conv.inputs->data[0]);
+  const TfLiteTensor* filter = graph.tensor(conv.inputs->data[1]);
+  const int im2col_depth =
+      filter->dims->data[1] * filter->dims->data[2] * filter->dims->data[3];
+  return input->type == kTfLiteInt8 &&
+         im2col_depth <= ops::micro::kMaxIm2ColDepth;
+}
+
+}  // namespace
+
+TfLiteStatus FuseOperators(TfLiteContext* context, const SubGraph* subgraph,
+                           NodeAndRegistration* node_and_registrations,
+                           size_t* fused_count) {
+  GraphView graph(context, subgraph, node_and_registrations);
+  TfLiteIntArray* empty = nullptr;
+  *fused_count = 0;
+
+  for (int conv_index = 0; conv_index < graph.node_count(); ++conv_index) {
+    if (!IsFusableConv(graph, conv_index)) {
+      continue;
+    }
+    const int pad_index = FindPaddingInput(graph, conv_index);
+    int residual = kTfLiteOptionalTensor;
+    const int add_index = FindResidualAdd(graph, conv_index, &residual);
+    if (pad_index == kNoNode && add_index == kNoNode) {
+      continue;
+    }
+
+    const TfLiteNode& conv = graph.node(conv_index);
+    TfLiteNode fused = {};
+    TF_LITE_ENSURE_STATUS(
+        AllocateIntArray(context, fused_conv::kNumInputs, &fused.inputs));
+    if (pad_index != kNoNode) {
+      const TfLiteNode& pad = graph.node(pad_index);
+      fused.inputs->data[fused_conv::kInputTensor] = pad.inputs->data[0];
+      fused.inputs->data[fused_conv::kPaddingsTensor] = pad.inputs->data[1];
+    } else {
+      fused.inputs->data[fused_conv::kInputTensor] = conv.inputs->data[0];
+      fused.inputs->data[fused_conv::kPaddingsTensor] = kTfLiteOptionalTensor;
+    }
+    fused.inputs->data[fused_conv::kFilterTensor] = conv.inputs->data[1];
+    fused.inputs->data[fused_conv::kBiasTensor] =
+        conv.inputs->size == 3 ? conv.inputs->data[2] : kTfLiteOptionalTensor;
+    fused.inputs->data[fused_conv::kResidualTensor] = residual;
+    TF_LITE_ENSURE_STATUS(AllocateIntArray(context, 1, &fused.intermediates));
+    fused.intermediates->data[fused_conv::kConvOutputTensor] =
+        conv.outputs->data[0];
+    fused.builtin_data = conv.builtin_data;
+    if (add_index != kNoNode) {
+      fused.outputs = graph.node(add_index).outputs;
+      fused.custom_initial_data = graph.node(add_index).builtin_data;
+      fused.custom_initial_data_size = sizeof(TfLiteAddParams);
+    } else {
+      fused.outputs = conv.outputs;
+    }
+
+    const TfLiteRegistration* registration =
+        ops::micro::Register_FUSED_CONV_2D();
+    fused.user_data = registration->init(
+        context, static_cast<const char*>(conv.user_data),
+        sizeof(ops::micro::conv::OpData));
+    TF_LITE_ENSURE(context, fused.user_data != nullptr);
+    TF_LITE_ENSURE_STATUS(registration->prepare(context, &fused));
+
+    if (empty == nullptr) {
+      TF_LITE_ENSURE_STATUS(AllocateIntArray(context, 0, &empty));
+    }
+    for (int absorbed : {pad_index, add_index}) {
+      if (absorbed == kNoNode) {
+        continue;
+      }
+      node_and_registrations[absorbed].node = {};
+      node_and_registrations[absorbed].node.inputs = empty;
+      node_and_registrations[absorbed].node.outputs = empty;
+      node_and_registrations[absorbed].registration = FusedAwayRegistration();
+      ++*fused_count;
+    }
+    node_and_registrations[conv_index].node = fused;
+    node_and_registrations[conv_index].registration = registration;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,43 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_FUSION_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_FUSION_H_
+
+#include <cstddef>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Rewrites the prepared nodes of a subgraph so that int8 PAD -> CONV_2D and
+// CONV_2D -> ADD (residual) chains run as one fused convolution node, which
+// never materialises the padded input or the convolution output. The fused
+// node takes the place of the CONV_2D; the absorbed PAD and ADD nodes are left
+// with no inputs, outputs or invoke function.
+//
+// Only tensors consumed by a single node, and not outputs of the graph, are
+// fused away. Must be called after every node has been prepared and while
+// AllocatePersistentBuffer is still available, but before the memory plan is
+// committed, so that the intermediates get no space in the arena. The number
+// of operators absorbed into fused nodes is returned in fused_count.
+TfLiteStatus FuseOperators(TfLiteContext* context, const SubGraph* subgraph,
+                           NodeAndRegistration* node_and_registrations,
+                           size_t* fused_count);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_FUSION_H_
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_fusion.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
 #include "tensorflow/lite/micro/micro_profiler.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -244,6 +245,16 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
   }
   context_helper_.SetNodeIndex(-1);
 
+#if defined(TF_LITE_MICRO_FUSE_OPERATORS) && TF_LITE_MICRO_FUSE_OPERATORS
+  // Fused nodes are prepared here, and the memory plan below only sees the
+  // tensors they still read and write.
+  if (operator_fusion_) {
+    TF_LITE_ENSURE_OK(&context_, FuseOperators(&context_, subgraph_,
+                                               node_and_registrations_,
+                                               &fused_operators_));
+  }
+#endif
+
   // Prepare is done, we're ready for Invoke. Memory allocation is no longer
   // allowed. Kernels can only fetch scratch buffers via GetScratchBuffer.
   context_.AllocatePersistentBuffer = nullptr;
@@ -275,7 +286,9 @@ TfLiteStatus MicroInterpreter::Invoke() {
 
     if (registration->invoke) {
       TfLiteStatus invoke_status;
-#ifndef NDEBUG  // Omit profiler overhead from release builds.
+// Omit profiler overhead from release builds, unless explicitly enabled.
+#if !defined(NDEBUG) || \
+    (defined(TF_LITE_MICRO_ENABLE_PROFILER) && TF_LITE_MICRO_ENABLE_PROFILER)
       // The case where profiler == nullptr is handled by ScopedOperatorProfile.
       tflite::Profiler* profiler =
           reinterpret_cast<tflite::Profiler*>(context_.profiler);
@@ -161,6 +161,14 @@ class MicroInterpreter {
   // arena_used_bytes() + 16.
   size_t arena_used_bytes() const { return allocator_.used_bytes(); }
 
+  // Enables or disables the fusion of operator chains into single kernels by
+  // AllocateTensors() (see FuseOperators()), on by default in builds with
+  // TF_LITE_MICRO_FUSE_OPERATORS. Must be called before AllocateTensors().
+  void set_operator_fusion(bool enabled) { operator_fusion_ = enabled; }
+
+  // Number of operators absorbed into fused kernels by AllocateTensors().
+  size_t fused_operators() const { return fused_operators_; }
+
  protected:
   const MicroAllocator& allocator() const { return allocator_; }
   const TfLiteContext& context() const { return context_; }
@@ -183,6 +191,8 @@ class MicroInterpreter {
   TfLiteContext context_ = {};
   MicroAllocator& allocator_;
   bool tensors_allocated_;
+  bool operator_fusion_ = true;
+  size_t fused_operators_ = 0;
 
   TfLiteStatus initialization_status_;
 
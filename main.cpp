@@ -44,6 +44,7 @@ Mail<comms_upstream_mail_t, 256> comms_upstream_mail_box;
 Mail<service_response_mail_t, 256> service_response_mail_box;
 Mail<mqtt_arrived_mail_t, 128> mqtt_arrived_mail_box;
 Mail<sensor_control_mail_t, 64> sensor_control_mail_box;
+Mail<model_update_mail_t, 32> model_update_mail_box;
 
 /* RTOS Main Threads Initialization */
 Thread thread_1 (osPriorityNormal, OS_STACK_SIZE*8, NULL, "CommunicationsControllerThread");
@@ -2,10 +2,19 @@
 # include "lib/ArduCAM/ArduCAM/ArduCAM.h" 
 # include "mbed_trace.h"
 # include "conversions.h"
+# include "persist_store.h"
 # include "camera/model_data/person_detection_int8/model_data.h"
 
 # define TRACE_GROUP "Ardu_Camera.cpp"
 
+/*  Models in flash that can be selected with the sensor_camera_model service parameter,
+    in id order. They time-share the tensor arena, which must fit the largest one.
+ */
+static const unsigned char* const camera_models[] = {
+    g_person_detect_model_data,
+};
+static constexpr size_t num_camera_models = sizeof(camera_models) / sizeof(camera_models[0]);
+
 Ardu_Camera::Ardu_Camera(PinName cam_cs, 
                 PinName cam_spi_mosi, PinName cam_spi_miso, PinName cam_spi_sclk,
                 PinName cam_i2c_data, PinName cam_i2c_sclk):
@@ -13,10 +22,22 @@ Ardu_Camera::Ardu_Camera(PinName cam_cs,
     arducam_(cam_cs, 
         cam_spi_mosi, cam_spi_miso, cam_spi_sclk, 
         cam_i2c_data, cam_i2c_sclk, OV2640, RAW),
-    model(g_person_detect_model_data,
+    prefilter_(default_prefilter_threshold),
+    thresholds_(default_person_threshold / 100.0f),
+    tracker_(OccupancyTracker::DefaultConfig()),
+    cache_(default_cache_size, cache_max_distance),
+    inference_budget_ms_(default_inference_budget_ms),
+    frame_mode_(false),
+    grid_telemetry_(default_grid_telemetry),
+    op_profile_(false),
+    models_(tensor_arena,
         tensor_arena_size, 
-        tensor_arena,
-        false) // verbose
+        false), // verbose
+    model_store_(MBED_CONF_APP_MODEL_STORE_ADDRESS, MBED_CONF_APP_MODEL_STORE_SIZE),
+    stored_model_id_(-1),
+    model(models_.GetModel()),
+    worker_(model),
+    frame_pending_(false)
 {    
     tr_debug("Ardu_Camera::Ardu_Camera() called");
     Initialize();
@@ -26,11 +47,13 @@ std::string Ardu_Camera::GetName(){
     return "ArduCamera";
 };
 
-/*  @brief: Return True if all image pixels are black. 
-            Used to sanity check the image. 
+/*  @brief: Return True if all image pixels read by the window plan are black. 
+            Used to sanity check the image. Rows outside every window are not read from the camera,
+            so they are not checked.
  */
-bool is_all_black(const Image& image) {
+bool is_all_black(const Image& image, const WindowPlan& plan) {
     bool all_black = true;
+    bool any_checked = false;
     // Initialize a black pixel of same format as image
     uint8_t zero_bytes[Pixel::MAX_PIXEL_BYTES];
     for (size_t pos = 0; pos < Pixel::MAX_PIXEL_BYTES; pos++) {
@@ -39,6 +62,10 @@ bool is_all_black(const Image& image) {
     Pixel black_pixel = Pixel(Pixel::RGB888, zero_bytes).Reformat(image.GetFormat());
     
     for (size_t row = 0; row < image.GetHeight(); row++) {
+        if (!plan.IsRowCovered(row)) {
+            continue;
+        }
+        any_checked = true;
         for (size_t col = 0; col < image.GetWidth(); col++) {
             if (!(image.GetPixel(row, col) == black_pixel)) {
                 all_black = false;
@@ -46,7 +73,7 @@ bool is_all_black(const Image& image) {
         }
     }
 
-    return all_black;
+    return all_black && any_checked;
 };
 
 int Ardu_Camera::GetData(std::vector<std::pair<std::string, std::string>>& data_list) {
@@ -55,50 +82,318 @@ int Ardu_Camera::GetData(std::vector<std::pair<std::string, std::string>>& data_
     {
         return DISCONNECT;
     }
-    this->Capture();
-    this->ReadImage();
-    tr_debug("Image size: %d bytes", this->arducam_.read_fifo_length());
+    if (!frame_pending_) {
+        this->Capture();
+        this->ReadImage();
+        tr_debug("Image size: %d bytes", this->arducam_.read_fifo_length());
 
-    // Sanity check the image
-    if (is_all_black(this->image_)) 
-    {
-        tr_warn("Black image detected; camera may be faulty");
-    } 
-    else 
-    {
-        tr_debug("Valid image detected");
-    }
-
-    Image camera_image = this->image_;
-    int num_people = 0;
-    Watchdog &watchdog = Watchdog::get_instance();
-    // Run inference on model
-    for (size_t row = 0; row + sliding_window_length <= camera_image.GetHeight(); row += sliding_window_length) {
-        for (size_t col = 0; col + sliding_window_length <= camera_image.GetWidth(); col += sliding_window_freq) {
-            tr_debug("Running inference at (%d, %d)", row, col);
-            Image cropped_image = camera_image.Crop(row, col, sliding_window_length, sliding_window_length, img_buf_a);
-            Image formatted_image = cropped_image.Reformat(cnn_img_fmt, img_buf_b);
-            Image resized_image = formatted_image.Resize(cnn_img_height, cnn_img_width, img_buf_a);
-            uint8_t* output_buf = model.RunInference(resized_image.GetBuffer());
-
-            // For the default model: 
-            // - output_buf[0] is unused
-            // - output_buf[1] corresponds to a score for a person
-            // - output_buf[2] corresponds to the score for no person
-            bool person_detected = output_buf[1] >= output_buf[2];
-            if (person_detected) {
-                num_people += 1;
-            }
-            // Kick the watchdog after every inference because application will time out otherwise
-            watchdog.kick();
+        // Sanity check the image
+        if (is_all_black(this->image_, ActivePlan())) 
+        {
+            tr_warn("Black image detected; camera may be faulty");
+        } 
+        else 
+        {
+            tr_debug("Valid image detected");
+        }
+
+        frame_stats_ = {0, 0, 0, 0, 0, 0, 0};
+        tracker_.BeginFrame();
+        if (!(frame_mode_ ? StartFrame() : StartWindows())) {
+            return DATA_NOT_RDY;
         }
-    } 
-    tr_info("%d people detected in total", num_people);
+        frame_pending_ = true;
+    }
+    bool done = false;
+    if (!(frame_mode_ ? StepFrame(detect_wait_ms, done) : StepWindows(detect_wait_ms, done))) {
+        CancelDetect();
+        return DATA_NOT_RDY;
+    }
+    if (!done) {
+        return DATA_PENDING;
+    }
+    frame_pending_ = false;
+    const detect_stats_t& stats = frame_stats_;
+
+    // Count from the smoothed per-cell scores, 
+    // merging positive windows that overlap the same person into a single count
+    score_grid_.Clear();
+    for (size_t cell = 0; cell < score_grid_.GetNumCells(); cell++) {
+        score_grid_.SetScore(cell, tracker_.GetScore(cell));
+    }
+    int num_people = score_grid_.Suppress();
+
+    int window_coverage = (stats.num_windows > 0) ? 
+        (100 * (stats.num_windows - stats.num_carried)) / stats.num_windows : 100;
+    int tracker_skip_rate = (stats.num_windows > 0) ? (100 * stats.num_skipped) / stats.num_windows : 0;
+    int prefilter_pass_rate = (stats.num_tested > 0) ? (100 * stats.num_passed) / stats.num_tested : 0;
+    int cache_hit_rate = (stats.num_passed > 0) ? (100 * stats.num_cached) / stats.num_passed : 0;
+    int model_pass_rate = (stats.num_passed > 0) ? (100 * stats.num_positive) / stats.num_passed : 0;
+    tr_info("%d people detected in total, %d%% of windows visited", num_people, window_coverage);
+    tr_info("Tracker reused %d of %d windows, pre-filter passed %d of %d, %d cache hits, model detected %d of %d", 
+        stats.num_skipped, stats.num_windows, stats.num_passed, stats.num_tested, 
+        stats.num_cached, stats.num_positive, stats.num_passed);
     data_list.push_back(std::make_pair("num_people_in_image", IntToString(num_people)));
+    data_list.push_back(std::make_pair("window_coverage", IntToString(window_coverage)));
+    data_list.push_back(std::make_pair("tracker_skip_rate", IntToString(tracker_skip_rate)));
+    data_list.push_back(std::make_pair("prefilter_pass_rate", IntToString(prefilter_pass_rate)));
+    data_list.push_back(std::make_pair("cache_hit_rate", IntToString(cache_hit_rate)));
+    data_list.push_back(std::make_pair("model_pass_rate", IntToString(model_pass_rate)));
+    if (grid_telemetry_) {
+        // Which cells fired, from the same scores that gave num_people_in_image
+        uint8_t grid_buf[ScoreGrid::MAX_PACKED_BYTES];
+        size_t grid_len = score_grid_.Pack(grid_buf, sizeof(grid_buf));
+        data_list.push_back(std::make_pair("occupancy_grid", BytesToBase64(grid_buf, grid_len)));
+    }
+    if (op_profile_) {
+        // Op totals of every invoke in this poll
+        profiler_.Dump();
+        data_list.push_back(std::make_pair("op_profile", profiler_.Summary()));
+        profiler_.Reset();
+    }
     tr_debug("Payload value: %s", data_list[0].second.c_str());
     return DATA_OK;
 }
 
+/*  @brief: Start observing each window of the plan with the window classifier.
+            Windows are visited in scheduler priority order until the inference budget runs out;
+            the rest carry over to the next poll and keep their tracker scores meanwhile.
+            Windows pass through four stages, cheapest first:
+            1. The occupancy tracker skips windows that have not moved since a recent observation.
+            2. The edge energy pre-filter rejects near-uniform windows as empty.
+            3. The result cache returns the score of a window that looks the same as a recent one.
+            4. The remaining windows are passed to the inference thread. Batched models take 
+               up to batch_size windows per invoke, which amortises the per-invoke 
+               overhead and weight reads.
+            The stages run on the calling thread in StepWindows(), on windows extracted straight 
+            into the input slots of the model while the inference thread is idle. Every 
+            observation is folded into the tracker at the cell of its window.
+    @return: False if the model input does not match the window size.
+ */
+bool Ardu_Camera::StartWindows() {
+    if (model.GetInput<int8_t>(0).size() != window_size) {
+        tr_err("Model input does not match the window size");
+        return false;
+    }
+    prefilter_.ResetStats();
+    uint64_t occupied_mask = 0;
+    for (size_t cell = 0; cell < WindowScheduler::MAX_CELLS; cell++) {
+        if (tracker_.IsOccupied(cell)) {
+            occupied_mask |= (uint64_t)1 << cell;
+        }
+    }
+    frame_num_windows_ = scheduler_.Order(window_plan_, occupied_mask, frame_order_);
+    frame_next_ = 0;
+    frame_timer_.reset();
+    frame_timer_.start();
+    return true;
+}
+
+/*  @brief: Run the cheap stages on the next windows of the frame in the input slots of the model, 
+            and run the model on those that reach it, once every slot is filled 
+            or every window is visited. Does nothing while the model still runs the previous batch.
+    @return: False if the batch could not be submitted.
+ */
+bool Ardu_Camera::QueueWindows() {
+    detect_stats_t& stats = frame_stats_;
+    if (worker_.GetNumPending() > 0) {
+        // The model owns its input until every score of the batch is collected
+        return true;
+    }
+    size_t batch_size = this->model.GetBatchSize();
+    if (batch_size > InferenceWorker::MAX_BATCH_SIZE) {
+        batch_size = InferenceWorker::MAX_BATCH_SIZE;
+    }
+    uint32_t tags[InferenceWorker::MAX_BATCH_SIZE];
+    size_t num_slots = 0;
+    while (num_slots < batch_size && frame_next_ < frame_num_windows_) {
+        if (inference_budget_ms_ > 0 && frame_timer_.read_ms() >= inference_budget_ms_) {
+            stats.num_carried = frame_num_windows_ - frame_next_;
+            tr_info("Inference budget of %d ms used up, %d windows carried over", 
+                inference_budget_ms_, stats.num_carried);
+            frame_next_ = frame_num_windows_;
+            break;
+        }
+        // Extract straight into the next input slot; a window that does not reach the model 
+        // leaves the slot to the next one
+        TensorSpan<int8_t> slot = this->model.GetInput<int8_t>(num_slots);
+        size_t idx = frame_order_[frame_next_++];
+        const window_rect_t& rect = window_plan_.GetWindow(idx);
+        uint8_t* window_buf = reinterpret_cast<uint8_t*>(slot.data());
+        window_plan_.Extract(this->image_, idx, window_buf);
+        bool active = tracker_.NeedsInference(rect.cell, window_buf, cnn_img_height, cnn_img_width);
+        scheduler_.MarkVisited(rect.cell, active);
+        if (!active) {
+            stats.num_skipped++;
+            continue;
+        }
+        if (!prefilter_.Pass(window_buf, cnn_img_height, cnn_img_width)) {
+            tr_debug("Window at (%d, %d) rejected by pre-filter", rect.top, rect.left);
+            tracker_.Update(rect.cell, prefilter_reject_score);
+            continue;
+        }
+        uint64_t hash = ResultCache::Hash(window_buf, cnn_img_height, cnn_img_width);
+        int16_t score;
+        if (cache_.Lookup(hash, score)) {
+            tr_debug("Cache hit at (%d, %d)", rect.top, rect.left);
+            tracker_.Update(rect.cell, score);
+            stats.num_cached++;
+            if (score >= 0) {
+                stats.num_positive++;
+            }
+            continue;
+        }
+        tr_debug("Queueing inference at (%d, %d)", rect.top, rect.left);
+        frame_hashes_[idx] = hash;
+        GrayToModelInput(slot);
+        tags[num_slots++] = idx;
+    }
+    if (num_slots > 0 && !worker_.Submit(tags, num_slots)) {
+        tr_err("Inference thread is busy");
+        return false;
+    }
+    return true;
+}
+
+/*  @brief: Advance the detection started by StartWindows(): fold the scores of finished windows 
+            into the tracker at their grid cells and the cache, and queue more windows.
+    @param: timeout_ms: Time to wait for the first score if none is ready.
+            done:       Set to true once every window is visited and scored.
+    @return: False if inference failed.
+ */
+bool Ardu_Camera::StepWindows(uint32_t timeout_ms, bool& done) {
+    detect_stats_t& stats = frame_stats_;
+    if (!QueueWindows()) {
+        return false;
+    }
+    InferenceWorker::response_t response;
+    while (worker_.GetResponse(response, timeout_ms)) {
+        // The rest of the batch is posted right after the first score
+        timeout_ms = osWaitForever;
+        if (!response.ok) {
+            tr_err("Inference failed");
+            return false;
+        }
+        const window_rect_t& rect = window_plan_.GetWindow(response.tag);
+        int16_t score = PersonScore(InferenceResult(output_quant_, response.output, response.num_bytes));
+        tracker_.Update(rect.cell, score);
+        cache_.Insert(frame_hashes_[response.tag], score);
+        if (score >= 0) {
+            stats.num_positive++;
+        }
+    }
+    if (!QueueWindows()) {
+        return false;
+    }
+    done = frame_next_ == frame_num_windows_ && worker_.GetNumPending() == 0;
+    if (done) {
+        stats.num_windows = frame_num_windows_;
+        stats.num_tested = prefilter_.GetNumTested();
+        stats.num_passed = prefilter_.GetNumPassed();
+    }
+    return true;
+}
+
+/*  @brief: Start counting people with a single invoke of a fully-convolutional model 
+            over the whole frame. The frame is resized straight into the model input,
+            and the scores of every cell are read from the model once the invoke is done.
+    @return: False if the model or frame plan is not set up for full-frame detection.
+ */
+bool Ardu_Camera::StartFrame() {
+    TensorSpan<int8_t> input = model.GetInput<int8_t>(0);
+    if (input.empty() || !frame_plan_.IsValid()) {
+        tr_err("Full-frame model is not initialized");
+        return false;
+    }
+    frame_plan_.Extract(this->image_, 0, reinterpret_cast<uint8_t*>(input.data()));
+    GrayToModelInput(input);
+    const uint32_t tag = 0;
+    return worker_.Submit(&tag, 1);
+}
+
+/*  @brief: Finish the detection started by StartFrame() once the invoke is done.
+            The model scores a grid of cells in row-major order. Cells disabled 
+            in the window mask are ignored, so the mask applies as long as the model grid 
+            matches the window grid. The tracker and pre-filter cannot skip single cells 
+            of the invoke, so every enabled cell is observed and folded into the tracker.
+    @param: timeout_ms: Time to wait for the invoke to finish.
+            done:       Set to true once the cells are scored.
+    @return: False if inference failed.
+ */
+bool Ardu_Camera::StepFrame(uint32_t timeout_ms, bool& done) {
+    detect_stats_t& stats = frame_stats_;
+    InferenceWorker::response_t response;
+    if (!worker_.GetResponse(response, timeout_ms)) {
+        return true;
+    }
+    // The inference thread is idle, so the output tensor can be read in place
+    if (!response.ok || model.GetResult(0).empty()) {
+        tr_err("Inference failed");
+        return false;
+    }
+
+    uint64_t enable_mask = window_plan_.GetConfig().enable_mask;
+    size_t num_cells = model.GetNumCells();
+    for (size_t cell = 0; cell < num_cells; cell++) {
+        if (cell < 64 && !((enable_mask >> cell) & 1)) {
+            continue;
+        }
+        int16_t score = PersonScore(model.GetResult(cell));
+        tracker_.Update(cell, score);
+        stats.num_windows++;
+        if (score >= 0) {
+            stats.num_positive++;
+        }
+    }
+    stats.num_tested = stats.num_windows;
+    stats.num_passed = stats.num_windows;
+    done = true;
+    return true;
+}
+
+/*  @brief: Drop the frame being detected, waiting for its queued windows, 
+            so that the model and window plan can be changed safely.
+            The next GetData() captures a new frame.
+ */
+void Ardu_Camera::CancelDetect() {
+    worker_.Flush();
+    frame_pending_ = false;
+}
+
+/*  @brief: Get the person score of one window or cell from its class scores.
+            The default model outputs softmax scores in the order [no person, person].
+            The score is the margin of the person score over the person threshold,
+            in quantisation steps, so no dequantisation takes place. It is doubled 
+            so that with the default threshold of 50% it spans the same -255 to 255 range 
+            as the difference of the two int8 class scores, which the tracker is tuned for.
+    @return: Score margin, saturated to -255 to 255; a person is detected if it is >= 0.
+             A result without a person score counts as a confident "no person".
+ */
+int16_t Ardu_Camera::PersonScore(const InferenceResult& result) const {
+    if (result.GetNumClasses() <= person_class) {
+        return prefilter_reject_score;
+    }
+    int32_t margin = 2 * thresholds_.Margin(result, person_class);
+    if (margin > 255) {
+        return 255;
+    }
+    if (margin < -255) {
+        return -255;
+    }
+    return (int16_t)margin;
+}
+
+/*  @brief: Convert a grayscale window, written into the model input as uint8, to the int8 
+            model input in place. The default model takes pixels shifted by -128,
+            which flips the top bit of each byte.
+ */
+void Ardu_Camera::GrayToModelInput(TensorSpan<int8_t> input) {
+    uint8_t* pixels = reinterpret_cast<uint8_t*>(input.data());
+    for (size_t i = 0; i < input.size(); i++) {
+        pixels[i] ^= 0x80;
+    }
+}
+
 void Ardu_Camera::Initialize() {
     tr_debug("Ardu_Camera::Initialize() called");
     arducam_.InitCAM();
@@ -106,10 +401,85 @@ void Ardu_Camera::Initialize() {
     arducam_.write_reg(ARDUCHIP_TIM, VSYNC_LEVEL_MASK);
     arducam_.write_reg(ARDUCHIP_FRAMES,0x00); 
     tr_debug("Initializing TFLM model...");
-    this->model.Initialize();
+    LoadModels();
+    worker_.Start();
+    LoadWindowConfig();
+    LoadPrefilterConfig();
+    LoadTrackerConfig();
+    LoadCacheConfig();
+    LoadTelemetryConfig();
+    LoadSchedulerConfig();
+    LoadThresholdConfig();
     tr_debug("Ardu_Camera::Initialize() resolved");
 }
 
+/*  @brief: Register every model in camera_models and the model received over the air, if it 
+            passes verification, then select the persisted model, falling back to model 0.
+ */
+void Ardu_Camera::LoadModels() {
+    for (size_t id = 0; id < num_camera_models; id++) {
+        if (models_.Register(camera_models[id]) < 0) {
+            tr_err("Model %d could not be loaded", id);
+        }
+    }
+    const unsigned char* stored_model = model_store_.Load();
+    if (stored_model != nullptr) {
+        stored_model_id_ = models_.Register(stored_model);
+        if (stored_model_id_ < 0) {
+            tr_err("Stored model could not be loaded");
+        }
+    }
+    tr_info("Tensor arena: %d bytes needed by the largest model, %d available", 
+        models_.GetRequiredArenaBytes(), tensor_arena_size);
+
+    std::string id = ReadCameraModel();
+    if (id.empty() || !models_.Select(StringToInt(id))) {
+        models_.Select(0);
+    }
+    ApplyModel();
+}
+
+/*  @brief: Set up detection for the active model.
+            A model that scores more than one cell per input is fully-convolutional, 
+            and is run once over the whole frame instead of once per window.
+ */
+void Ardu_Camera::ApplyModel() {
+    tr_info("Active model: %d of %d", models_.GetActiveId(), models_.GetNumModels());
+    frame_mode_ = this->model.GetNumCells() > 1;
+    if (frame_mode_) {
+        tr_info("Full-frame model with %d cells", this->model.GetNumCells());
+        if (!frame_plan_.BuildFrame(cam_img_height, cam_img_width, 
+                this->model.GetInputHeight(), this->model.GetInputWidth())) {
+            tr_err("Model input %dx%d is not supported for full-frame detection", 
+                this->model.GetInputHeight(), this->model.GetInputWidth());
+        }
+        ConfigureFrameGrid();
+    }
+    // Thresholds are compared with the quantised scores of the new model
+    output_quant_ = this->model.GetOutputQuant();
+    thresholds_.Quantize(output_quant_);
+    // Results of the previous model no longer apply
+    cache_.Clear();
+}
+
+/*  @brief: Switch to another registered model, keeping the previous one if the new one
+            cannot be selected. A stored model that is being replaced cannot be selected.
+    @return: True if the model was selected.
+ */
+bool Ardu_Camera::SelectModel(int id) {
+    int previous = models_.GetActiveId();
+    bool stale = id >= (int)num_camera_models && id != stored_model_id_;
+    if (id < 0 || stale || !models_.Select(id)) {
+        // Keep running the previous model
+        models_.Select(previous < 0 ? 0 : previous);
+        return false;
+    }
+    ApplyModel();
+    // The score grid and tracker depend on whether the model runs per window or per frame
+    ApplyWindowConfig(window_plan_.GetConfig());
+    return true;
+}
+
 /*  @brief: Signal the camera module to take a new image
     @author: Daniel Tan
  */
@@ -136,12 +506,394 @@ void Ardu_Camera::Reset() {
     return;
 }
 
-/*  @brief: Copy the captured image into in-memory buffer
+/*  @brief: Rebuild the window plan from a new window config.
+            The current plan is kept if the config does not fit the camera image.
+    @return: True if the plan was rebuilt.
+ */
+bool Ardu_Camera::ApplyWindowConfig(const window_config_t& config) {
+    bool ok = window_plan_.Build(config, cam_img_height, cam_img_width, cnn_img_height, cnn_img_width);
+    if (ok && !frame_mode_) {
+        ok = score_grid_.Configure(window_plan_.GetGridRows(), window_plan_.GetGridCols(), 
+            config.length, config.stride, nms_iou_threshold);
+    }
+    if (ok) {
+        // Cell indices now refer to different windows
+        tracker_.Reset();
+        scheduler_.Reset();
+        tr_info("Window plan: length %d, stride %d, offset (%d, %d), %d of %d cells enabled",
+            config.length, config.stride, config.row_offset, config.col_offset,
+            window_plan_.GetNumWindows(), window_plan_.GetNumCells());
+    }
+    return ok;
+}
+
+/*  @brief: Configure the score grid for a full-frame model. 
+            The model cells are square and tile the input, so the grid shape follows 
+            from the number of cells and the input aspect ratio. 
+            Cells do not overlap, so no suppression takes place.
+ */
+void Ardu_Camera::ConfigureFrameGrid() {
+    size_t num_cells = this->model.GetNumCells();
+    size_t height = this->model.GetInputHeight();
+    size_t width = this->model.GetInputWidth();
+    for (size_t rows = 1; rows <= num_cells; rows++) {
+        size_t cols = num_cells / rows;
+        if (rows * cols == num_cells && height * cols == width * rows) {
+            score_grid_.Configure(rows, cols, 1, 1, nms_iou_threshold);
+            return;
+        }
+    }
+    tr_err("Cannot arrange %d model cells over a %dx%d input", num_cells, height, width);
+}
+
+/*  @brief: Load the window config from persistent storage and build the window plan.
+            Unset keys fall back to the defaults in Ardu_Camera.h.
+ */
+void Ardu_Camera::LoadWindowConfig() {
+    window_config_t config = WindowPlan::DefaultConfig(default_window_length);
+    config.stride = default_window_stride;
+
+    std::string length = ReadCameraWindowLength();
+    std::string stride = ReadCameraWindowStride();
+    std::string row_offset = ReadCameraWindowRowOffset();
+    std::string col_offset = ReadCameraWindowColOffset();
+    std::string mask = ReadCameraWindowMask();
+    if (!length.empty()) config.length = StringToInt(length);
+    if (!stride.empty()) config.stride = StringToInt(stride);
+    if (!row_offset.empty()) config.row_offset = StringToInt(row_offset);
+    if (!col_offset.empty()) config.col_offset = StringToInt(col_offset);
+    if (!mask.empty()) config.enable_mask = HexToUint64(mask);
+
+    if (!ApplyWindowConfig(config)) {
+        tr_warn("Persisted window config is invalid; using defaults");
+        config = WindowPlan::DefaultConfig(default_window_length);
+        config.stride = default_window_stride;
+        ApplyWindowConfig(config);
+    }
+}
+
+/*  @brief: Write the current window config to persistent storage.
+ */
+void Ardu_Camera::SaveWindowConfig() {
+    const window_config_t& config = window_plan_.GetConfig();
+    WriteCameraWindowLength(IntToString(config.length));
+    WriteCameraWindowStride(IntToString(config.stride));
+    WriteCameraWindowRowOffset(IntToString(config.row_offset));
+    WriteCameraWindowColOffset(IntToString(config.col_offset));
+    WriteCameraWindowMask(Uint64ToHex(config.enable_mask));
+}
+
+/*  @brief: Load the pre-filter threshold from persistent storage.
+            An unset key falls back to the default in Ardu_Camera.h.
+ */
+void Ardu_Camera::LoadPrefilterConfig() {
+    std::string threshold = ReadCameraPrefilterThreshold();
+    if (!threshold.empty()) {
+        prefilter_.SetThreshold(StringToInt(threshold));
+    }
+    tr_info("Pre-filter threshold: %d", prefilter_.GetThreshold());
+}
+
+/*  @brief: Load the occupancy tracker tuning from persistent storage.
+            Unset keys fall back to OccupancyTracker::DefaultConfig().
+ */
+void Ardu_Camera::LoadTrackerConfig() {
+    tracker_config_t config = tracker_.GetConfig();
+    std::string decay = ReadCameraTrackerDecay();
+    std::string motion = ReadCameraTrackerMotion();
+    if (!decay.empty()) config.decay = StringToInt(decay);
+    if (!motion.empty()) config.motion_threshold = StringToInt(motion);
+    tracker_.SetConfig(config);
+    tr_info("Tracker decay: %d/256, motion threshold: %d", config.decay, config.motion_threshold);
+}
+
+/*  @brief: Load the result cache size from persistent storage.
+            An unset key falls back to the default in Ardu_Camera.h.
+ */
+void Ardu_Camera::LoadCacheConfig() {
+    std::string size = ReadCameraCacheSize();
+    if (!size.empty() && !cache_.SetCapacity(StringToInt(size))) {
+        tr_warn("Persisted cache size is invalid; using default");
+    }
+    tr_info("Result cache size: %d of %d entries", cache_.GetCapacity(), ResultCache::MAX_ENTRIES);
+}
+
+/*  @brief: Load the occupancy grid telemetry flag from persistent storage.
+            An unset key falls back to the default in Ardu_Camera.h.
+ */
+void Ardu_Camera::LoadTelemetryConfig() {
+    std::string enable = ReadCameraGridTelemetry();
+    if (!enable.empty()) {
+        grid_telemetry_ = StringToInt(enable) != 0;
+    }
+    tr_info("Occupancy grid telemetry: %s", grid_telemetry_ ? "on" : "off");
+}
+
+/*  @brief: Load the inference budget and window priority mask from persistent storage.
+            Unset keys fall back to the defaults in Ardu_Camera.h.
+ */
+void Ardu_Camera::LoadSchedulerConfig() {
+    std::string budget = ReadCameraInferenceBudget();
+    std::string mask = ReadCameraPriorityMask();
+    if (!budget.empty()) inference_budget_ms_ = StringToInt(budget);
+    if (!mask.empty()) scheduler_.SetPriorityMask(HexToUint64(mask));
+    tr_info("Inference budget: %d ms", inference_budget_ms_);
+}
+
+/*  @brief: Load the person detection threshold from persistent storage.
+            An unset key falls back to the default in Ardu_Camera.h.
+ */
+void Ardu_Camera::LoadThresholdConfig() {
+    std::string threshold = ReadCameraPersonThreshold();
+    int percent = threshold.empty() ? default_person_threshold : StringToInt(threshold);
+    thresholds_.Set(person_class, percent / 100.0f);
+    tr_info("Person threshold: %d%%, %d quantised", percent, thresholds_.GetQuantized(person_class));
+}
+
+/*  @brief: Change a camera parameter at runtime and persist it.
+            Supported parameters:
+            - sensor_camera_window_length: side length of each window, in camera pixels
+            - sensor_camera_window_stride: distance between neighbouring windows, in camera pixels
+            - sensor_camera_window_row_offset: first row of the window grid
+            - sensor_camera_window_col_offset: first column of the window grid
+            - sensor_camera_window_mask: cell enable bitmask for cells 0-31; -1 enables every cell
+            - sensor_camera_roi_enable: add one cell (0-63) to the region of interest; -1 enables every cell
+            - sensor_camera_roi_disable: remove one cell (0-63) from the region of interest; -1 disables every cell
+            - sensor_camera_prefilter_threshold: minimum edge energy for a window to reach the model; 
+              0 disables the pre-filter
+            - sensor_camera_tracker_decay: per-frame confidence decay of the occupancy tracker, 
+              in 1/256 units; 0 re-infers every window every frame
+            - sensor_camera_tracker_motion: thumbnail change, in grey levels, that forces 
+              a window to be re-inferred; 0 re-infers every window every frame
+            - sensor_camera_cache_size: number of cached window results, at most ResultCache::MAX_ENTRIES;
+              0 disables the cache
+            - sensor_camera_grid_telemetry: 1 publishes the occupancy_grid measure point, 0 stops it
+            - sensor_camera_op_profile: 1 times every op of the model and publishes the op_profile 
+              measure point, 0 stops it; not persisted, as profiling is a diagnostic
+            - sensor_camera_inference_budget: inference time per poll, in milliseconds; 
+              0 visits every window every poll
+            - sensor_camera_priority_enable: visit one cell (0-63) first among windows of equal age; 
+              -1 prioritises every cell
+            - sensor_camera_priority_disable: remove one cell (0-63) from the priority cells; 
+              -1 clears every cell
+            - sensor_camera_person_threshold: person probability, in percent (1-99), at which 
+              a window or cell counts as a person
+            - sensor_camera_model: id of the model to run, an index into camera_models, 
+              or the number of entries in camera_models for the model received over the air
+    @param: param: Parameter name, as received from a DECADA service call.
+            value: New parameter value.
+    @return: True if the parameter was recognised and the resulting window plan is valid.
+ */
+bool Ardu_Camera::Configure(const std::string& param, int value) {
+    // A frame in progress may use the old model or window plan
+    CancelDetect();
+    if (param == "sensor_camera_prefilter_threshold") {
+        if (value < 0) {
+            return false;
+        }
+        prefilter_.SetThreshold(value);
+        WriteCameraPrefilterThreshold(IntToString(value));
+        return true;
+    }
+    if (param == "sensor_camera_tracker_decay" || param == "sensor_camera_tracker_motion") {
+        if (value < 0 || value > 255) {
+            return false;
+        }
+        tracker_config_t config = tracker_.GetConfig();
+        if (param == "sensor_camera_tracker_decay") {
+            config.decay = value;
+            WriteCameraTrackerDecay(IntToString(value));
+        } else {
+            config.motion_threshold = value;
+            WriteCameraTrackerMotion(IntToString(value));
+        }
+        tracker_.SetConfig(config);
+        return true;
+    }
+    if (param == "sensor_camera_cache_size") {
+        if (value < 0 || !cache_.SetCapacity(value)) {
+            return false;
+        }
+        WriteCameraCacheSize(IntToString(value));
+        return true;
+    }
+    if (param == "sensor_camera_grid_telemetry") {
+        if (value != 0 && value != 1) {
+            return false;
+        }
+        grid_telemetry_ = value;
+        WriteCameraGridTelemetry(IntToString(value));
+        return true;
+    }
+    if (param == "sensor_camera_op_profile") {
+        if (value != 0 && value != 1) {
+            return false;
+        }
+        op_profile_ = value;
+        profiler_.Reset();
+        this->model.SetProfiler(op_profile_ ? &profiler_ : nullptr);
+        return true;
+    }
+    if (param == "sensor_camera_inference_budget") {
+        if (value < 0) {
+            return false;
+        }
+        inference_budget_ms_ = value;
+        WriteCameraInferenceBudget(IntToString(value));
+        return true;
+    }
+    if (param == "sensor_camera_person_threshold") {
+        if (value < 1 || value > 99) {
+            return false;
+        }
+        thresholds_.Set(person_class, value / 100.0f);
+        // Cached and tracked scores are margins against the previous threshold
+        cache_.Clear();
+        tracker_.Reset();
+        WriteCameraPersonThreshold(IntToString(value));
+        return true;
+    }
+    if (param == "sensor_camera_model") {
+        if (!SelectModel(value)) {
+            return false;
+        }
+        WriteCameraModel(IntToString(value));
+        return true;
+    }
+    if (param == "sensor_camera_priority_enable" || param == "sensor_camera_priority_disable") {
+        if (value < -1 || value >= (int)WindowScheduler::MAX_CELLS) {
+            return false;
+        }
+        uint64_t cells = (value == -1) ? ~(uint64_t)0 : (uint64_t)1 << value;
+        uint64_t mask = scheduler_.GetPriorityMask();
+        mask = (param == "sensor_camera_priority_enable") ? (mask | cells) : (mask & ~cells);
+        scheduler_.SetPriorityMask(mask);
+        WriteCameraPriorityMask(Uint64ToHex(mask));
+        return true;
+    }
+
+    window_config_t config = window_plan_.GetConfig();
+    if (param == "sensor_camera_window_mask") {
+        config.enable_mask = (value == -1) ? ~(uint64_t)0 : (uint64_t)(uint32_t)value;
+    } else if (param == "sensor_camera_roi_enable" || param == "sensor_camera_roi_disable") {
+        if (value < -1 || value >= (int)WindowPlan::MAX_WINDOWS) {
+            return false;
+        }
+        uint64_t cells = (value == -1) ? ~(uint64_t)0 : (uint64_t)1 << value;
+        if (param == "sensor_camera_roi_enable") {
+            config.enable_mask |= cells;
+        } else {
+            config.enable_mask &= ~cells;
+        }
+    } else if (value < 0) {
+        return false;
+    } else if (param == "sensor_camera_window_length") {
+        config.length = value;
+    } else if (param == "sensor_camera_window_stride") {
+        config.stride = value;
+    } else if (param == "sensor_camera_window_row_offset") {
+        config.row_offset = value;
+    } else if (param == "sensor_camera_window_col_offset") {
+        config.col_offset = value;
+    } else {
+        return false;
+    }
+
+    if (!ApplyWindowConfig(config)) {
+        return false;
+    }
+    SaveWindowConfig();
+    return true;
+}
+
+/*  @brief: Handle one step of an over-the-air model update, see ModelStore.h.
+            Supported parameters:
+            - model_update_begin: "<size>,<sha256>", the .tflite size in bytes and its SHA-256 digest 
+              in hexadecimal; erases the stored model, so it stops running if it was active
+            - model_update_chunk: "<offset>,<data>", the position of the chunk in the .tflite file 
+              and at most model_chunk_max_bytes of it in base64; chunks must be sent in order
+            - model_update_commit: verifies the SHA-256 digest and selects the new model 
+              for the next boot
+            - model_update_abort: stops the update
+            The model is only run after a reboot, once its digest has been checked again.
+    @param: param: Parameter name, as received from a DECADA service call.
+            value: Parameter value string.
+    @return: True if the step succeeded.
+ */
+bool Ardu_Camera::UpdateModel(const std::string& param, const std::string& value) {
+    if (param == "model_update_begin") {
+        size_t comma = value.find(',');
+        if (comma == std::string::npos) {
+            return false;
+        }
+        int size = StringToInt(value.substr(0, comma));
+        if (size <= 0) {
+            return false;
+        }
+        // The stored model is about to be erased
+        CancelDetect();
+        stored_model_id_ = -1;
+        if (models_.GetActiveId() >= (int)num_camera_models) {
+            SelectModel(0);
+        }
+        return model_store_.Begin(size, value.substr(comma + 1));
+    }
+    if (param == "model_update_chunk") {
+        size_t comma = value.find(',');
+        if (comma == std::string::npos) {
+            return false;
+        }
+        int offset = StringToInt(value.substr(0, comma));
+        uint8_t chunk[model_chunk_max_bytes];
+        int len = Base64ToBytes(value.substr(comma + 1), chunk, sizeof(chunk));
+        if (offset < 0 || len <= 0) {
+            return false;
+        }
+        return model_store_.Write(offset, chunk, len);
+    }
+    if (param == "model_update_commit") {
+        if (!model_store_.Commit()) {
+            return false;
+        }
+        tr_info("Model update stored, it will run from the next boot");
+        WriteCameraModel(IntToString(num_camera_models));
+        return true;
+    }
+    if (param == "model_update_abort") {
+        model_store_.Abort();
+        return true;
+    }
+    return false;
+}
+
+/*  @brief: Get the window plan used for the current detection mode.
+ */
+const WindowPlan& Ardu_Camera::ActivePlan() const {
+    return frame_mode_ ? frame_plan_ : window_plan_;
+}
+
+/*  @brief: Copy the captured image into in-memory buffer.
+            Only rows read by an enabled window are stored. Rows above or between them 
+            are drained from the FIFO and discarded, and reading stops after the last covered row;
+            the next capture resets the FIFO.
  */
 void Ardu_Camera::ReadImage() {
+    const WindowPlan& plan = ActivePlan();
+    size_t end_row = this->image_.GetHeight();
+    while (end_row > 0 && !plan.IsRowCovered(end_row - 1)) {
+        end_row--;
+    }
+    size_t row_bytes = this->image_.GetWidth() * this->image_.GetChannels();
+
     arducam_.flush_fifo();
     uint8_t bytes[Pixel::MAX_PIXEL_BYTES];
-    for (size_t row = 0; row < this->image_.GetHeight(); row++) {
+    for (size_t row = 0; row < end_row; row++) {
+        if (!plan.IsRowCovered(row)) {
+            for (size_t i = 0; i < row_bytes; i++) {
+                arducam_.read_fifo();
+            }
+            continue;
+        }
         for (size_t col = 0; col < this->image_.GetWidth(); col++) {
             for (size_t ch = 0; ch < this->image_.GetChannels(); ch++) {
                 bytes[ch] = arducam_.read_fifo();
@@ -3,8 +3,18 @@
 
 #include "sensor_type.h"
 #include "camera/image/Image.h"
+#include "camera/window/WindowPlan.h"
+#include "camera/window/EdgeFilter.h"
+#include "camera/window/ScoreGrid.h"
+#include "camera/window/OccupancyTracker.h"
+#include "camera/window/ResultCache.h"
+#include "camera/window/WindowScheduler.h"
 #include "lib/ArduCAM/ArduCAM/ArduCAM.h" // base driver
-# include "camera/model/TFLM_Model.h"
+# include "camera/model/ModelManager.h"
+# include "camera/model/ModelStore.h"
+# include "camera/model/OpProfiler.h"
+# include "camera/model/InferenceWorker.h"
+# include "camera/model_data/model_arena_size.h"
 
 /** Create a Ardu_Camera object using the specified I2C object
  * @param sda - mbed I2C interface pin
@@ -23,25 +33,137 @@ class Ardu_Camera : public SensorType {
         int GetData(std::vector<std::pair<std::string, std::string>>&);
         void Enable();
         void Disable();
-        // void Configure();   // To be done in SENP-286
+        bool Configure(const std::string& param, int value);
+        bool UpdateModel(const std::string& param, const std::string& value);
         void Reset();
 
     private:
         ArduCAM arducam_;
         Image image_;
+        WindowPlan window_plan_;
+        WindowPlan frame_plan_;
+        EdgeFilter prefilter_;
+        // Detection thresholds per output class, quantised for the active model
+        ClassThresholds thresholds_;
+        output_quant_t output_quant_;
+        ScoreGrid score_grid_;
+        OccupancyTracker tracker_;
+        ResultCache cache_;
+        WindowScheduler scheduler_;
+        int inference_budget_ms_;
+        bool frame_mode_;
+        bool grid_telemetry_;
+        // Per-op timing of the model, published while op_profile_ is set
+        OpProfiler profiler_;
+        bool op_profile_;
         void Initialize();
         void Capture();
         void ReadImage();
+        const WindowPlan& ActivePlan() const;
+        void LoadWindowConfig();
+        void SaveWindowConfig();
+        bool ApplyWindowConfig(const window_config_t& config);
+        void LoadPrefilterConfig();
+        void LoadTrackerConfig();
+        void LoadCacheConfig();
+        void LoadTelemetryConfig();
+        void LoadSchedulerConfig();
+        void LoadThresholdConfig();
+        void LoadModels();
+        void ApplyModel();
+        bool SelectModel(int id);
+        void ConfigureFrameGrid();
 
-        /*  Sliding window length is set to 80 to fit with the common 320x240 QVGA image format.
+        // Number of windows reaching each detection stage in one frame
+        typedef struct {
+            size_t num_windows;
+            size_t num_skipped;
+            size_t num_tested;
+            size_t num_passed;
+            size_t num_cached;
+            size_t num_positive;
+            size_t num_carried;
+        } detect_stats_t;
+        bool StartWindows();
+        bool QueueWindows();
+        bool StepWindows(uint32_t timeout_ms, bool& done);
+        bool StartFrame();
+        bool StepFrame(uint32_t timeout_ms, bool& done);
+        void CancelDetect();
+        int16_t PersonScore(const InferenceResult& result) const;
+        static void GrayToModelInput(TensorSpan<int8_t> input);
+
+        /*  Default sliding window geometry, used until a config is persisted.
+            Sliding window length is set to 80 to fit with the common 320x240 QVGA image format.
             For best performance, tune it so that each square is big enough for exactly 1 person.
+            If the stride is smaller than the length then there will be overlap in the
+            inference squares.
+            The geometry can be changed at runtime through Configure(), see Ardu_Camera.cpp.
          */ 
-        static constexpr int sliding_window_length = 80;
-        /*  Sliding window frequency controls the interval at which inference is applied. 
-            If this is smaller than sliding_window_length then there will be overlap in the
-            inference squares. 
+        static constexpr int default_window_length = 80;
+        static constexpr int default_window_stride = default_window_length;
+
+        /*  Default edge energy threshold of the cascade pre-filter, used until a threshold is persisted.
+            Windows with a mean absolute gradient below this many grey levels are counted as empty
+            without running the model. The default only rejects near-uniform windows, 
+            e.g. a lens cap or a blank wall. Raise it for scenes with a plain background, 
+            and set it to 0 to send every window to the model.
+         */
+        static constexpr int default_prefilter_threshold = 2;
+
+        /*  Overlapping windows that detect the same person are merged into one count.
+            Two positive windows are merged if their intersection over union is at least 
+            nms_iou_threshold / 256. The default of 77 (0.3) merges windows that are one stride apart 
+            along a row or column when the stride is at least half the window length.
+            Non-overlapping windows are never merged.
+         */
+        static constexpr uint32_t nms_iou_threshold = 77;
+
+        /*  Score recorded in the occupancy tracker for a window rejected by the pre-filter,
+            i.e. a confident "no person".
          */
-        static constexpr int sliding_window_freq = sliding_window_length;
+        static constexpr int16_t prefilter_reject_score = -255;
+
+        /*  Index of the person score in the model output, and the default person probability 
+            threshold in percent, used until a threshold is persisted. 
+            Raise the threshold to trade missed people for fewer false counts.
+         */
+        static constexpr size_t person_class = 1;
+        static constexpr int default_person_threshold = 50;
+
+        /*  Default number of entries in the window result cache, used until a size is persisted.
+            Up to ResultCache::MAX_ENTRIES entries are statically allocated. 
+            Two windows share a cached result if their perceptual hashes differ by at most 
+            cache_max_distance bits.
+         */
+        static constexpr size_t default_cache_size = 16;
+        static constexpr size_t cache_max_distance = 2;
+
+        /*  Whether the occupancy_grid measure point is published, used until a flag is persisted.
+            The grid is base64 of ScoreGrid::Pack(), e.g. 16 characters for a 3 x 4 grid 
+            and 56 characters for 64 cells.
+         */
+        static constexpr bool default_grid_telemetry = false;
+
+        /*  Default inference time budget per poll, in milliseconds, used until a budget is persisted.
+            Windows are visited in priority order (see WindowScheduler.h) until the budget runs out,
+            and the rest carry over to the next poll with their previous scores.
+            The default leaves half of the 20 s watchdog timeout for capture and publishing.
+            0 visits every window every poll.
+         */
+        static constexpr int default_inference_budget_ms = 10000;
+
+        /*  Largest decoded model update chunk, in bytes. 
+            A chunk of 192 bytes is 256 base64 characters, which leaves room for the DECADA 
+            service JSON within the 500-byte MQTT packet of the client.
+         */
+        static constexpr size_t model_chunk_max_bytes = 192;
+
+        /*  Longest time GetData() waits for inference results before returning DATA_PENDING.
+            The model runs on the inference thread, so the sensor thread can service 
+            control messages and kick the watchdog between waits. Matches the sensor poll tick.
+         */
+        static constexpr uint32_t detect_wait_ms = 1000;
 
         /*  Model-specific parameters
             If you train a different neural network, these should be modified accordingly. 
@@ -50,34 +172,59 @@ class Ardu_Camera : public SensorType {
         static constexpr int cnn_img_width = 96;
         static constexpr Pixel::Format cnn_img_fmt = Pixel::GRAYSCALE;
         static constexpr int cnn_channels = 1;
+        static_assert(cnn_img_fmt == Pixel::GRAYSCALE, "WindowPlan only produces grayscale windows");
+
 
+        /*  The arena size and headroom come from model_data/model_arena_size.h, which is generated 
+            by tools/arena_sizer from the models in camera_models (see Ardu_Camera.cpp). 
+            The tool allocates each model on the host with a RecordingMicroAllocator, 
+            writes the need of the largest one and lists the usage of each by category.
+            The arena is shared by the models and must fit the largest one.
 
-        /*  The model_arena_size given is for the default model. 
-            In general this must be determined by trial and error because
-            Tensorflow does not support compile-time introspection.  
+            After changing a model, rerun the tool as described in tools/arena_sizer/main.cpp.
+            To check the numbers on hardware, set "measure-arena" in mbed_app.json: 
+            ModelManager then logs the same breakdown for each model at start-up.
 
-            To calculate the arena size for a different model:
-            
-            1. Increase model_arena_size to an excess. 
-            2. In mbed_app.json, configure "mbed-trace.max-level" to "TRACE_LEVEL_DEBUG"
-            3. Compile and run the application on hardware. 
-            4. TFLM_Model will print a debug statment, "__ bytes used for tensor arena". 
-            5. The model arena size can be set to the printed value. 
+            Models exported with batch dimension N (see tools/rebatch_model.py) run N windows 
+            per invoke. Each extra batch item adds the two largest activation buffers to the arena, 
+            about 55 KB for the default model. Use the TFLM_Model benchmark test to compare 
+            batch sizes on hardware before increasing the arena.
+
+            Fully-convolutional models (see tools/make_fcn_model.py) score the whole frame 
+            in one invoke. A 96x128 input with a 3x4 grid of cells needs about 135 KB; 
+            a 288x384 input at the window scale needs about 725 KB and does not fit in RAM.
          */
-        static constexpr int model_arena_size = 109796;
-        static constexpr int extra_arena_size = 500;
+        static constexpr int model_arena_size = kModelArenaSize;
+        static constexpr int extra_arena_size = kModelArenaHeadroom;
         static constexpr int tensor_arena_size = model_arena_size + extra_arena_size;
         alignas(16) uint8_t tensor_arena[tensor_arena_size];
 
         static constexpr size_t cam_img_height = 240;
         static constexpr size_t cam_img_width = 320;
         static constexpr size_t cam_channels = 2;
-        static constexpr size_t img_buf_size = cnn_img_height * cnn_img_width * cam_channels;
-        uint8_t img_buf_a[img_buf_size];
-        uint8_t img_buf_b[img_buf_size];
         static constexpr Pixel::Format cam_img_fmt = Pixel::RGB565;
+        // WindowPlan crops, converts and resizes each window straight into an input slot of the model
+        static constexpr size_t window_size = cnn_img_height * cnn_img_width * cnn_channels;
         uint8_t camera_buf[cam_img_height * cam_img_width * cam_channels];
-        TFLM_Model model;
+        ModelManager models_;
+        // Model received over the air, registered after the built-in models if it verifies at boot
+        ModelStore model_store_;
+        int stored_model_id_;
+        // The active model of models_
+        TFLM_Model& model;
+        // Runs the active model on its own thread, see InferenceWorker.h
+        InferenceWorker worker_;
+
+        // The frame being detected; GetData() returns DATA_PENDING until its windows are scored
+        bool frame_pending_;
+        detect_stats_t frame_stats_;
+        uint8_t frame_order_[WindowPlan::MAX_WINDOWS];
+        size_t frame_num_windows_;
+        // Position in frame_order_ of the next window to visit
+        size_t frame_next_;
+        // Perceptual hash of each queued window, by window index, for the result cache
+        uint64_t frame_hashes_[WindowPlan::MAX_WINDOWS];
+        Timer frame_timer_;
 };
 
 # endif // ARDUCAM_CAMERA_H
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include "model/ArenaPlanner.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+
+// Metadata read by MicroAllocator, see GetOfflinePlannedOffsets in lib/tensorflow/lite/micro/micro_allocator.cc
+static const char offline_metadata_name[] = "OfflineMemoryAllocation";
+static constexpr uint32_t offline_metadata_version = 0;
+static constexpr int32_t online_planned = -1;
+// Alignment of tensor buffers in the arena, kBufferAlignment of MicroAllocator
+static constexpr size_t buffer_alignment = 16;
+
+typedef struct {
+    int tensor;
+    size_t bytes;
+    int first_created;
+    int last_used;
+} planned_tensor_t;
+
+// Place the tensors in order, each at the lowest offset free over its lifetime, and return the arena size
+static size_t place(const std::vector<planned_tensor_t>& tensors, const std::vector<int>& order,
+    std::vector<size_t>& offsets)
+{
+    std::vector<std::pair<size_t, size_t>> live;
+    size_t arena_bytes = 0;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const planned_tensor_t& tensor = tensors[order[i]];
+        live.clear();
+        for (size_t j = 0; j < i; j++)
+        {
+            const planned_tensor_t& other = tensors[order[j]];
+            if (other.first_created <= tensor.last_used && other.last_used >= tensor.first_created)
+            {
+                live.push_back(std::make_pair(offsets[order[j]], offsets[order[j]] + other.bytes));
+            }
+        }
+        std::sort(live.begin(), live.end());
+        size_t offset = 0;
+        for (const std::pair<size_t, size_t>& extent : live)
+        {
+            if (extent.first >= offset + tensor.bytes)
+            {
+                break;
+            }
+            offset = std::max(offset, extent.second);
+        }
+        offsets[order[i]] = offset;
+        arena_bytes = std::max(arena_bytes, offset + tensor.bytes);
+    }
+    return arena_bytes;
+}
+
+/*  @brief  Compute an offline memory plan for the activation tensors of the first subgraph.
+    @param  model:      Model mapped with tflite::GetModel().
+            resolver:   Resolver with every op of the model.
+            arena:      Scratch arena, large enough for the model, in which it is allocated
+                        to get the nodes that the interpreter runs.
+            arena_size: Size of arena in bytes.
+            iterations: Pairs of tensors swapped by the search after the heuristic orders.
+            error_reporter: Receives TFLM errors.
+            offsets:    Set to the arena offset of each tensor of the subgraph, or -1 for
+                        tensors that take no arena space.
+            plan:       Set to the arena bytes of the plan, the greedy plan and the lower bound.
+    @return False if the model has no subgraph, cannot be allocated or has a tensor of
+            unsupported type.
+    */
+bool ArenaPlanner::Plan(const tflite::Model* model, const tflite::MicroOpResolver& resolver,
+    uint8_t* arena, size_t arena_size, int iterations, tflite::ErrorReporter* error_reporter,
+    std::vector<int32_t>& offsets, arena_plan_t& plan)
+{
+    if (model == nullptr || model->subgraphs() == nullptr || model->subgraphs()->size() == 0)
+    {
+        return false;
+    }
+    const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+    const int tensor_count = subgraph->tensors()->size();
+    const int operator_count = subgraph->operators()->size();
+
+    // The nodes run by the interpreter, after AllocateTensors has rewritten the graph
+    tflite::MicroInterpreter interpreter(model, resolver, arena, arena_size, error_reporter);
+    if (interpreter.AllocateTensors() != kTfLiteOk || (int)interpreter.operators_size() != operator_count)
+    {
+        return false;
+    }
+
+    // Lifetimes as in AllocationInfoBuilder::AddTensors
+    std::vector<int> first_created(tensor_count, -1);
+    std::vector<int> last_used(tensor_count, -1);
+    for (size_t i = 0; i < subgraph->inputs()->size(); i++)
+    {
+        first_created[subgraph->inputs()->Get(i)] = 0;
+    }
+    for (size_t i = 0; i < subgraph->outputs()->size(); i++)
+    {
+        last_used[subgraph->outputs()->Get(i)] = operator_count - 1;
+    }
+    for (int i = operator_count - 1; i >= 0; i--)
+    {
+        const TfLiteNode& node = interpreter.node_and_registration(i).node;
+        for (int n = 0; n < node.inputs->size; n++)
+        {
+            const int tensor = node.inputs->data[n];
+            if (tensor >= 0 && last_used[tensor] < i)
+            {
+                last_used[tensor] = i;
+            }
+        }
+        for (int n = 0; n < node.outputs->size; n++)
+        {
+            const int tensor = node.outputs->data[n];
+            if (first_created[tensor] == -1 || first_created[tensor] > i)
+            {
+                first_created[tensor] = i;
+            }
+        }
+    }
+
+    // Constant, variable, read-only and unused tensors take no space in the plan
+    std::vector<planned_tensor_t> tensors;
+    for (int i = 0; i < tensor_count; i++)
+    {
+        const tflite::Tensor* tensor = subgraph->tensors()->Get(i);
+        const tflite::Buffer* buffer = model->buffers()->Get(tensor->buffer());
+        const bool is_constant = buffer->data() != nullptr && buffer->data()->size() > 0;
+        if (is_constant || tensor->is_variable() || first_created[i] == -1 || last_used[i] == -1)
+        {
+            continue;
+        }
+        size_t bytes, type_size;
+        if (tflite::BytesRequiredForTensor(*tensor, &bytes, &type_size, error_reporter) != kTfLiteOk)
+        {
+            return false;
+        }
+        tensors.push_back({i, tflite::AlignSizeUp(bytes, buffer_alignment), first_created[i], last_used[i]});
+    }
+
+    plan.lower_bound_bytes = 0;
+    for (int t = 0; t < operator_count; t++)
+    {
+        size_t live_bytes = 0;
+        for (const planned_tensor_t& tensor : tensors)
+        {
+            if (tensor.first_created <= t && tensor.last_used >= t)
+            {
+                live_bytes += tensor.bytes;
+            }
+        }
+        plan.lower_bound_bytes = std::max(plan.lower_bound_bytes, live_bytes);
+    }
+
+    // The plan that MicroAllocator makes at runtime, from the tensors in index order
+    std::vector<uint8_t> planner_scratch(tensors.size() * tflite::GreedyMemoryPlanner::per_buffer_size());
+    tflite::GreedyMemoryPlanner greedy(planner_scratch.data(), planner_scratch.size());
+    for (const planned_tensor_t& tensor : tensors)
+    {
+        if (greedy.AddBuffer(error_reporter, tensor.bytes, tensor.first_created, tensor.last_used) != kTfLiteOk)
+        {
+            return false;
+        }
+    }
+    std::vector<size_t> best_offsets(tensors.size());
+    for (size_t i = 0; i < tensors.size(); i++)
+    {
+        int offset;
+        if (greedy.GetOffsetForBuffer(error_reporter, i, &offset) != kTfLiteOk)
+        {
+            return false;
+        }
+        best_offsets[i] = offset;
+    }
+    plan.greedy_bytes = greedy.GetMaximumMemorySize();
+    plan.planned_bytes = plan.greedy_bytes;
+    plan.orders_tried = 0;
+
+    // Heuristic orders: largest first, by creation, by lifetime, by size x lifetime
+    std::vector<std::vector<int>> orders(4, std::vector<int>(tensors.size()));
+    for (std::vector<int>& order : orders)
+    {
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            order[i] = i;
+        }
+    }
+    auto lifetime = [&](int i) { return tensors[i].last_used - tensors[i].first_created + 1; };
+    std::stable_sort(orders[0].begin(), orders[0].end(),
+        [&](int a, int b) { return tensors[a].bytes > tensors[b].bytes; });
+    std::stable_sort(orders[1].begin(), orders[1].end(), [&](int a, int b) {
+        return tensors[a].first_created < tensors[b].first_created
+            || (tensors[a].first_created == tensors[b].first_created && tensors[a].bytes > tensors[b].bytes);
+    });
+    std::stable_sort(orders[2].begin(), orders[2].end(),
+        [&](int a, int b) { return lifetime(a) > lifetime(b); });
+    std::stable_sort(orders[3].begin(), orders[3].end(),
+        [&](int a, int b) { return tensors[a].bytes * lifetime(a) > tensors[b].bytes * lifetime(b); });
+
+    std::vector<size_t> tensor_offsets(tensors.size());
+    std::vector<int> search_order;
+    size_t search_bytes = 0;
+    auto try_order = [&](const std::vector<int>& order) {
+        size_t bytes = place(tensors, order, tensor_offsets);
+        plan.orders_tried++;
+        if (search_order.empty() || bytes <= search_bytes)
+        {
+            search_order = order;
+            search_bytes = bytes;
+        }
+        if (bytes < plan.planned_bytes)
+        {
+            plan.planned_bytes = bytes;
+            best_offsets = tensor_offsets;
+        }
+    };
+    for (size_t i = 0; i < orders.size() && plan.planned_bytes > plan.lower_bound_bytes; i++)
+    {
+        try_order(orders[i]);
+    }
+
+    // Local search over swaps in the best order, accepting equal plans to move across plateaus
+    uint32_t rng_state = 1;
+    std::vector<int> order;
+    for (int i = 0; i < iterations && tensors.size() > 1 && plan.planned_bytes > plan.lower_bound_bytes; i++)
+    {
+        order = search_order;
+        rng_state = rng_state * 1664525u + 1013904223u;
+        const size_t a = (rng_state >> 8) % order.size();
+        rng_state = rng_state * 1664525u + 1013904223u;
+        const size_t b = (rng_state >> 8) % order.size();
+        std::swap(order[a], order[b]);
+        try_order(order);
+    }
+
+    offsets.assign(tensor_count, online_planned);
+    for (size_t i = 0; i < tensors.size(); i++)
+    {
+        offsets[tensors[i].tensor] = best_offsets[i];
+    }
+    plan.tensor_count = tensors.size();
+    return true;
+}
+
+/*  @brief  Copy a model with offline planner metadata holding the given offsets, replacing any
+            offline plan it already has.
+    @param  model:          Model mapped with tflite::GetModel().
+            offsets:        Arena offset of each tensor of the first subgraph, from Plan().
+            planned_model:  Set to the flatbuffer of the model with the plan.
+    @return False if the offsets do not match the tensors of the model.
+    */
+bool ArenaPlanner::Embed(const tflite::Model* model, const std::vector<int32_t>& offsets,
+    std::vector<uint8_t>& planned_model)
+{
+    if (model == nullptr || model->subgraphs() == nullptr || model->subgraphs()->size() == 0
+            || model->subgraphs()->Get(0)->tensors()->size() != offsets.size())
+    {
+        return false;
+    }
+    std::unique_ptr<tflite::ModelT> unpacked(model->UnPack());
+
+    // Format of the metadata buffer: version, subgraph index, number of offsets, offsets
+    std::vector<int32_t> words = {(int32_t)offline_metadata_version, 0, (int32_t)offsets.size()};
+    words.insert(words.end(), offsets.begin(), offsets.end());
+    std::vector<uint8_t> data(words.size() * sizeof(int32_t));
+    memcpy(data.data(), words.data(), data.size());
+
+    tflite::MetadataT* metadata = nullptr;
+    for (std::unique_ptr<tflite::MetadataT>& entry : unpacked->metadata)
+    {
+        if (entry->name == offline_metadata_name)
+        {
+            metadata = entry.get();
+        }
+    }
+    if (metadata == nullptr)
+    {
+        unpacked->buffers.emplace_back(new tflite::BufferT());
+        unpacked->metadata.emplace_back(new tflite::MetadataT());
+        metadata = unpacked->metadata.back().get();
+        metadata->name = offline_metadata_name;
+        metadata->buffer = unpacked->buffers.size() - 1;
+    }
+    unpacked->buffers[metadata->buffer]->data = data;
+
+    flatbuffers::FlatBufferBuilder fbb;
+    tflite::FinishModelBuffer(fbb, tflite::Model::Pack(fbb, unpacked.get()));
+    planned_model.assign(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+    return true;
+}
@@ -0,0 +1,64 @@
+# ifndef ARENA_PLANNER_H
+# define ARENA_PLANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+// Arena bytes of the activation tensors of a model, by memory plan
+typedef struct {
+    size_t lower_bound_bytes;   // Largest total of tensors live at the same time, which no plan beats
+    size_t greedy_bytes;        // Plan of the TFLM GreedyMemoryPlanner, as made at runtime
+    size_t planned_bytes;       // Best plan found
+    int tensor_count;           // Tensors placed by the plan
+    int orders_tried;           // Placement orders evaluated by the search
+} arena_plan_t;
+
+/** ArenaPlanner class.
+ *  @brief  Searches for a tighter layout of the activation tensors of a model than the
+            GreedyMemoryPlanner that TFLM runs at every AllocateTensors, and embeds it in the
+            model as "OfflineMemoryAllocation" metadata, which MicroAllocator then uses as is.
+            Tensor lifetimes are taken from the nodes of a MicroInterpreter after AllocateTensors,
+            so after its graph rewrites such as operator fusion, exactly as MicroAllocator does.
+            A plan therefore holds for TFLM built with the same options; under other options
+            MicroAllocator plans the tensors whose offline offsets conflict online.
+
+            Layouts are built by placing tensors one at a time at the lowest offset free for
+            their lifetime. The search starts from a few heuristic orders, then swaps pairs of
+            tensors in the best order, and stops early when the plan reaches the lower bound.
+            The greedy plan is kept when nothing better is found.
+
+            Used on the host by tools/arena_planner. Embedding needs heap for a copy of the model.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "ArenaPlanner.h"
+ *
+ *  int main()
+ *  {
+        std::vector<int32_t> offsets;
+        std::vector<uint8_t> planned_model;
+        arena_plan_t plan;
+        const tflite::Model* model = tflite::GetModel(g_person_detect_model_data);
+        if (ArenaPlanner::Plan(model, resolver, scratch_arena, sizeof(scratch_arena), 10000,
+                error_reporter, offsets, plan)
+                && ArenaPlanner::Embed(model, offsets, planned_model)) {
+            printf("%d bytes instead of %d\n", plan.planned_bytes, plan.greedy_bytes);
+        }
+ *  }
+ *  @endcode
+ */
+class ArenaPlanner {
+
+    public:
+        static bool Plan(const tflite::Model* model, const tflite::MicroOpResolver& resolver,
+            uint8_t* arena, size_t arena_size, int iterations, tflite::ErrorReporter* error_reporter,
+            std::vector<int32_t>& offsets, arena_plan_t& plan);
+        static bool Embed(const tflite::Model* model, const std::vector<int32_t>& offsets,
+            std::vector<uint8_t>& planned_model);
+};
+
+# endif // ARENA_PLANNER_H
@@ -0,0 +1,60 @@
+#include "model/ArenaSizer.h"
+#include "tensorflow/lite/micro/recording_micro_interpreter.h"
+#include "tensorflow/lite/version.h"
+
+/*  @brief  Allocate a model in a scratch arena and record its tensor arena use.
+            The model is allocated twice: once by a RecordingMicroInterpreter for the breakdown,
+            and once by a regular MicroInterpreter for the exact total, because the recording
+            allocator objects also live in the arena and are larger than the regular ones.
+            The arena is left unusable for other interpreters until they are re-initialized.
+    @param  model:          Model mapped with tflite::GetModel().
+            resolver:       Resolver with every op of the model.
+            arena:          Scratch arena aligned to 16 bytes, larger than the model needs.
+            arena_size:     Size of the scratch arena in bytes.
+            error_reporter: Receives TFLM errors.
+            usage:          Set to the measured arena use.
+    @return False if there is no model, it has the wrong schema version or does not fit in the arena.
+    */
+bool ArenaSizer::Measure(const tflite::Model* model, const tflite::MicroOpResolver& resolver,
+    uint8_t* arena, size_t arena_size, tflite::ErrorReporter* error_reporter, arena_usage_t& usage)
+{
+    if (model == nullptr)
+    {
+        TF_LITE_REPORT_ERROR(error_reporter, "No model to measure");
+        return false;
+    }
+    if (model->version() != TFLITE_SCHEMA_VERSION)
+    {
+        TF_LITE_REPORT_ERROR(error_reporter, "Model schema version %d not supported", model->version());
+        return false;
+    }
+    {
+        tflite::RecordingMicroInterpreter interpreter(model, resolver, arena, arena_size, error_reporter);
+        if (interpreter.AllocateTensors() != kTfLiteOk)
+        {
+            return false;
+        }
+        const tflite::RecordingMicroAllocator& allocator = interpreter.GetMicroAllocator();
+        usage.head_bytes = allocator.GetSimpleMemoryAllocator()->GetHeadUsedBytes();
+        usage.tensor_struct_bytes = 
+            allocator.GetRecordedAllocation(tflite::RecordedAllocationType::kTfLiteTensorArray).used_bytes +
+            allocator.GetRecordedAllocation(tflite::RecordedAllocationType::kTfLiteTensorArrayQuantizationData).used_bytes;
+        usage.node_registration_bytes = 
+            allocator.GetRecordedAllocation(tflite::RecordedAllocationType::kNodeAndRegistrationArray).used_bytes;
+        usage.op_data_bytes = allocator.GetRecordedAllocation(tflite::RecordedAllocationType::kOpData).used_bytes;
+        usage.variable_bytes = 
+            allocator.GetRecordedAllocation(tflite::RecordedAllocationType::kTfLiteTensorVariableBufferData).used_bytes;
+    }
+
+    tflite::MicroInterpreter interpreter(model, resolver, arena, arena_size, error_reporter);
+    if (interpreter.AllocateTensors() != kTfLiteOk)
+    {
+        return false;
+    }
+    usage.used_bytes = interpreter.arena_used_bytes();
+    usage.tail_bytes = usage.used_bytes - usage.head_bytes;
+    size_t recorded = usage.tensor_struct_bytes + usage.node_registration_bytes + 
+        usage.op_data_bytes + usage.variable_bytes;
+    usage.other_bytes = (usage.tail_bytes > recorded) ? usage.tail_bytes - recorded : 0;
+    return true;
+}
@@ -0,0 +1,52 @@
+# ifndef ARENA_SIZER_H
+# define ARENA_SIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+// Tensor arena bytes used by one model, by category
+typedef struct {
+    size_t used_bytes;              // Arena size a MicroInterpreter needs for the model
+    size_t head_bytes;              // Activation tensors and kernel scratch buffers, overlapped by the memory planner
+    size_t tail_bytes;              // Persistent allocations, broken down below
+    size_t tensor_struct_bytes;     // TfLiteTensor structs and their quantization parameters
+    size_t node_registration_bytes; // NodeAndRegistration structs, one per operator
+    size_t op_data_bytes;           // Kernel data allocated in Prepare, e.g. per-channel multipliers
+    size_t variable_bytes;          // Buffers of variable tensors
+    size_t other_bytes;             // Allocator and memory planner bookkeeping
+} arena_usage_t;
+
+/** ArenaSizer class.
+ *  @brief  Measures the tensor arena need of a model with a RecordingMicroInterpreter,
+            which allocates the model exactly as TFLM_Model does and records each allocation.
+            It only depends on TensorFlow Lite Micro, so the same measurement runs on the device
+            (see TFLM_Model::MeasureArena) and on the host (see tools/arena_sizer), 
+            where it writes model_data/model_arena_size.h for Ardu_Camera.
+
+            Sizes depend on the pointer size, so measure with a 32-bit build to match the device.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "ArenaSizer.h"
+ *
+ *  int main()
+ *  {
+        arena_usage_t usage;
+        if (ArenaSizer::Measure(tflite::GetModel(g_person_detect_model_data), resolver, 
+                scratch_arena, sizeof(scratch_arena), error_reporter, usage)) {
+            printf("%d bytes\n", usage.used_bytes);
+        }
+ *  }
+ *  @endcode
+ */
+class ArenaSizer {
+
+    public:
+        static bool Measure(const tflite::Model* model, const tflite::MicroOpResolver& resolver,
+            uint8_t* arena, size_t arena_size, tflite::ErrorReporter* error_reporter, arena_usage_t& usage);
+};
+
+# endif // ARENA_SIZER_H
@@ -1,6 +1,7 @@
 # ifndef BASE_MODEL_H
 # define BASE_MODEL_H
 
+#include <cstddef>
 #include <cstdint>
 
 class Base_Model {
@@ -8,6 +9,14 @@ class Base_Model {
         virtual void Initialize(void) = 0;
         virtual uint8_t* RunInference(uint8_t* input_buf) = 0;
 
+        // A window classifier scores one cell per input. A fully-convolutional model 
+        // scores a grid of cells over its whole input, with the output holding 
+        // one row of class scores per cell in row-major order.
+        virtual size_t GetInputHeight(void) const = 0;
+        virtual size_t GetInputWidth(void) const = 0;
+        virtual size_t GetNumCells(void) const = 0;
+        virtual size_t GetNumClasses(void) const = 0;
+
 };
 
 # endif //BASE_MODEL_H
\ No newline at end of file
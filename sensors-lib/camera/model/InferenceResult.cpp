@@ -0,0 +1,194 @@
+#include <cmath>
+#include "model/InferenceResult.h"
+
+/*  @brief  Create an empty result, e.g. for a failed inference.
+    */
+InferenceResult::InferenceResult(void):
+    quant_({kTfLiteNoType, 0.0f, 0}),
+    scores_(nullptr),
+    num_classes_(0)
+{
+}
+
+/*  @brief  Create a view of the scores of one output item.
+    @param  quant:       Type and quantisation of the output tensor; only kTfLiteInt8
+                         and kTfLiteUInt8 are supported, other types give an empty result.
+            scores:      First score of the item.
+            num_classes: Number of scores in the item.
+    */
+InferenceResult::InferenceResult(const output_quant_t& quant, const void* scores, size_t num_classes):
+    quant_(quant),
+    scores_(scores),
+    num_classes_(num_classes)
+{
+    if (scores == nullptr || (quant.type != kTfLiteInt8 && quant.type != kTfLiteUInt8)) {
+        scores_ = nullptr;
+        num_classes_ = 0;
+    }
+}
+
+/*  @brief  Check whether the result holds no scores.
+    */
+bool InferenceResult::empty(void) const
+{
+    return num_classes_ == 0;
+}
+
+/*  @brief  Get the number of class scores.
+    */
+size_t InferenceResult::GetNumClasses(void) const
+{
+    return num_classes_;
+}
+
+/*  @brief  Get the type and quantisation of the scores.
+    */
+const output_quant_t& InferenceResult::GetQuant(void) const
+{
+    return quant_;
+}
+
+/*  @brief  Get the quantised score of a class, widened to 32 bits.
+    @return The score, or the zero point if the class does not exist.
+    */
+int32_t InferenceResult::GetQuantized(size_t cls) const
+{
+    if (cls >= num_classes_) {
+        return quant_.zero_point;
+    }
+    if (quant_.type == kTfLiteUInt8) {
+        return static_cast<const uint8_t*>(scores_)[cls];
+    }
+    return static_cast<const int8_t*>(scores_)[cls];
+}
+
+/*  @brief  Get the dequantised score of a class, e.g. a probability for a softmax output.
+    @return The score, or 0 if the class does not exist.
+    */
+float InferenceResult::GetScore(size_t cls) const
+{
+    return quant_.scale * (GetQuantized(cls) - quant_.zero_point);
+}
+
+/*  @brief  Get the class with the highest score; the lowest index wins a tie.
+    @return The class index, or 0 for an empty result.
+    */
+size_t InferenceResult::Argmax(void) const
+{
+    size_t best = 0;
+    for (size_t cls = 1; cls < num_classes_; cls++) {
+        if (GetQuantized(cls) > GetQuantized(best)) {
+            best = cls;
+        }
+    }
+    return best;
+}
+
+/*  @brief  Get the k classes with the highest scores, highest first; the lowest index wins a tie.
+    @param  k:       Number of classes wanted.
+            classes: Filled with up to k class indices.
+    @return Number of classes written, the smaller of k and GetNumClasses().
+    */
+size_t InferenceResult::TopK(size_t k, size_t* classes) const
+{
+    size_t count = (k < num_classes_) ? k : num_classes_;
+    for (size_t rank = 0; rank < count; rank++) {
+        size_t best = num_classes_;
+        for (size_t cls = 0; cls < num_classes_; cls++) {
+            bool taken = false;
+            for (size_t prev = 0; prev < rank; prev++) {
+                taken = taken || classes[prev] == cls;
+            }
+            if (!taken && (best == num_classes_ || GetQuantized(cls) > GetQuantized(best))) {
+                best = cls;
+            }
+        }
+        classes[rank] = best;
+    }
+    return count;
+}
+
+/*  @brief  Convert a dequantised score to the nearest quantised value, saturated to the type range.
+            Used when configuring thresholds, outside the hot path.
+    */
+int32_t InferenceResult::Quantize(const output_quant_t& quant, float score)
+{
+    int32_t min = (quant.type == kTfLiteUInt8) ? 0 : -128;
+    int32_t max = (quant.type == kTfLiteUInt8) ? 255 : 127;
+    if (!(quant.scale > 0.0f)) {
+        return quant.zero_point;
+    }
+    float value = std::round(score / quant.scale) + quant.zero_point;
+    if (value < min) {
+        return min;
+    }
+    if (value > max) {
+        return max;
+    }
+    return static_cast<int32_t>(value);
+}
+
+/*  @brief  Create thresholds with every class at the same threshold.
+            They must be quantised with Quantize() before use.
+    */
+ClassThresholds::ClassThresholds(float threshold):
+    quant_({kTfLiteNoType, 0.0f, 0})
+{
+    for (size_t cls = 0; cls < MAX_CLASSES; cls++) {
+        thresholds_[cls] = threshold;
+        quantized_[cls] = 0;
+    }
+}
+
+/*  @brief  Change the threshold of one class, and quantise it for the current output.
+    @return False if the class index is MAX_CLASSES or more.
+    */
+bool ClassThresholds::Set(size_t cls, float threshold)
+{
+    if (cls >= MAX_CLASSES) {
+        return false;
+    }
+    thresholds_[cls] = threshold;
+    quantized_[cls] = InferenceResult::Quantize(quant_, threshold);
+    return true;
+}
+
+/*  @brief  Get the dequantised threshold of a class, or 0 if the class does not exist.
+    */
+float ClassThresholds::Get(size_t cls) const
+{
+    return (cls < MAX_CLASSES) ? thresholds_[cls] : 0.0f;
+}
+
+/*  @brief  Quantise every threshold for the output tensor of a new model.
+    */
+void ClassThresholds::Quantize(const output_quant_t& quant)
+{
+    quant_ = quant;
+    for (size_t cls = 0; cls < MAX_CLASSES; cls++) {
+        quantized_[cls] = InferenceResult::Quantize(quant_, thresholds_[cls]);
+    }
+}
+
+/*  @brief  Get the quantised threshold of a class, or 0 if the class does not exist.
+    */
+int32_t ClassThresholds::GetQuantized(size_t cls) const
+{
+    return (cls < MAX_CLASSES) ? quantized_[cls] : 0;
+}
+
+/*  @brief  Get how far the score of a class lies above its threshold, in quantisation steps.
+    @return Quantised score minus quantised threshold; negative below the threshold.
+    */
+int32_t ClassThresholds::Margin(const InferenceResult& result, size_t cls) const
+{
+    return result.GetQuantized(cls) - GetQuantized(cls);
+}
+
+/*  @brief  Check whether a class is detected, i.e. its score is at least its threshold.
+    @return False if the class does not exist in the result.
+    */
+bool ClassThresholds::IsDetected(const InferenceResult& result, size_t cls) const
+{
+    return cls < result.GetNumClasses() && Margin(result, cls) >= 0;
+}
@@ -0,0 +1,87 @@
+# ifndef INFERENCE_RESULT_H
+# define INFERENCE_RESULT_H
+
+#include <cstddef>
+#include <cstdint>
+#include "tensorflow/lite/c/common.h"
+
+// Element type and affine quantisation of a model output tensor:
+// score = scale * (quantised value - zero_point)
+typedef struct {
+    TfLiteType type;
+    float scale;
+    int32_t zero_point;
+} output_quant_t;
+
+/** InferenceResult class.
+ *  @brief  Typed view of the class scores of one output item, i.e. one window or one cell,
+            that knows the type and quantisation of the output tensor.
+            Ranking and thresholds work on the quantised integers, which preserve the order
+            of the scores, so no float conversion takes place in the hot path.
+            GetScore() dequantises a single score for reporting.
+            The view does not own the scores; they must outlive it.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "InferenceResult.h"
+ *
+ *  int main()
+ *  {
+        model.Invoke<int8_t>();
+        InferenceResult result = model.GetResult(0);
+        size_t best = result.Argmax();
+        float probability = result.GetScore(best);  // e.g. 0.93
+        size_t top[2];
+        size_t count = result.TopK(2, top);
+ *  }
+ *  @endcode
+ */
+class InferenceResult {
+
+    public:
+        InferenceResult(void);
+        InferenceResult(const output_quant_t& quant, const void* scores, size_t num_classes);
+
+        bool empty(void) const;
+        size_t GetNumClasses(void) const;
+        const output_quant_t& GetQuant(void) const;
+        int32_t GetQuantized(size_t cls) const;
+        float GetScore(size_t cls) const;
+        size_t Argmax(void) const;
+        size_t TopK(size_t k, size_t* classes) const;
+
+        static int32_t Quantize(const output_quant_t& quant, float score);
+
+    private:
+        output_quant_t quant_;
+        const void* scores_;
+        size_t num_classes_;
+};
+
+/** ClassThresholds class.
+ *  @brief  Per-class detection thresholds, set as dequantised scores (e.g. probabilities)
+            and kept quantised for the output of the active model,
+            so that a result is checked with one integer comparison per class.
+            Call Quantize() whenever the model changes.
+ */
+class ClassThresholds {
+
+    public:
+        static constexpr size_t MAX_CLASSES = 16;
+
+        ClassThresholds(float threshold);
+
+        bool Set(size_t cls, float threshold);
+        float Get(size_t cls) const;
+        void Quantize(const output_quant_t& quant);
+        int32_t GetQuantized(size_t cls) const;
+        int32_t Margin(const InferenceResult& result, size_t cls) const;
+        bool IsDetected(const InferenceResult& result, size_t cls) const;
+
+    private:
+        float thresholds_[MAX_CLASSES];
+        int32_t quantized_[MAX_CLASSES];
+        output_quant_t quant_;
+};
+
+# endif // INFERENCE_RESULT_H
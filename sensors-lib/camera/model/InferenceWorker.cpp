@@ -0,0 +1,147 @@
+#include "model/InferenceWorker.h"
+#include "mbed_trace.h"
+
+# define TRACE_GROUP "InferenceWorker.cpp"
+
+/*  @brief  Create a worker for a model. The thread is created by Start().
+    @param  model:      Model to run. It must be initialized before requests are submitted.
+            priority:   Priority of the inference thread.
+            stack_size: Stack size of the inference thread, in bytes.
+    */
+InferenceWorker::InferenceWorker(TFLM_Model& model, osPriority priority, uint32_t stack_size):
+    model_(model),
+    thread_(priority, stack_size, nullptr, "InferenceThread"),
+    num_pending_(0),
+    started_(false)
+{
+}
+
+/*  @brief  Start the inference thread.
+    @return True if the thread is running.
+    */
+bool InferenceWorker::Start(void)
+{
+    if (started_) {
+        return true;
+    }
+    if (thread_.start(callback(this, &InferenceWorker::Run)) != osOK) {
+        tr_err("Inference thread could not be started");
+        return false;
+    }
+    started_ = true;
+    return true;
+}
+
+/*  @brief  Run the model on the input slots filled in place by the caller, from slot 0.
+            One response per slot must then be collected with GetResponse(),
+            and the input slots must not be written until they are.
+    @param  tags:       Tag of each slot, returned in its response.
+            num_slots:  Number of filled slots, at most the batch size of the model.
+    @return False if a batch is still pending or the slots do not fit the model.
+    */
+bool InferenceWorker::Submit(const uint32_t* tags, size_t num_slots)
+{
+    if (num_pending_ > 0 || num_slots == 0 || num_slots > MAX_BATCH_SIZE
+            || num_slots > model_.GetBatchSize()) {
+        return false;
+    }
+    request_t* request = requests_.alloc();
+    if (request == nullptr) {
+        return false;
+    }
+    for (size_t slot = 0; slot < num_slots; slot++) {
+        request->tags[slot] = tags[slot];
+    }
+    request->num_slots = num_slots;
+    num_pending_ += num_slots;
+    requests_.put(request);
+    return true;
+}
+
+/*  @brief  Collect the response of a submitted slot, in slot order.
+    @param  response:   Filled with the response.
+            timeout_ms: Time to wait for a response; 0 returns at once, osWaitForever blocks.
+    @return False if no response arrived within the timeout.
+    */
+bool InferenceWorker::GetResponse(response_t& response, uint32_t timeout_ms)
+{
+    if (num_pending_ == 0) {
+        return false;
+    }
+    osEvent evt = responses_.get(timeout_ms);
+    if (evt.status != osEventMail) {
+        return false;
+    }
+    response_t* mail = (response_t*)evt.value.p;
+    response = *mail;
+    responses_.free(mail);
+    num_pending_--;
+    return true;
+}
+
+/*  @brief  Wait for every pending request and drop the responses, e.g. before reconfiguring the model.
+    */
+void InferenceWorker::Flush(void)
+{
+    response_t response;
+    while (num_pending_ > 0) {
+        GetResponse(response, osWaitForever);
+    }
+}
+
+/*  @brief  Get the number of submitted slots whose response has not been collected yet.
+    */
+size_t InferenceWorker::GetNumPending(void) const
+{
+    return num_pending_;
+}
+
+/*  @brief  Body of the inference thread: invoke the model once per request,
+            then answer each of its slots.
+    */
+void InferenceWorker::Run(void)
+{
+    while (true) {
+        osEvent evt = requests_.get(osWaitForever);
+        if (evt.status != osEventMail) {
+            continue;
+        }
+        request_t* request = (request_t*)evt.value.p;
+        uint32_t tags[MAX_BATCH_SIZE];
+        size_t num_slots = request->num_slots;
+        for (size_t slot = 0; slot < num_slots; slot++) {
+            tags[slot] = request->tags[slot];
+        }
+        requests_.free(request);
+
+        TensorSpan<const int8_t> output = model_.Invoke<int8_t>();
+        // Kick the watchdog after every inference because application will time out otherwise
+        Watchdog::get_instance().kick();
+        size_t item_size = model_.GetOutputItemBytes();
+        bool ok = !output.empty();
+        if (!ok) {
+            tr_err("Inference failed");
+        }
+        for (size_t slot = 0; slot < num_slots; slot++) {
+            if (ok && item_size <= MAX_OUTPUT_BYTES) {
+                Respond(tags[slot], true, item_size, output.Slice(slot * item_size, item_size).data());
+            } else {
+                Respond(tags[slot], ok, 0, nullptr);
+            }
+        }
+    }
+}
+
+/*  @brief  Post a response, waiting for a free one if the producer is behind.
+    */
+void InferenceWorker::Respond(uint32_t tag, bool ok, size_t num_bytes, const int8_t* output)
+{
+    response_t* response = responses_.alloc(osWaitForever);
+    response->tag = tag;
+    response->ok = ok;
+    response->num_bytes = num_bytes;
+    for (size_t i = 0; i < num_bytes; i++) {
+        response->output[i] = output[i];
+    }
+    responses_.put(response);
+}
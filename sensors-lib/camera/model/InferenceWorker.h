@@ -0,0 +1,87 @@
+# ifndef INFERENCE_WORKER_H
+# define INFERENCE_WORKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "mbed.h"
+#include "model/TFLM_Model.h"
+
+/** InferenceWorker class.
+ *  @brief  Runs a TFLM_Model on its own thread, one batch of inputs per request.
+            The producer preprocesses its inputs straight into the input slots of the model
+            (TFLM_Model::GetInput()) and submits the tags of the filled slots. The worker 
+            invokes the model once and posts one response per slot with its output.
+            Inputs are never copied, but the input tensor shares the arena with the other 
+            activations, so the producer only writes it while GetNumPending() is 0, 
+            i.e. once every response of the previous batch is collected.
+            The thread runs below normal priority by default, so inference only takes
+            the CPU time that the application threads leave idle.
+            Once started, the worker owns the model: only reconfigure or invoke it
+            from another thread while GetNumPending() is 0.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "InferenceWorker.h"
+ *
+ *  static InferenceWorker worker(model);
+ *
+ *  int main()
+ *  {
+        worker.Start();
+        fill_window(model.GetInput<int8_t>(0));
+        uint32_t tag = 7;
+        worker.Submit(&tag, 1);
+
+        InferenceWorker::response_t response;
+        worker.GetResponse(response, osWaitForever);
+        // response.tag == 7, response.output holds the scores of the window
+ *  }
+ *  @endcode
+ */
+class InferenceWorker {
+
+    public:
+        // Most input slots run by one request, and responses awaiting collection
+        static constexpr size_t MAX_BATCH_SIZE = MBED_CONF_APP_INFERENCE_MAX_BATCH;
+        static constexpr size_t MAX_OUTPUT_BYTES = 16;
+
+        typedef struct {
+            // Returned unchanged in the response of each slot
+            uint32_t tags[MAX_BATCH_SIZE];
+            // Input slots filled by the producer, from slot 0
+            size_t num_slots;
+        } request_t;
+
+        typedef struct {
+            uint32_t tag;
+            bool ok;
+            // Bytes of output of the slot, 0 if the output is larger than MAX_OUTPUT_BYTES
+            // and must be read from the model once every response is collected
+            size_t num_bytes;
+            int8_t output[MAX_OUTPUT_BYTES];
+        } response_t;
+
+        InferenceWorker(TFLM_Model& model,
+                osPriority priority = osPriorityBelowNormal,
+                uint32_t stack_size = OS_STACK_SIZE);
+
+        bool Start(void);
+        bool Submit(const uint32_t* tags, size_t num_slots);
+        bool GetResponse(response_t& response, uint32_t timeout_ms);
+        void Flush(void);
+        size_t GetNumPending(void) const;
+
+    private:
+        TFLM_Model& model_;
+        Thread thread_;
+        Mail<request_t, 1> requests_;
+        Mail<response_t, MAX_BATCH_SIZE> responses_;
+        // Requests submitted and not yet collected, only changed by the producer
+        size_t num_pending_;
+        bool started_;
+
+        void Run(void);
+        void Respond(uint32_t tag, bool ok, size_t num_bytes, const int8_t* output);
+};
+
+# endif // INFERENCE_WORKER_H
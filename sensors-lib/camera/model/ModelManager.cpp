@@ -0,0 +1,125 @@
+#include "model/ModelManager.h"
+#include "mbed_trace.h"
+
+# define TRACE_GROUP "ModelManager.cpp"
+
+/*  @brief  Create a manager with no models over a caller-owned tensor arena.
+    @param  tensor_arena: Arena shared by every model, aligned to 16 bytes.
+            arena_size:   Size of the arena in bytes.
+            verbose:      Passed on to TFLM_Model.
+    */
+ModelManager::ModelManager(uint8_t* tensor_arena, size_t arena_size, bool verbose):
+    model_(nullptr, arena_size, tensor_arena, verbose),
+    num_models_(0),
+    active_(-1)
+{
+}
+
+/*  @brief  Add a model and load it once to measure its tensor arena need. 
+            The new model is left active.
+    @param  model_data: Flatbuffer of the model in flash.
+    @return Id of the model for Select(), or -1 if MAX_MODELS are already registered 
+            or the model cannot be loaded into the arena.
+    */
+int ModelManager::Register(const unsigned char* model_data)
+{
+    if (num_models_ >= MAX_MODELS || model_data == nullptr)
+    {
+        return -1;
+    }
+    model_.SetModel(model_data);
+    model_.Initialize();
+    if (!model_.IsInitialized())
+    {
+        tr_err("Model %d does not fit in the tensor arena", num_models_);
+        active_ = -1;
+        return -1;
+    }
+    models_[num_models_] = model_data;
+    arena_bytes_[num_models_] = model_.GetArenaUsedBytes();
+    tr_info("Model %d registered, %d arena bytes", num_models_, arena_bytes_[num_models_]);
+#if MBED_CONF_APP_MEASURE_ARENA
+    LogArenaUsage(num_models_);
+#endif
+    active_ = num_models_;
+    return num_models_++;
+}
+
+/*  @brief  Log the arena use of the loaded model by category, then load it again.
+            Compare with the comments of model_data/model_arena_size.h.
+    */
+void ModelManager::LogArenaUsage(size_t id)
+{
+    arena_usage_t usage;
+    if (model_.MeasureArena(usage))
+    {
+        tr_info("Model %d arena: %d bytes, head %d (tensor data and scratch buffers), tail %d", 
+            id, usage.used_bytes, usage.head_bytes, usage.tail_bytes);
+        tr_info("Model %d arena tail: tensors %d, nodes %d, op data %d, variables %d, bookkeeping %d", 
+            id, usage.tensor_struct_bytes, usage.node_registration_bytes, usage.op_data_bytes, 
+            usage.variable_bytes, usage.other_bytes);
+    }
+    model_.Initialize();
+}
+
+/*  @brief  Make a registered model the active one, replacing the interpreter of the previous one.
+            Selecting the active model again keeps its interpreter.
+    @return False if the id is not registered or the model failed to load, 
+            in which case no model is active.
+    */
+bool ModelManager::Select(size_t id)
+{
+    if (id >= num_models_)
+    {
+        return false;
+    }
+    if ((int)id == active_)
+    {
+        return true;
+    }
+    model_.SetModel(models_[id]);
+    model_.Initialize();
+    active_ = model_.IsInitialized() ? (int)id : -1;
+    return active_ >= 0;
+}
+
+/*  @brief  Get the active model. Its tensor spans are invalidated by the next Select().
+    */
+TFLM_Model& ModelManager::GetModel(void)
+{
+    return model_;
+}
+
+/*  @brief  Get the id of the active model, or -1 if none is active.
+    */
+int ModelManager::GetActiveId(void) const
+{
+    return active_;
+}
+
+/*  @brief  Get the number of registered models.
+    */
+size_t ModelManager::GetNumModels(void) const
+{
+    return num_models_;
+}
+
+/*  @brief  Get the tensor arena bytes used by a registered model, or 0 if the id is not registered.
+    */
+size_t ModelManager::GetArenaBytes(size_t id) const
+{
+    return (id < num_models_) ? arena_bytes_[id] : 0;
+}
+
+/*  @brief  Get the tensor arena bytes needed to run every registered model, 
+            i.e. the need of the largest one.
+    */
+size_t ModelManager::GetRequiredArenaBytes(void) const
+{
+    size_t required = 0;
+    for (size_t id = 0; id < num_models_; id++)
+    {
+        required = (arena_bytes_[id] > required) ? arena_bytes_[id] : required;
+    }
+    return required;
+}
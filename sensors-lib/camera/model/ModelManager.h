@@ -0,0 +1,57 @@
+# ifndef MODEL_MANAGER_H
+# define MODEL_MANAGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "model/TFLM_Model.h"
+
+/** ModelManager class.
+ *  @brief  Holds several models in flash and time-multiplexes them over one shared tensor arena.
+            Only the active model has an interpreter; selecting another model destroys it 
+            and builds a new one in the same arena, without a reboot or heap allocation.
+            Register() loads each model once to measure its arena need, so the arena 
+            can be sized to the largest model with GetRequiredArenaBytes().
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "ModelManager.h"
+ *
+ *  alignas(16) static uint8_t arena[120 * 1024];
+ *  static ModelManager manager(arena, sizeof(arena));
+ *
+ *  int main()
+ *  {
+        int day = manager.Register(g_day_model_data);
+        int night = manager.Register(g_night_model_data);
+        manager.Select(night);
+        TensorSpan<const int8_t> output = manager.GetModel().Invoke<int8_t>();
+ *  }
+ *  @endcode
+ */
+class ModelManager {
+
+    public:
+        static constexpr size_t MAX_MODELS = 4;
+
+        ModelManager(uint8_t* tensor_arena, size_t arena_size, bool verbose = false);
+
+        int Register(const unsigned char* model_data);
+        bool Select(size_t id);
+        TFLM_Model& GetModel(void);
+
+        int GetActiveId(void) const;
+        size_t GetNumModels(void) const;
+        size_t GetArenaBytes(size_t id) const;
+        size_t GetRequiredArenaBytes(void) const;
+
+    private:
+        TFLM_Model model_;
+        const unsigned char* models_[MAX_MODELS];
+        size_t arena_bytes_[MAX_MODELS];
+        size_t num_models_;
+        int active_;
+
+        void LogArenaUsage(size_t id);
+};
+
+# endif // MODEL_MANAGER_H
@@ -0,0 +1,273 @@
+#include "model/ModelStore.h"
+#include "mbed_trace.h"
+#include "mbedtls/sha256.h"
+
+# define TRACE_GROUP "ModelStore.cpp"
+
+/*  @brief  Create a store over a reserved flash region. Nothing is read or written until used.
+    @param  address: Start of the region, aligned to a flash sector.
+            size:    Size of the region in bytes.
+    */
+ModelStore::ModelStore(uint32_t address, uint32_t size):
+    address_(address),
+    size_(size),
+    model_size_(0),
+    updating_(false),
+    expected_size_(0),
+    received_(0),
+    programmed_(0),
+    page_fill_(0)
+{
+}
+
+/*  @brief  Check the stored model against its header.
+    @return Pointer to the model in flash, or nullptr if there is no model 
+            or its size or SHA-256 digest does not match.
+    */
+const unsigned char* ModelStore::Load(void)
+{
+    model_size_ = 0;
+    if (updating_)
+    {
+        return nullptr;
+    }
+    const header_t* header = reinterpret_cast<const header_t*>(address_);
+    if (header->magic != MAGIC)
+    {
+        tr_info("No stored model");
+        return nullptr;
+    }
+    if (!Verify(*header))
+    {
+        tr_warn("Stored model failed verification");
+        return nullptr;
+    }
+    model_size_ = header->size;
+    tr_info("Stored model verified, %d bytes", model_size_);
+    return reinterpret_cast<const unsigned char*>(address_ + HEADER_SIZE);
+}
+
+/*  @brief  Get the size of the model returned by the last successful Load(), or 0.
+    */
+size_t ModelStore::GetModelSize(void) const
+{
+    return model_size_;
+}
+
+/*  @brief  Check that a header fits in the region and that the SHA-256 of the model matches it.
+    */
+bool ModelStore::Verify(const header_t& header) const
+{
+    if (header.size == 0 || header.size > size_ - HEADER_SIZE)
+    {
+        return false;
+    }
+    uint8_t digest[DIGEST_SIZE];
+    mbedtls_sha256(reinterpret_cast<const unsigned char*>(address_ + HEADER_SIZE), header.size, digest, 0);
+    return memcmp(digest, header.digest, DIGEST_SIZE) == 0;
+}
+
+/*  @brief  Parse a 64-character hexadecimal SHA-256 digest.
+    @return False if hex is not 64 hexadecimal characters.
+    */
+bool ModelStore::ParseDigest(const std::string& hex, uint8_t* digest)
+{
+    if (hex.size() != 2 * DIGEST_SIZE)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < 2 * DIGEST_SIZE; i++)
+    {
+        char c = hex[i];
+        uint8_t v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else return false;
+        digest[i / 2] = (i % 2 == 0) ? (v << 4) : (digest[i / 2] | v);
+    }
+    return true;
+}
+
+/*  @brief  Start receiving a model: erase the sectors it needs, including the header.
+            Any stored model is invalidated, so it must not be in use.
+    @param  size:       Size of the .tflite file in bytes.
+            sha256_hex: SHA-256 digest of the file as 64 hexadecimal characters.
+    @return False if the model does not fit in the region, the digest is malformed, 
+            the region overlaps the application, or erasing failed.
+    */
+bool ModelStore::Begin(size_t size, const std::string& sha256_hex)
+{
+    Abort();
+    if (size == 0 || size > size_ - HEADER_SIZE || !ParseDigest(sha256_hex, expected_digest_))
+    {
+        return false;
+    }
+#ifdef FLASHIAP_APP_ROM_END_ADDR
+    // The region is reserved in mbed_app.json only, so an application that has grown into it 
+    // must not be erased
+    if (address_ < FLASHIAP_APP_ROM_END_ADDR)
+    {
+        tr_err("Model store at 0x%08lx overlaps the application, which ends at 0x%08lx", 
+            (unsigned long)address_, (unsigned long)FLASHIAP_APP_ROM_END_ADDR);
+        return false;
+    }
+#endif
+    if (flash_.init() != 0)
+    {
+        tr_err("Flash init failed");
+        return false;
+    }
+    if (flash_.get_page_size() > PAGE_BUFFER_SIZE || PAGE_BUFFER_SIZE % flash_.get_page_size() != 0)
+    {
+        tr_err("Flash page size %d is not supported", flash_.get_page_size());
+        flash_.deinit();
+        return false;
+    }
+    // Erase whole sectors until the header and the model are covered
+    uint32_t end = address_ + HEADER_SIZE + size;
+    uint32_t erase_size = 0;
+    while (address_ + erase_size < end)
+    {
+        erase_size += flash_.get_sector_size(address_ + erase_size);
+    }
+    tr_info("Erasing %d bytes of model store", erase_size);
+    if (flash_.erase(address_, erase_size) != 0)
+    {
+        tr_err("Flash erase failed");
+        flash_.deinit();
+        return false;
+    }
+    updating_ = true;
+    model_size_ = 0;
+    expected_size_ = size;
+    received_ = 0;
+    programmed_ = 0;
+    page_fill_ = 0;
+    return true;
+}
+
+/*  @brief  Program the page buffer, padded with the erase value, after the bytes already programmed.
+    */
+bool ModelStore::FlushPage(void)
+{
+    if (page_fill_ == 0)
+    {
+        return true;
+    }
+    size_t page_size = flash_.get_page_size();
+    size_t len = ((page_fill_ + page_size - 1) / page_size) * page_size;
+    memset(page_buf_ + page_fill_, flash_.get_erase_value(), len - page_fill_);
+    if (flash_.program(page_buf_, address_ + HEADER_SIZE + programmed_, len) != 0)
+    {
+        tr_err("Flash program failed at offset %d", programmed_);
+        return false;
+    }
+    programmed_ += page_fill_;
+    page_fill_ = 0;
+    return true;
+}
+
+/*  @brief  Append a chunk of the model. Chunks must arrive in order; 
+            a repeated chunk that was already received is ignored, so a resent message is harmless.
+    @param  offset: Position of the chunk in the .tflite file.
+            data:   Chunk bytes.
+            len:    Chunk length in bytes.
+    @return False if no update is in progress, the chunk is out of order or too long, 
+            or programming failed. A programming failure aborts the update.
+    */
+bool ModelStore::Write(size_t offset, const uint8_t* data, size_t len)
+{
+    if (!updating_)
+    {
+        return false;
+    }
+    if (offset + len <= received_)
+    {
+        return true;
+    }
+    if (offset != received_ || received_ + len > expected_size_)
+    {
+        tr_warn("Unexpected model chunk at offset %d, expected %d", offset, received_);
+        return false;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        page_buf_[page_fill_++] = data[i];
+        if (page_fill_ == PAGE_BUFFER_SIZE && !FlushPage())
+        {
+            Abort();
+            return false;
+        }
+    }
+    received_ += len;
+    return true;
+}
+
+/*  @brief  Finish an update: program the remaining bytes, verify the SHA-256 digest 
+            of the model in flash, and write the header that makes it valid.
+    @return False if bytes are missing, verification failed or programming failed.
+            The update is over either way.
+    */
+bool ModelStore::Commit(void)
+{
+    if (!updating_)
+    {
+        return false;
+    }
+    if (received_ != expected_size_ || !FlushPage())
+    {
+        tr_warn("Model update incomplete, %d of %d bytes", received_, expected_size_);
+        Abort();
+        return false;
+    }
+
+    // The header is padded to a whole number of pages with the erase value
+    uint8_t header_buf[HEADER_SIZE];
+    memset(header_buf, flash_.get_erase_value(), sizeof(header_buf));
+    header_t* header = reinterpret_cast<header_t*>(header_buf);
+    header->magic = MAGIC;
+    header->size = expected_size_;
+    memcpy(header->digest, expected_digest_, DIGEST_SIZE);
+    if (!Verify(*header))
+    {
+        tr_warn("Model update failed SHA-256 verification");
+        Abort();
+        return false;
+    }
+    size_t page_size = flash_.get_page_size();
+    size_t header_len = ((sizeof(header_t) + page_size - 1) / page_size) * page_size;
+    bool ok = flash_.program(header_buf, address_, header_len) == 0;
+    if (!ok)
+    {
+        tr_err("Flash program failed for the model header");
+    }
+    updating_ = false;
+    flash_.deinit();
+    return ok;
+}
+
+/*  @brief  Stop an update. The region is left without a valid model.
+    */
+void ModelStore::Abort(void)
+{
+    if (updating_)
+    {
+        updating_ = false;
+        flash_.deinit();
+    }
+}
+
+/*  @brief  Check whether an update is in progress.
+    */
+bool ModelStore::IsUpdating(void) const
+{
+    return updating_;
+}
+
+/*  @brief  Get the number of model bytes received by the update in progress.
+    */
+size_t ModelStore::GetReceivedBytes(void) const
+{
+    return received_;
+}
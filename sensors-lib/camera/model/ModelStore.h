@@ -0,0 +1,89 @@
+# ifndef MODEL_STORE_H
+# define MODEL_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "mbed.h"
+
+/** ModelStore class.
+ *  @brief  Over-the-air model storage in a reserved region of internal flash.
+            A .tflite file is received in sequential chunks and programmed straight into flash
+            through a small page buffer, so the model never has to fit in RAM.
+            Commit() checks the SHA-256 of the written bytes against the digest given to Begin(),
+            and only then writes the header that marks the model as valid.
+            Internal flash is memory-mapped, so Load() returns a pointer that tflite::GetModel()
+            can use in place, without copying the model into RAM.
+
+            Region layout:
+            - [0, HEADER_SIZE): header with magic, model size and SHA-256 digest;
+            - [HEADER_SIZE, HEADER_SIZE + size): the .tflite flatbuffer, 16-byte aligned.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "ModelStore.h"
+ *
+ *  int main()
+ *  {
+        ModelStore store(MBED_CONF_APP_MODEL_STORE_ADDRESS, MBED_CONF_APP_MODEL_STORE_SIZE);
+        store.Begin(model_size, model_sha256_hex);
+        for (each chunk) {
+            store.Write(chunk_offset, chunk_data, chunk_len);
+        }
+        store.Commit();
+        // At the next boot
+        const unsigned char* model_data = store.Load();
+        if (model_data == nullptr) {
+            model_data = g_person_detect_model_data;
+        }
+ *  }
+ *  @endcode
+ */
+class ModelStore {
+
+    public:
+        static constexpr uint32_t MAGIC = 0x4C444F4D; // "MODL"
+        static constexpr size_t HEADER_SIZE = 256;
+        static constexpr size_t DIGEST_SIZE = 32;
+        // Bytes buffered before each program operation; a multiple of the flash page size
+        static constexpr size_t PAGE_BUFFER_SIZE = 256;
+
+        ModelStore(uint32_t address, uint32_t size);
+
+        const unsigned char* Load(void);
+        size_t GetModelSize(void) const;
+
+        bool Begin(size_t size, const std::string& sha256_hex);
+        bool Write(size_t offset, const uint8_t* data, size_t len);
+        bool Commit(void);
+        void Abort(void);
+        bool IsUpdating(void) const;
+        size_t GetReceivedBytes(void) const;
+
+    private:
+        typedef struct {
+            uint32_t magic;
+            uint32_t size;
+            uint8_t digest[DIGEST_SIZE];
+        } header_t;
+
+        FlashIAP flash_;
+        const uint32_t address_;
+        const uint32_t size_;
+        size_t model_size_;
+
+        // Update in progress
+        bool updating_;
+        size_t expected_size_;
+        size_t received_;
+        size_t programmed_;
+        uint8_t expected_digest_[DIGEST_SIZE];
+        uint8_t page_buf_[PAGE_BUFFER_SIZE];
+        size_t page_fill_;
+
+        bool FlushPage(void);
+        bool Verify(const header_t& header) const;
+        static bool ParseDigest(const std::string& hex, uint8_t* digest);
+};
+
+# endif // MODEL_STORE_H
@@ -0,0 +1,201 @@
+#include "mbed.h"
+#include "model/OpProfiler.h"
+#include "mbed_trace.h"
+#include <cstring>
+#if !defined(DWT_CTRL_CYCCNTENA_Msk)
+#include <chrono>
+#endif
+
+# define TRACE_GROUP "OpProfiler.cpp"
+
+/*  @brief  Create an empty profiler and start the cycle counter if the target has one.
+    */
+OpProfiler::OpProfiler():
+    open_tag_(nullptr),
+    open_node_(0),
+    open_start_(0)
+{
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#if defined(__CORE_CM7_H_GENERIC)
+    // The Cortex-M7 DWT ignores writes until unlocked
+    DWT->LAR = 0xC5ACCE55;
+#endif
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    Reset();
+}
+
+/*  @brief  Read the free-running tick counter. Differences are valid across a wrap.
+    */
+uint32_t OpProfiler::ReadTicks(void)
+{
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+    return DWT->CYCCNT;
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*  @brief  Get the tick rate: the core clock on Cortex-M targets, 1 GHz elsewhere.
+    */
+uint32_t OpProfiler::GetTicksPerSecond(void)
+{
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+    return SystemCoreClock;
+#else
+    return 1000000000;
+#endif
+}
+
+/*  @brief  Convert ticks to microseconds.
+    */
+uint32_t OpProfiler::TicksToUs(uint64_t ticks)
+{
+    return (uint32_t)((ticks * 1000000) / GetTicksPerSecond());
+}
+
+/*  @brief  Start an event. Called by the interpreter before each node invoke.
+    @param  tag:             Op name, valid for the lifetime of the interpreter.
+            event_metadata1: Node index for operator events.
+    @return Handle for EndEvent().
+    */
+uint32_t OpProfiler::BeginEvent(const char* tag, EventType event_type,
+    int64_t event_metadata1, int64_t event_metadata2)
+{
+    open_tag_ = tag;
+    open_node_ = (event_type == EventType::OPERATOR_INVOKE_EVENT) ? (uint16_t)event_metadata1 : 0;
+    open_start_ = ReadTicks();
+    return next_event_;
+}
+
+/*  @brief  Finish the event in progress and record it, overwriting the oldest event when full.
+    */
+void OpProfiler::EndEvent(uint32_t event_handle)
+{
+    uint32_t ticks = ReadTicks() - open_start_;
+    if (open_tag_ == nullptr)
+    {
+        return;
+    }
+    op_event_t& event = events_[next_event_];
+    event.tag = open_tag_;
+    event.node = open_node_;
+    event.ticks = ticks;
+    next_event_ = (next_event_ + 1) % MAX_EVENTS;
+    num_events_ = (num_events_ < MAX_EVENTS) ? num_events_ + 1 : MAX_EVENTS;
+    AddToTotal(open_tag_, ticks);
+    open_tag_ = nullptr;
+}
+
+/*  @brief  Add an event to the total of its op type. 
+            Types beyond MAX_OP_TYPES are only kept in the ring buffer.
+    */
+void OpProfiler::AddToTotal(const char* tag, uint32_t ticks)
+{
+    size_t i = 0;
+    while (i < num_op_types_ && totals_[i].tag != tag && strcmp(totals_[i].tag, tag) != 0)
+    {
+        i++;
+    }
+    if (i == num_op_types_)
+    {
+        if (num_op_types_ == MAX_OP_TYPES)
+        {
+            return;
+        }
+        totals_[i].tag = tag;
+        totals_[i].count = 0;
+        totals_[i].ticks = 0;
+        num_op_types_++;
+    }
+    totals_[i].count++;
+    totals_[i].ticks += ticks;
+}
+
+/*  @brief  Forget every event and total.
+    */
+void OpProfiler::Reset(void)
+{
+    next_event_ = 0;
+    num_events_ = 0;
+    num_op_types_ = 0;
+}
+
+/*  @brief  Get the number of events in the ring buffer, at most MAX_EVENTS.
+    */
+size_t OpProfiler::GetNumEvents(void) const
+{
+    return num_events_;
+}
+
+/*  @brief  Get an event from the ring buffer.
+    @param  index: 0 for the oldest event kept, GetNumEvents() - 1 for the latest.
+    @return False if index is out of range.
+    */
+bool OpProfiler::GetEvent(size_t index, op_event_t& event) const
+{
+    if (index >= num_events_)
+    {
+        return false;
+    }
+    size_t oldest = (next_event_ + MAX_EVENTS - num_events_) % MAX_EVENTS;
+    event = events_[(oldest + index) % MAX_EVENTS];
+    return true;
+}
+
+/*  @brief  Get the number of op types with a total, in order of first invoke.
+    */
+size_t OpProfiler::GetNumOpTypes(void) const
+{
+    return num_op_types_;
+}
+
+/*  @brief  Get the total of one op type. index must be below GetNumOpTypes().
+    */
+const OpProfiler::op_total_t& OpProfiler::GetOpTotal(size_t index) const
+{
+    return totals_[index];
+}
+
+/*  @brief  Get the ticks spent in every op since the last Reset().
+    */
+uint64_t OpProfiler::GetTotalTicks(void) const
+{
+    uint64_t ticks = 0;
+    for (size_t i = 0; i < num_op_types_; i++)
+    {
+        ticks += totals_[i].ticks;
+    }
+    return ticks;
+}
+
+/*  @brief  Log the total of each op type, with its share of the time spent in ops.
+    */
+void OpProfiler::Dump(void) const
+{
+    uint64_t total = GetTotalTicks();
+    tr_info("Op profile: %d us in %d op types, %d ticks per second", 
+        TicksToUs(total), num_op_types_, GetTicksPerSecond());
+    for (size_t i = 0; i < num_op_types_; i++)
+    {
+        tr_info("  %s: %d invokes, %d us, %d%%", totals_[i].tag, totals_[i].count, 
+            TicksToUs(totals_[i].ticks), total ? (int)((100 * totals_[i].ticks) / total) : 0);
+    }
+}
+
+/*  @brief  Format the totals for publishing as "<op>:<invokes>:<us>" entries separated by ';'.
+    */
+std::string OpProfiler::Summary(void) const
+{
+    std::string summary;
+    char entry[64];
+    for (size_t i = 0; i < num_op_types_; i++)
+    {
+        snprintf(entry, sizeof(entry), "%s%s:%lu:%lu", i ? ";" : "", totals_[i].tag, 
+            (unsigned long)totals_[i].count, (unsigned long)TicksToUs(totals_[i].ticks));
+        summary += entry;
+    }
+    return summary;
+}
@@ -0,0 +1,89 @@
+# ifndef OP_PROFILER_H
+# define OP_PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "tensorflow/lite/core/api/profiler.h"
+
+/** OpProfiler class.
+ *  @brief  Per-operator profiler for the TFLM interpreter.
+            MicroInterpreter::Invoke() wraps every node in a ScopedOperatorProfile; with an OpProfiler
+            passed to TFLM_Model::SetProfiler(), each node invoke is recorded as an event with its
+            op name, node index and elapsed ticks in a ring buffer of the last MAX_EVENTS events,
+            and added to running totals per op type.
+            Ticks are DWT CYCCNT core cycles on Cortex-M targets and steady_clock nanoseconds 
+            elsewhere, see GetTicksPerSecond().
+            The interpreter only profiles when NDEBUG is not defined or the 
+            "model-profiler" option is set in mbed_app.json.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "OpProfiler.h"
+ *
+ *  int main()
+ *  {
+        static OpProfiler profiler;
+        model.SetProfiler(&profiler);
+        model.Initialize();
+        model.Invoke<int8_t>();
+        profiler.Dump();                        // one trace line per op type
+        std::string summary = profiler.Summary();  // e.g. "CONV_2D:14:9120;DEPTHWISE_CONV_2D:13:4310;..."
+ *  }
+ *  @endcode
+ */
+class OpProfiler : public tflite::Profiler {
+
+    public:
+        static constexpr size_t MAX_EVENTS = 64;
+        static constexpr size_t MAX_OP_TYPES = 16;
+
+        // One node invoke
+        typedef struct {
+            const char* tag;
+            uint16_t node;
+            uint32_t ticks;
+        } op_event_t;
+
+        // Every invoke of one op type since the last Reset()
+        typedef struct {
+            const char* tag;
+            uint32_t count;
+            uint64_t ticks;
+        } op_total_t;
+
+        OpProfiler();
+
+        uint32_t BeginEvent(const char* tag, EventType event_type,
+            int64_t event_metadata1, int64_t event_metadata2) override;
+        void EndEvent(uint32_t event_handle) override;
+
+        void Reset(void);
+        size_t GetNumEvents(void) const;
+        bool GetEvent(size_t index, op_event_t& event) const;
+        size_t GetNumOpTypes(void) const;
+        const op_total_t& GetOpTotal(size_t index) const;
+        uint64_t GetTotalTicks(void) const;
+        static uint32_t GetTicksPerSecond(void);
+        static uint32_t TicksToUs(uint64_t ticks);
+
+        void Dump(void) const;
+        std::string Summary(void) const;
+
+    private:
+        op_event_t events_[MAX_EVENTS];
+        size_t next_event_;
+        size_t num_events_;
+        op_total_t totals_[MAX_OP_TYPES];
+        size_t num_op_types_;
+
+        // Event in progress; nested events are not supported, as in tflite::MicroProfiler
+        const char* open_tag_;
+        uint16_t open_node_;
+        uint32_t open_start_;
+
+        static uint32_t ReadTicks(void);
+        void AddToTotal(const char* tag, uint32_t ticks);
+};
+
+# endif // OP_PROFILER_H
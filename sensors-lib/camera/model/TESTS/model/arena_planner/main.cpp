@@ -0,0 +1,279 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include <vector>
+#include "flatbuffers/flatbuffers.h"
+#include "model/ArenaPlanner.h"
+#include "model/ArenaSizer.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+/*  Tests of ArenaPlanner (model/ArenaPlanner.h) and of the use of its offline plans by the TFLM
+    MicroAllocator, on a small int8 model of ADD and PAD operators built here, for which the
+    greedy memory planner of TFLM needs 1824 bytes but 1536 bytes are enough, and on residual
+    blocks that the interpreter fuses.
+ */
+
+using namespace utest::v1;
+
+static constexpr int height = 8;
+static constexpr int depth = 8;
+static constexpr size_t arena_size = 16 * 1024;
+alignas(16) static uint8_t arena[arena_size];
+static int8_t expected[(height + 2) * (height + 2) * depth];
+static int8_t actual[sizeof(expected)];
+
+static tflite::MicroErrorReporter error_reporter;
+static tflite::MicroMutableOpResolver<3> resolver;
+
+// a = ADD(x, x), b = ADD(x, a), c = ADD(x, x), d = ADD(c, b), y = PAD(d). At most three 512-byte
+// tensors are live together, but the greedy planner, which places the padded output first,
+// cannot fit them in 1536 bytes.
+static const tflite::Model* build_model(flatbuffers::FlatBufferBuilder& fbb)
+{
+    std::vector<flatbuffers::Offset<tflite::Buffer>> buffers = {tflite::CreateBuffer(fbb)};
+    const int32_t paddings[] = {0, 0, 1, 1, 1, 1, 0, 0};
+    buffers.push_back(tflite::CreateBuffer(fbb,
+        fbb.CreateVector(reinterpret_cast<const uint8_t*>(paddings), sizeof(paddings))));
+    std::vector<flatbuffers::Offset<tflite::OperatorCode>> opcodes = {
+        tflite::CreateOperatorCode(fbb, tflite::BuiltinOperator_ADD),
+        tflite::CreateOperatorCode(fbb, tflite::BuiltinOperator_PAD)
+    };
+
+    std::vector<flatbuffers::Offset<tflite::Tensor>> tensors;
+    auto add_tensor = [&](std::vector<int> shape, tflite::TensorType type, int buffer) {
+        std::vector<float> scales = {0.1f};
+        std::vector<int64_t> zero_points = {0};
+        tensors.push_back(tflite::CreateTensor(fbb, fbb.CreateVector(shape), type, buffer, 0,
+            tflite::CreateQuantizationParameters(fbb, 0, 0, fbb.CreateVector(scales),
+                fbb.CreateVector(zero_points))));
+        return (int)tensors.size() - 1;
+    };
+    const int paddings_tensor = add_tensor({4, 2}, tflite::TensorType_INT32, 1);
+    const int x = add_tensor({1, height, height, depth}, tflite::TensorType_INT8, 0);
+    const int a = add_tensor({1, height, height, depth}, tflite::TensorType_INT8, 0);
+    const int b = add_tensor({1, height, height, depth}, tflite::TensorType_INT8, 0);
+    const int c = add_tensor({1, height, height, depth}, tflite::TensorType_INT8, 0);
+    const int d = add_tensor({1, height, height, depth}, tflite::TensorType_INT8, 0);
+    const int y = add_tensor({1, height + 2, height + 2, depth}, tflite::TensorType_INT8, 0);
+
+    std::vector<flatbuffers::Offset<tflite::Operator>> operators;
+    auto add_operator = [&](int opcode, std::vector<int> inputs, int output) {
+        std::vector<int> outputs = {output};
+        if (opcode == 0) {
+            operators.push_back(tflite::CreateOperator(fbb, opcode, fbb.CreateVector(inputs),
+                fbb.CreateVector(outputs), tflite::BuiltinOptions_AddOptions,
+                tflite::CreateAddOptions(fbb).Union()));
+        } else {
+            operators.push_back(tflite::CreateOperator(fbb, opcode, fbb.CreateVector(inputs),
+                fbb.CreateVector(outputs), tflite::BuiltinOptions_PadOptions,
+                tflite::CreatePadOptions(fbb).Union()));
+        }
+    };
+    add_operator(0, {x, x}, a);
+    add_operator(0, {x, a}, b);
+    add_operator(0, {x, x}, c);
+    add_operator(0, {c, b}, d);
+    add_operator(1, {d, paddings_tensor}, y);
+
+    std::vector<int> inputs = {x};
+    std::vector<int> outputs = {y};
+    auto subgraph = tflite::CreateSubGraph(fbb, fbb.CreateVector(tensors), fbb.CreateVector(inputs),
+        fbb.CreateVector(outputs), fbb.CreateVector(operators));
+    std::vector<flatbuffers::Offset<tflite::SubGraph>> subgraphs = {subgraph};
+    tflite::FinishModelBuffer(fbb, tflite::CreateModel(fbb, TFLITE_SCHEMA_VERSION,
+        fbb.CreateVector(opcodes), fbb.CreateVector(subgraphs), 0, fbb.CreateVector(buffers)));
+    return tflite::GetModel(fbb.GetBufferPointer());
+}
+
+// x1 = ADD(CONV_2D(x0), x0), x2 = ADD(CONV_2D(x1), x1): two residual blocks, each of which the
+// interpreter runs as one fused node. Only two 512-byte tensors are then live together, against
+// three in the operators of the flatbuffer.
+static const tflite::Model* build_residual_model(flatbuffers::FlatBufferBuilder& fbb)
+{
+    std::vector<flatbuffers::Offset<tflite::Buffer>> buffers = {tflite::CreateBuffer(fbb)};
+    std::vector<flatbuffers::Offset<tflite::OperatorCode>> opcodes = {
+        tflite::CreateOperatorCode(fbb, tflite::BuiltinOperator_ADD),
+        tflite::CreateOperatorCode(fbb, tflite::BuiltinOperator_CONV_2D)
+    };
+
+    std::vector<flatbuffers::Offset<tflite::Tensor>> tensors;
+    auto add_tensor = [&](std::vector<int> shape, tflite::TensorType type, int buffer, float scale) {
+        std::vector<float> scales(shape[0] == depth ? depth : 1, scale);
+        std::vector<int64_t> zero_points(scales.size(), 0);
+        tensors.push_back(tflite::CreateTensor(fbb, fbb.CreateVector(shape), type, buffer, 0,
+            tflite::CreateQuantizationParameters(fbb, 0, 0, fbb.CreateVector(scales),
+                fbb.CreateVector(zero_points))));
+        return (int)tensors.size() - 1;
+    };
+    std::vector<flatbuffers::Offset<tflite::Operator>> operators;
+    auto add_block = [&](int input) {
+        std::vector<int8_t> filter(depth * 3 * 3 * depth);
+        for (size_t i = 0; i < filter.size(); i++) {
+            filter[i] = (int8_t)((i * 53) % 255 - 127);
+        }
+        const std::vector<int32_t> bias(depth, 100);
+        buffers.push_back(tflite::CreateBuffer(fbb,
+            fbb.CreateVector(reinterpret_cast<const uint8_t*>(filter.data()), filter.size())));
+        const int filter_tensor = add_tensor({depth, 3, 3, depth}, tflite::TensorType_INT8,
+            buffers.size() - 1, 0.01f);
+        buffers.push_back(tflite::CreateBuffer(fbb,
+            fbb.CreateVector(reinterpret_cast<const uint8_t*>(bias.data()), bias.size() * sizeof(int32_t))));
+        const int bias_tensor = add_tensor({depth}, tflite::TensorType_INT32, buffers.size() - 1, 0.001f);
+        const int conv = add_tensor({1, height, height, depth}, tflite::TensorType_INT8, 0, 0.1f);
+        const int output = add_tensor({1, height, height, depth}, tflite::TensorType_INT8, 0, 0.1f);
+        std::vector<int> conv_inputs = {input, filter_tensor, bias_tensor};
+        std::vector<int> conv_outputs = {conv};
+        operators.push_back(tflite::CreateOperator(fbb, 1, fbb.CreateVector(conv_inputs),
+            fbb.CreateVector(conv_outputs), tflite::BuiltinOptions_Conv2DOptions,
+            tflite::CreateConv2DOptions(fbb, tflite::Padding_SAME, 1, 1).Union()));
+        std::vector<int> add_inputs = {conv, input};
+        std::vector<int> add_outputs = {output};
+        operators.push_back(tflite::CreateOperator(fbb, 0, fbb.CreateVector(add_inputs),
+            fbb.CreateVector(add_outputs), tflite::BuiltinOptions_AddOptions,
+            tflite::CreateAddOptions(fbb).Union()));
+        return output;
+    };
+    const int x = add_tensor({1, height, height, depth}, tflite::TensorType_INT8, 0, 0.1f);
+    const int y = add_block(add_block(x));
+
+    std::vector<int> inputs = {x};
+    std::vector<int> outputs = {y};
+    auto subgraph = tflite::CreateSubGraph(fbb, fbb.CreateVector(tensors), fbb.CreateVector(inputs),
+        fbb.CreateVector(outputs), fbb.CreateVector(operators));
+    std::vector<flatbuffers::Offset<tflite::SubGraph>> subgraphs = {subgraph};
+    tflite::FinishModelBuffer(fbb, tflite::CreateModel(fbb, TFLITE_SCHEMA_VERSION,
+        fbb.CreateVector(opcodes), fbb.CreateVector(subgraphs), 0, fbb.CreateVector(buffers)));
+    return tflite::GetModel(fbb.GetBufferPointer());
+}
+
+// Run the model on a fixed input into output, and return the head of the arena that the
+// memory plan used
+static size_t run_model(const tflite::Model* model, int8_t* output)
+{
+    arena_usage_t usage;
+    TEST_ASSERT_TRUE(ArenaSizer::Measure(model, resolver, arena, arena_size, &error_reporter, usage));
+
+    tflite::MicroInterpreter interpreter(model, resolver, arena, arena_size, &error_reporter);
+    TEST_ASSERT_EQUAL(kTfLiteOk, interpreter.AllocateTensors());
+    TfLiteTensor* input = interpreter.input(0);
+    for (size_t i = 0; i < input->bytes; i++) {
+        input->data.int8[i] = (int8_t)((i * 37) % 200 - 100);
+    }
+    TEST_ASSERT_EQUAL(kTfLiteOk, interpreter.Invoke());
+    memcpy(output, interpreter.output(0)->data.int8, interpreter.output(0)->bytes);
+    return usage.head_bytes;
+}
+
+// Test that the offline plan beats the greedy plan, that the interpreter uses it as is, and
+// that the outputs match those of the greedy plan
+static control_t arena_planner_test_1(const size_t call_count)
+{
+    flatbuffers::FlatBufferBuilder fbb;
+    const tflite::Model* model = build_model(fbb);
+    std::vector<int32_t> offsets;
+    arena_plan_t plan;
+    TEST_ASSERT_TRUE(ArenaPlanner::Plan(model, resolver, arena, arena_size, 1000, &error_reporter,
+        offsets, plan));
+    printf("%d tensors: lower bound %d bytes, greedy %d bytes, planned %d bytes\r\n", plan.tensor_count,
+        (int)plan.lower_bound_bytes, (int)plan.greedy_bytes, (int)plan.planned_bytes);
+    TEST_ASSERT_EQUAL(6, plan.tensor_count);
+    TEST_ASSERT_EQUAL(1824, plan.greedy_bytes);
+    TEST_ASSERT_EQUAL(1536, plan.lower_bound_bytes);
+    TEST_ASSERT_EQUAL(plan.lower_bound_bytes, plan.planned_bytes);
+    TEST_ASSERT_EQUAL(-1, offsets[0]);
+
+    std::vector<uint8_t> planned_data;
+    TEST_ASSERT_TRUE(ArenaPlanner::Embed(model, offsets, planned_data));
+    const tflite::Model* planned_model = tflite::GetModel(planned_data.data());
+    TEST_ASSERT_EQUAL(plan.greedy_bytes, run_model(model, expected));
+    TEST_ASSERT_EQUAL(plan.planned_bytes, run_model(planned_model, actual));
+    TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, sizeof(expected));
+
+    // Planning a planned model replaces its plan instead of adding another one
+    std::vector<uint8_t> replanned_data;
+    TEST_ASSERT_TRUE(ArenaPlanner::Embed(planned_model, offsets, replanned_data));
+    TEST_ASSERT_EQUAL(1, tflite::GetModel(replanned_data.data())->metadata()->size());
+    return CaseNext;
+}
+
+// Test that tensors whose offline offsets overlap while both are live are planned online
+static control_t arena_planner_test_2(const size_t call_count)
+{
+    flatbuffers::FlatBufferBuilder fbb;
+    const tflite::Model* model = build_model(fbb);
+    std::vector<int32_t> offsets;
+    arena_plan_t plan;
+    TEST_ASSERT_TRUE(ArenaPlanner::Plan(model, resolver, arena, arena_size, 1000, &error_reporter,
+        offsets, plan));
+    for (int32_t& offset : offsets) {
+        offset = (offset < 0) ? offset : 0;
+    }
+
+    std::vector<uint8_t> planned_data;
+    TEST_ASSERT_TRUE(ArenaPlanner::Embed(model, offsets, planned_data));
+    run_model(model, expected);
+    run_model(tflite::GetModel(planned_data.data()), actual);
+    TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, sizeof(expected));
+    return CaseNext;
+}
+
+// Test that the plan of a model with fused operators is made for the fused nodes, so that the
+// interpreter takes it as is
+static control_t arena_planner_test_3(const size_t call_count)
+{
+    flatbuffers::FlatBufferBuilder fbb;
+    const tflite::Model* model = build_residual_model(fbb);
+    std::vector<int32_t> offsets;
+    arena_plan_t plan;
+    TEST_ASSERT_TRUE(ArenaPlanner::Plan(model, resolver, arena, arena_size, 1000, &error_reporter,
+        offsets, plan));
+    printf("%d tensors: lower bound %d bytes, greedy %d bytes, planned %d bytes\r\n", plan.tensor_count,
+        (int)plan.lower_bound_bytes, (int)plan.greedy_bytes, (int)plan.planned_bytes);
+#if defined(TF_LITE_MICRO_FUSE_OPERATORS) && TF_LITE_MICRO_FUSE_OPERATORS
+    TEST_ASSERT_EQUAL(3, plan.tensor_count);
+    TEST_ASSERT_EQUAL(1024, plan.planned_bytes);
+#else
+    TEST_ASSERT_EQUAL(5, plan.tensor_count);
+    TEST_ASSERT_EQUAL(1536, plan.planned_bytes);
+#endif
+    TEST_ASSERT_TRUE(plan.planned_bytes <= plan.greedy_bytes);
+
+    std::vector<uint8_t> planned_data;
+    TEST_ASSERT_TRUE(ArenaPlanner::Embed(model, offsets, planned_data));
+    TEST_ASSERT_EQUAL(plan.greedy_bytes, run_model(model, expected));
+    TEST_ASSERT_EQUAL(plan.planned_bytes, run_model(tflite::GetModel(planned_data.data()), actual));
+    TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, height * height * depth);
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    resolver.AddAdd();
+    resolver.AddPad();
+    resolver.AddConv2D();
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Test the interpreter uses the offline plan embedded in a model", arena_planner_test_1),
+    Case("Test conflicting offline offsets are planned online", arena_planner_test_2),
+    Case("Test the offline plan of fused operators is taken as is", arena_planner_test_3)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
@@ -0,0 +1,128 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/model/TFLM_Model.h"
+#include "camera/model_data/person_detection_int8/model_data.h"
+
+/*  Inference benchmark for the compiled-in model.
+    Reports the average time per window for a frame of num_windows windows, 
+    together with the tensor arena usage. To pick a batch size, generate batched 
+    variants of the model with tools/rebatch_model.py, swap each in for model_data.cc 
+    and compare the reported figures against the batch-1 model.
+ */
+
+using namespace utest::v1;
+
+static constexpr size_t num_windows = 12;
+static constexpr size_t window_bytes = 96 * 96;
+static constexpr size_t arena_size = 300 * 1024;
+alignas(16) static uint8_t tensor_arena[arena_size];
+static uint8_t windows[num_windows][window_bytes];
+static uint8_t reference_output[num_windows][4];
+
+static TFLM_Model model(g_person_detect_model_data, arena_size, tensor_arena, false);
+
+// Fill each window with a different deterministic pattern
+static void fill_windows(void)
+{
+    uint32_t seed = 1;
+    for (size_t w = 0; w < num_windows; w++) {
+        for (size_t i = 0; i < window_bytes; i++) {
+            seed = seed * 1103515245 + 12345;
+            windows[w][i] = seed >> 16;
+        }
+    }
+}
+
+// Benchmark one invoke per window, filling only the first slot
+static control_t model_benchmark_test_1(const size_t call_count) 
+{
+    model.Initialize();
+    fill_windows();
+    TEST_ASSERT_TRUE(model.GetOutputItemBytes() <= sizeof(reference_output[0]));
+
+    Timer timer;
+    timer.start();
+    for (size_t w = 0; w < num_windows; w++) {
+        uint8_t* output = model.RunInference(windows[w]);
+        TEST_ASSERT_NOT_NULL(output);
+        memcpy(reference_output[w], output, model.GetOutputItemBytes());
+    }
+    timer.stop();
+
+    int us_per_window = timer.read_us() / num_windows;
+    printf("Per-window invoke: batch %d, %d us/window, %d arena bytes\r\n", 
+        model.GetBatchSize(), us_per_window, model.GetArenaUsedBytes());
+    greentea_send_kv("per_window_us", us_per_window);
+    return CaseNext;
+}
+
+// Benchmark batched invokes filling the input in place, and check that each slot gives the same
+// result as its window run on its own through RunInference()
+static control_t model_benchmark_test_2(const size_t call_count) 
+{
+    size_t batch_size = model.GetBatchSize();
+    size_t item_bytes = model.GetOutputItemBytes();
+
+    Timer timer;
+    timer.start();
+    for (size_t start = 0; start < num_windows; start += batch_size) {
+        size_t count = std::min(batch_size, num_windows - start);
+        for (size_t slot = 0; slot < count; slot++) {
+            TensorSpan<int8_t> input = model.GetInput<int8_t>(slot);
+            TEST_ASSERT_EQUAL_UINT(window_bytes, input.size());
+            memcpy(input.data(), windows[start + slot], window_bytes);
+        }
+        TensorSpan<const int8_t> output = model.Invoke<int8_t>();
+        TEST_ASSERT_FALSE(output.empty());
+        for (size_t slot = 0; slot < count; slot++) {
+            TensorSpan<const int8_t> scores = output.Slice(slot * item_bytes, item_bytes);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(reference_output[start + slot], scores.data(), item_bytes);
+        }
+    }
+    timer.stop();
+
+    int us_per_window = timer.read_us() / num_windows;
+    printf("Batched invoke: batch %d, %d us/window, %d arena bytes\r\n", 
+        batch_size, us_per_window, model.GetArenaUsedBytes());
+    greentea_send_kv("batched_us", us_per_window);
+    return CaseNext;
+}
+
+// Check that typed tensor access rejects a wrong type, a missing slot and an out of range slice
+static control_t model_benchmark_test_3(const size_t call_count) 
+{
+    TEST_ASSERT_TRUE(model.GetInput<float>(0).empty());
+    TEST_ASSERT_TRUE(model.GetInput<int8_t>(model.GetBatchSize()).empty());
+    TEST_ASSERT_TRUE(model.GetOutput<uint8_t>().empty());
+
+    TensorSpan<const int8_t> output = model.GetOutput<int8_t>();
+    TEST_ASSERT_EQUAL_UINT(model.GetBatchSize() * model.GetOutputItemBytes(), output.size());
+    TEST_ASSERT_EQUAL_UINT(2, output.Slice(output.size() - 2, 2).size());
+    TEST_ASSERT_TRUE(output.Slice(output.size() - 1, 2).empty());
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases) 
+{
+    // Here, we specify the timeout (120s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(120, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] = 
+{
+    Case("Benchmark per-window invokes", model_benchmark_test_1),
+    Case("Benchmark batched invokes", model_benchmark_test_2),
+    Case("Check typed tensor access", model_benchmark_test_3)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main() 
+{
+    return !Harness::run(specification);
+}
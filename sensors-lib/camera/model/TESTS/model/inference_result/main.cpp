@@ -0,0 +1,124 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/model/TFLM_Model.h"
+#include "camera/model/InferenceResult.h"
+#include "camera/model_data/person_detection_int8/model_data.h"
+
+using namespace utest::v1;
+
+static constexpr size_t arena_size = 150 * 1024;
+alignas(16) static uint8_t arena[arena_size];
+
+// Softmax output quantisation of the default model
+static const output_quant_t softmax_quant = {kTfLiteInt8, 1.0f / 256, -128};
+
+// Test dequantisation, argmax and top-k on int8 scores, with ties going to the lower index
+static control_t inference_result_test_1(const size_t call_count)
+{
+    const int8_t scores[] = {-128, 64, -64, 64, 0};
+    InferenceResult result(softmax_quant, scores, 5);
+    TEST_ASSERT_FALSE(result.empty());
+    TEST_ASSERT_EQUAL_UINT(5, result.GetNumClasses());
+    TEST_ASSERT_EQUAL_INT32(64, result.GetQuantized(1));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.75f, result.GetScore(1));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, result.GetScore(0));
+    TEST_ASSERT_EQUAL_UINT(1, result.Argmax());
+
+    size_t top[5];
+    TEST_ASSERT_EQUAL_UINT(3, result.TopK(3, top));
+    TEST_ASSERT_EQUAL_UINT(1, top[0]);
+    TEST_ASSERT_EQUAL_UINT(3, top[1]);
+    TEST_ASSERT_EQUAL_UINT(4, top[2]);
+    TEST_ASSERT_EQUAL_UINT(5, result.TopK(8, top));
+    TEST_ASSERT_EQUAL_UINT(0, top[4]);
+
+    const uint8_t uscores[] = {10, 200};
+    const output_quant_t uquant = {kTfLiteUInt8, 1.0f / 255, 0};
+    InferenceResult uresult(uquant, uscores, 2);
+    TEST_ASSERT_EQUAL_INT32(200, uresult.GetQuantized(1));
+    TEST_ASSERT_EQUAL_UINT(1, uresult.Argmax());
+
+    const output_quant_t fquant = {kTfLiteFloat32, 1.0f, 0};
+    TEST_ASSERT_TRUE(InferenceResult(fquant, scores, 2).empty());
+    TEST_ASSERT_TRUE(InferenceResult().empty());
+    return CaseNext;
+}
+
+// Test that thresholds are quantised once and compared as integers
+static control_t inference_result_test_2(const size_t call_count)
+{
+    TEST_ASSERT_EQUAL_INT32(0, InferenceResult::Quantize(softmax_quant, 0.5f));
+    TEST_ASSERT_EQUAL_INT32(127, InferenceResult::Quantize(softmax_quant, 1.5f));
+    TEST_ASSERT_EQUAL_INT32(-128, InferenceResult::Quantize(softmax_quant, -1.0f));
+
+    ClassThresholds thresholds(0.5f);
+    thresholds.Quantize(softmax_quant);
+    TEST_ASSERT_TRUE(thresholds.Set(1, 0.75f));
+    TEST_ASSERT_FALSE(thresholds.Set(ClassThresholds::MAX_CLASSES, 0.5f));
+    TEST_ASSERT_EQUAL_INT32(0, thresholds.GetQuantized(0));
+    TEST_ASSERT_EQUAL_INT32(64, thresholds.GetQuantized(1));
+
+    const int8_t scores[] = {-60, 60};
+    InferenceResult result(softmax_quant, scores, 2);
+    TEST_ASSERT_FALSE(thresholds.IsDetected(result, 1));
+    TEST_ASSERT_EQUAL_INT32(-4, thresholds.Margin(result, 1));
+    thresholds.Set(1, 0.7f);
+    TEST_ASSERT_TRUE(thresholds.IsDetected(result, 1));
+    TEST_ASSERT_FALSE(thresholds.IsDetected(result, 2));
+
+    // The same probability threshold maps to another integer for another quantisation
+    const output_quant_t uquant = {kTfLiteUInt8, 1.0f / 256, 0};
+    thresholds.Quantize(uquant);
+    TEST_ASSERT_EQUAL_INT32(128, thresholds.GetQuantized(0));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.7f, thresholds.Get(1));
+    return CaseNext;
+}
+
+// Test the result of the default model: two int8 softmax scores summing to about 1
+static control_t inference_result_test_3(const size_t call_count)
+{
+    TFLM_Model model(g_person_detect_model_data, arena_size, arena);
+    model.Initialize();
+    TEST_ASSERT_TRUE(model.IsInitialized());
+    TensorSpan<int8_t> input = model.GetInput<int8_t>(0);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = (int8_t)((i * 7) % 256 - 128);
+    }
+    TEST_ASSERT_FALSE(model.Invoke<int8_t>().empty());
+
+    output_quant_t quant = model.GetOutputQuant();
+    TEST_ASSERT_EQUAL_INT(kTfLiteInt8, quant.type);
+    InferenceResult result = model.GetResult(0);
+    TEST_ASSERT_EQUAL_UINT(2, result.GetNumClasses());
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 1.0f, result.GetScore(0) + result.GetScore(1));
+    size_t top[2];
+    TEST_ASSERT_EQUAL_UINT(2, result.TopK(2, top));
+    TEST_ASSERT_EQUAL_UINT(result.Argmax(), top[0]);
+    TEST_ASSERT_TRUE(model.GetResult(1).empty());
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Test InferenceResult dequantisation, argmax and top-k", inference_result_test_1),
+    Case("Test ClassThresholds in integer space", inference_result_test_2),
+    Case("Test InferenceResult of the default model", inference_result_test_3)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
@@ -0,0 +1,106 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/model/TFLM_Model.h"
+#include "camera/model/InferenceWorker.h"
+#include "camera/model_data/person_detection_int8/model_data.h"
+
+using namespace utest::v1;
+
+static constexpr size_t arena_size = 150 * 1024;
+alignas(16) static uint8_t arena[arena_size];
+static TFLM_Model model(g_person_detect_model_data, arena_size, arena);
+static InferenceWorker worker(model);
+static constexpr size_t window_size = 96 * 96;
+
+static void fill_window(uint8_t* window, uint32_t seed)
+{
+    for (size_t i = 0; i < window_size; i++) {
+        window[i] = (i * seed + (i / 96) * 7) % 251;
+    }
+}
+
+// Run one window on the calling thread, for reference
+static void direct_scores(uint32_t seed, int8_t* scores)
+{
+    fill_window(reinterpret_cast<uint8_t*>(model.GetInput<int8_t>(0).data()), seed);
+    TensorSpan<const int8_t> output = model.Invoke<int8_t>();
+    TEST_ASSERT_EQUAL_UINT(2, output.size());
+    scores[0] = output[0];
+    scores[1] = output[1];
+}
+
+// Test that submitted windows give the same scores as direct inference, and that 
+// no batch is taken while the previous one is pending
+static control_t inference_worker_test_1(const size_t call_count)
+{
+    model.Initialize();
+    TEST_ASSERT_TRUE(model.IsInitialized());
+    const uint32_t seeds[] = {3, 11, 29};
+    int8_t expected[3][2];
+    for (size_t i = 0; i < 3; i++) {
+        direct_scores(seeds[i], expected[i]);
+    }
+    TEST_ASSERT_TRUE(worker.Start());
+
+    InferenceWorker::response_t response;
+    for (size_t i = 0; i < 3; i++) {
+        fill_window(reinterpret_cast<uint8_t*>(model.GetInput<int8_t>(0).data()), seeds[i]);
+        uint32_t tag = 100 + i;
+        TEST_ASSERT_TRUE(worker.Submit(&tag, 1));
+        TEST_ASSERT_EQUAL_UINT(1, worker.GetNumPending());
+        TEST_ASSERT_FALSE(worker.Submit(&tag, 1));
+        TEST_ASSERT_TRUE(worker.GetResponse(response, osWaitForever));
+        TEST_ASSERT_TRUE(response.ok);
+        TEST_ASSERT_EQUAL_UINT(100 + i, response.tag);
+        TEST_ASSERT_EQUAL_UINT(2, response.num_bytes);
+        TEST_ASSERT_EQUAL_INT8_ARRAY(expected[i], response.output, 2);
+    }
+    TEST_ASSERT_EQUAL_UINT(0, worker.GetNumPending());
+    TEST_ASSERT_FALSE(worker.GetResponse(response, 0));
+    return CaseNext;
+}
+
+// Test that batches that do not fit the model are rejected, and that the output 
+// can be read in place once the responses are collected
+static control_t inference_worker_test_2(const size_t call_count)
+{
+    int8_t expected[2];
+    direct_scores(5, expected);
+
+    uint32_t tags[InferenceWorker::MAX_BATCH_SIZE + 1] = {};
+    TEST_ASSERT_FALSE(worker.Submit(tags, 0));
+    TEST_ASSERT_FALSE(worker.Submit(tags, model.GetBatchSize() + 1));
+    TEST_ASSERT_FALSE(worker.Submit(tags, InferenceWorker::MAX_BATCH_SIZE + 1));
+    TEST_ASSERT_EQUAL_UINT(0, worker.GetNumPending());
+
+    fill_window(reinterpret_cast<uint8_t*>(model.GetInput<int8_t>(0).data()), 5);
+    TEST_ASSERT_TRUE(worker.Submit(tags, 1));
+    worker.Flush();
+    TEST_ASSERT_EQUAL_UINT(0, worker.GetNumPending());
+    TEST_ASSERT_EQUAL_INT8_ARRAY(expected, model.GetOutput<int8_t>().data(), 2);
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Test InferenceWorker matches direct inference", inference_worker_test_1),
+    Case("Test InferenceWorker invalid batches and in-place output", inference_worker_test_2)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
@@ -0,0 +1,212 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/model_data/person_detection_int8/model_data.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/pointwise_conv.h"
+#include "tensorflow/lite/micro/kernels/filter_repack.h"
+
+/*  Per-layer benchmark of the int8 convolution kernels on the compiled-in model.
+    Runs every CONV_2D layer of the model with its own filter and shapes, on a deterministic
+    input, through the reference kernel, the im2col kernel and, for 1x1 stride-1 layers,
+    the GEMM kernel that conv.cc picks for them. Checks that the outputs match and prints
+    the time of each kernel and the speedup of the chosen one over the reference.
+    The chosen kernel is also timed with the filter repacked as conv.cc does at Prepare,
+    next to the arena bytes that the copy would cost and whether weight-repack-max-bytes
+    repacks the layer. The layers that run faster repacked, and the time they would save,
+    are totalled to choose weight-repack-max-bytes.
+ */
+
+using namespace utest::v1;
+
+static constexpr int reps = 5;
+static constexpr size_t max_activation = 48 * 48 * 16;
+static constexpr size_t max_channels = 256;
+static constexpr size_t max_im2col = 1024;
+static constexpr size_t max_packed_filter = 16384;
+static int8_t input[max_activation];
+static int8_t expected[max_activation];
+static int8_t actual[max_activation];
+static int16_t im2col[max_im2col];
+static int8_t packed_filter[max_packed_filter];
+static int32_t bias[max_channels];
+static int32_t multiplier[max_channels];
+static int32_t shift[max_channels];
+
+static tflite::RuntimeShape tensor_shape(const tflite::Tensor* tensor)
+{
+    const flatbuffers::Vector<int32_t>* dims = tensor->shape();
+    return tflite::RuntimeShape(dims->size(), dims->data());
+}
+
+// Time reps runs of a kernel, in microseconds per run
+template <typename F>
+static int time_us(F run)
+{
+    Timer timer;
+    timer.start();
+    for (int i = 0; i < reps; i++) {
+        run();
+    }
+    timer.stop();
+    return timer.read_us() / reps;
+}
+
+// Benchmark each CONV_2D layer of the model
+static control_t kernel_benchmark_test_1(const size_t call_count)
+{
+    const tflite::Model* model = tflite::GetModel(g_person_detect_model_data);
+    const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+    int total_reference_us = 0;
+    int total_optimized_us = 0;
+    int total_repacked_bytes = 0;
+    int total_faster_bytes = 0;
+    int total_faster_saved_us = 0;
+    int num_layers = 0;
+
+    for (size_t i = 0; i < subgraph->operators()->size(); i++) {
+        const tflite::Operator* op = subgraph->operators()->Get(i);
+        const tflite::OperatorCode* code = model->operator_codes()->Get(op->opcode_index());
+        if (code->builtin_code() != tflite::BuiltinOperator_CONV_2D) {
+            continue;
+        }
+        const tflite::Conv2DOptions* options = op->builtin_options_as_Conv2DOptions();
+        const tflite::Tensor* input_tensor = subgraph->tensors()->Get(op->inputs()->Get(0));
+        const tflite::Tensor* filter_tensor = subgraph->tensors()->Get(op->inputs()->Get(1));
+        const tflite::Tensor* output_tensor = subgraph->tensors()->Get(op->outputs()->Get(0));
+        const tflite::RuntimeShape input_shape = tensor_shape(input_tensor);
+        const tflite::RuntimeShape filter_shape = tensor_shape(filter_tensor);
+        const tflite::RuntimeShape output_shape = tensor_shape(output_tensor);
+        const tflite::RuntimeShape bias_shape({output_shape.Dims(3)});
+        const int8_t* filter = reinterpret_cast<const int8_t*>(
+            model->buffers()->Get(filter_tensor->buffer())->data()->data());
+        TEST_ASSERT_TRUE(input_shape.FlatSize() <= (int)max_activation);
+        TEST_ASSERT_TRUE(output_shape.FlatSize() <= (int)max_activation);
+        TEST_ASSERT_TRUE(output_shape.Dims(3) <= (int)max_channels);
+
+        // SAME padding of the person-detect model, which only has odd filters
+        tflite::ConvParams params;
+        params.stride_height = options->stride_h();
+        params.stride_width = options->stride_w();
+        params.dilation_height_factor = options->dilation_h_factor();
+        params.dilation_width_factor = options->dilation_w_factor();
+        bool same = options->padding() == tflite::Padding_SAME;
+        params.padding_values.height = same ? filter_shape.Dims(1) / 2 : 0;
+        params.padding_values.width = same ? filter_shape.Dims(2) / 2 : 0;
+        params.input_offset = 128;
+        params.output_offset = -128;
+        params.quantized_activation_min = -128;
+        params.quantized_activation_max = 127;
+        for (int c = 0; c < output_shape.Dims(3); c++) {
+            bias[c] = (c * 37) % 2000 - 1000;
+            multiplier[c] = 1518500250;
+            shift[c] = -8;
+        }
+        for (int j = 0; j < input_shape.FlatSize(); j++) {
+            input[j] = (int8_t)((j * 7 + i) % 256 - 128);
+        }
+
+        int reference_us = time_us([&]() {
+            tflite::reference_integer_ops::ConvPerChannel(params, multiplier, shift, input_shape, input,
+                filter_shape, filter, bias_shape, bias, output_shape, expected);
+        });
+        int im2col_us = -1;
+        if (tflite::optimized_integer_ops::ConvIm2ColDepth(filter_shape) <= (int)max_im2col) {
+            im2col_us = time_us([&]() {
+                tflite::optimized_integer_ops::ConvPerChannel(params, multiplier, shift, input_shape, input,
+                    filter_shape, filter, bias_shape, bias, output_shape, actual, im2col);
+            });
+            TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, output_shape.FlatSize());
+        }
+        int gemm_us = -1;
+        if (tflite::optimized_integer_ops::IsPointwiseConv(params, filter_shape)
+                && tflite::optimized_integer_ops::PointwiseConvPackDepth(filter_shape) <= (int)max_im2col) {
+            gemm_us = time_us([&]() {
+                tflite::optimized_integer_ops::PointwiseConvPerChannel(params, multiplier, shift, input_shape, input,
+                    filter_shape, filter, bias_shape, bias, output_shape, actual, im2col);
+            });
+            TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, output_shape.FlatSize());
+        }
+
+        // The chosen kernel again, on the filter in the layout conv.cc repacks it to
+        const int filter_bytes = filter_shape.FlatSize();
+        const int output_pixels = output_shape.Dims(1) * output_shape.Dims(2);
+        const bool repack = im2col_us >= 0
+            && tflite::ops::micro::ShouldRepackFilter(filter_bytes, output_pixels);
+        int packed_us = -1;
+        if (im2col_us >= 0 && filter_bytes <= (int)max_packed_filter) {
+            tflite::optimized_integer_ops::PackFilterPairs(filter, filter_shape.Dims(0),
+                filter_bytes / filter_shape.Dims(0), packed_filter);
+            packed_us = time_us([&]() {
+                if (gemm_us >= 0) {
+                    tflite::optimized_integer_ops::PointwiseConvPerChannel(params, multiplier, shift,
+                        input_shape, input, filter_shape, packed_filter, bias_shape, bias, output_shape,
+                        actual, im2col, true);
+                } else {
+                    tflite::optimized_integer_ops::ConvPerChannel(params, multiplier, shift, input_shape,
+                        input, filter_shape, packed_filter, bias_shape, bias, output_shape, actual,
+                        im2col, true);
+                }
+            });
+            TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, output_shape.FlatSize());
+        }
+
+        const int flash_us = (gemm_us >= 0) ? gemm_us : (im2col_us >= 0) ? im2col_us : reference_us;
+        const bool faster = packed_us >= 0 && packed_us < flash_us;
+        const int optimized_us = (repack && packed_us >= 0) ? packed_us : flash_us;
+        printf("Layer %d CONV_2D %dx%d %dx%dx%d->%d: reference %d us, im2col %d us, gemm %d us, %d.%02dx\r\n",
+            (int)i, filter_shape.Dims(1), filter_shape.Dims(2), input_shape.Dims(1), input_shape.Dims(2),
+            input_shape.Dims(3), output_shape.Dims(3), reference_us, im2col_us, gemm_us,
+            reference_us / (optimized_us > 0 ? optimized_us : 1),
+            (reference_us * 100 / (optimized_us > 0 ? optimized_us : 1)) % 100);
+        printf("    filter %d bytes, %d output pixels: repacked %d us, %s, %s\r\n", filter_bytes,
+            output_pixels, packed_us, faster ? "faster" : "not faster",
+            repack ? "repacked in arena" : "read from flash");
+        if (repack) {
+            total_repacked_bytes += filter_bytes;
+        }
+        if (faster) {
+            total_faster_bytes += filter_bytes;
+            total_faster_saved_us += flash_us - packed_us;
+        }
+        total_reference_us += reference_us;
+        total_optimized_us += optimized_us;
+        num_layers++;
+    }
+
+    TEST_ASSERT_TRUE(num_layers > 0);
+    printf("CONV_2D total over %d layers: reference %d us, optimized %d us, %d bytes of repacked filters\r\n",
+        num_layers, total_reference_us, total_optimized_us, total_repacked_bytes);
+    printf("Repacking the filters of the faster layers would save %d us for %d bytes of arena\r\n",
+        total_faster_saved_us, total_faster_bytes);
+    greentea_send_kv("conv_reference_us", total_reference_us);
+    greentea_send_kv("conv_optimized_us", total_optimized_us);
+    greentea_send_kv("conv_repacked_bytes", total_repacked_bytes);
+    greentea_send_kv("conv_repack_faster_bytes", total_faster_bytes);
+    greentea_send_kv("conv_repack_saved_us", total_faster_saved_us);
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (120s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(120, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Benchmark CONV_2D kernels per layer", kernel_benchmark_test_1)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
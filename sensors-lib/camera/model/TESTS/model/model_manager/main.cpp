@@ -0,0 +1,126 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/model/ModelManager.h"
+#include "camera/model_data/person_detection_int8/model_data.h"
+#include "camera/model_data/model_arena_size.h"
+
+using namespace utest::v1;
+
+static constexpr size_t arena_size = 150 * 1024;
+static constexpr size_t window_bytes = 96 * 96;
+alignas(16) static uint8_t arena_a[arena_size];
+alignas(16) static uint8_t arena_b[arena_size];
+
+// Fill the first input slot of a model with a deterministic pattern and return the person score
+static int person_score(TFLM_Model& model, uint32_t seed)
+{
+    TensorSpan<int8_t> input = model.GetInput<int8_t>(0);
+    TEST_ASSERT_EQUAL_UINT(window_bytes, input.size());
+    for (size_t i = 0; i < input.size(); i++) {
+        seed = seed * 1103515245 + 12345;
+        input[i] = seed >> 16;
+    }
+    TensorSpan<const int8_t> output = model.Invoke<int8_t>();
+    TEST_ASSERT_FALSE(output.empty());
+    return output[1];
+}
+
+// Check that two models have separate interpreters
+static control_t model_manager_test_1(const size_t call_count)
+{
+    TFLM_Model model_a(g_person_detect_model_data, arena_size, arena_a);
+    TFLM_Model model_b(g_person_detect_model_data, arena_size, arena_b);
+    model_a.Initialize();
+    model_b.Initialize();
+    TEST_ASSERT_TRUE(model_a.IsInitialized());
+    TEST_ASSERT_TRUE(model_b.IsInitialized());
+    TEST_ASSERT_TRUE(model_a.GetInput<int8_t>(0).data() != model_b.GetInput<int8_t>(0).data());
+
+    int score_a = person_score(model_a, 7);
+    TEST_ASSERT_EQUAL_INT(score_a, person_score(model_b, 7));
+    return CaseNext;
+}
+
+// Check switching between models over one arena, and the arena requirement
+static control_t model_manager_test_2(const size_t call_count)
+{
+    ModelManager manager(arena_a, arena_size);
+    TEST_ASSERT_EQUAL_INT(-1, manager.GetActiveId());
+    TEST_ASSERT_EQUAL_INT(0, manager.Register(g_person_detect_model_data));
+    TEST_ASSERT_EQUAL_INT(1, manager.Register(g_person_detect_model_data));
+    TEST_ASSERT_EQUAL_INT(1, manager.GetActiveId());
+    TEST_ASSERT_TRUE(manager.GetRequiredArenaBytes() > 0);
+    TEST_ASSERT_TRUE(manager.GetRequiredArenaBytes() <= arena_size);
+    TEST_ASSERT_EQUAL_UINT(manager.GetArenaBytes(0), manager.GetRequiredArenaBytes());
+
+    int score = person_score(manager.GetModel(), 11);
+    TEST_ASSERT_TRUE(manager.Select(0));
+    TEST_ASSERT_EQUAL_INT(0, manager.GetActiveId());
+    TEST_ASSERT_EQUAL_INT(score, person_score(manager.GetModel(), 11));
+    TEST_ASSERT_FALSE(manager.Select(2));
+    return CaseNext;
+}
+
+// Check that registration fails when the registry is full or the arena is too small
+static control_t model_manager_test_3(const size_t call_count)
+{
+    ModelManager manager(arena_a, arena_size);
+    for (size_t id = 0; id < ModelManager::MAX_MODELS; id++) {
+        TEST_ASSERT_EQUAL_INT(id, manager.Register(g_person_detect_model_data));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, manager.Register(g_person_detect_model_data));
+
+    ModelManager small(arena_b, 16 * 1024);
+    TEST_ASSERT_EQUAL_INT(-1, small.Register(g_person_detect_model_data));
+    TEST_ASSERT_EQUAL_UINT(0, small.GetNumModels());
+    return CaseNext;
+}
+
+// Check that the recorded arena breakdown adds up to the need of a loaded model and fits the generated size
+static control_t model_manager_test_4(const size_t call_count)
+{
+    TFLM_Model model(g_person_detect_model_data, arena_size, arena_a);
+    model.Initialize();
+    TEST_ASSERT_TRUE(model.IsInitialized());
+    size_t used_bytes = model.GetArenaUsedBytes();
+
+    arena_usage_t usage;
+    TEST_ASSERT_TRUE(model.MeasureArena(usage));
+    TEST_ASSERT_FALSE(model.IsInitialized());
+    TEST_ASSERT_EQUAL_UINT(used_bytes, usage.used_bytes);
+    TEST_ASSERT_EQUAL_UINT(usage.used_bytes, usage.head_bytes + usage.tail_bytes);
+    TEST_ASSERT_EQUAL_UINT(usage.tail_bytes, usage.tensor_struct_bytes + usage.node_registration_bytes + 
+        usage.op_data_bytes + usage.variable_bytes + usage.other_bytes);
+    TEST_ASSERT_TRUE(usage.tensor_struct_bytes > 0 && usage.node_registration_bytes > 0);
+    TEST_ASSERT_TRUE(usage.used_bytes <= (size_t)kModelArenaSize);
+
+    model.Initialize();
+    TEST_ASSERT_TRUE(model.IsInitialized());
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (120s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(120, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Check separate interpreters per model", model_manager_test_1),
+    Case("Check switching models over a shared arena", model_manager_test_2),
+    Case("Check registration limits", model_manager_test_3),
+    Case("Check the recorded arena breakdown", model_manager_test_4)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
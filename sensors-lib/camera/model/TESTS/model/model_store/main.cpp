@@ -0,0 +1,114 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "mbedtls/sha256.h"
+#include "camera/model/ModelStore.h"
+#include "camera/model_data/person_detection_int8/model_data.h"
+
+using namespace utest::v1;
+
+static constexpr size_t chunk_size = 192;
+
+// Hexadecimal SHA-256 digest of a buffer, as sent with model_update_begin
+static std::string sha256_hex(const uint8_t* data, size_t len)
+{
+    uint8_t digest[ModelStore::DIGEST_SIZE];
+    mbedtls_sha256(data, len, digest, 0);
+    char hex[2 * ModelStore::DIGEST_SIZE + 1];
+    for (size_t i = 0; i < ModelStore::DIGEST_SIZE; i++) {
+        sprintf(hex + 2 * i, "%02x", digest[i]);
+    }
+    return std::string(hex);
+}
+
+// Write a buffer in chunks, sending the second chunk twice as a resent message would
+static bool write_chunks(ModelStore& store, const uint8_t* data, size_t len)
+{
+    for (size_t offset = 0; offset < len; offset += chunk_size) {
+        size_t n = (len - offset < chunk_size) ? len - offset : chunk_size;
+        if (!store.Write(offset, data + offset, n)) {
+            return false;
+        }
+        if (offset == 2 * chunk_size && !store.Write(chunk_size, data + chunk_size, chunk_size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Store the default model in chunks and map it back from flash
+static control_t model_store_test_1(const size_t call_count)
+{
+    ModelStore store(MBED_CONF_APP_MODEL_STORE_ADDRESS, MBED_CONF_APP_MODEL_STORE_SIZE);
+    const uint8_t* model = g_person_detect_model_data;
+    size_t len = g_person_detect_model_data_len;
+
+    TEST_ASSERT_TRUE(store.Begin(len, sha256_hex(model, len)));
+    TEST_ASSERT_TRUE(store.Load() == nullptr);
+    TEST_ASSERT_TRUE(write_chunks(store, model, len));
+    TEST_ASSERT_EQUAL_UINT(len, store.GetReceivedBytes());
+    TEST_ASSERT_TRUE(store.Commit());
+
+    const unsigned char* stored = store.Load();
+    TEST_ASSERT_TRUE(stored != nullptr);
+    TEST_ASSERT_EQUAL_UINT(len, store.GetModelSize());
+    TEST_ASSERT_EQUAL_INT(0, memcmp(stored, model, len));
+    return CaseNext;
+}
+
+// Test that a digest mismatch, missing bytes, out-of-order chunks and a region over the application 
+// are rejected
+static control_t model_store_test_2(const size_t call_count)
+{
+    ModelStore store(MBED_CONF_APP_MODEL_STORE_ADDRESS, MBED_CONF_APP_MODEL_STORE_SIZE);
+    static uint8_t data[1000];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = i * 7 + 3;
+    }
+    std::string digest = sha256_hex(data, sizeof(data));
+
+    TEST_ASSERT_FALSE(store.Begin(MBED_CONF_APP_MODEL_STORE_SIZE, digest));
+    TEST_ASSERT_FALSE(store.Begin(sizeof(data), "not a digest"));
+
+    TEST_ASSERT_TRUE(store.Begin(sizeof(data), digest));
+    TEST_ASSERT_FALSE(store.Write(chunk_size, data + chunk_size, chunk_size));
+    TEST_ASSERT_TRUE(store.Write(0, data, chunk_size));
+    TEST_ASSERT_FALSE(store.Commit());
+    TEST_ASSERT_FALSE(store.IsUpdating());
+
+    digest[0] = (digest[0] == '0') ? '1' : '0';
+    TEST_ASSERT_TRUE(store.Begin(sizeof(data), digest));
+    TEST_ASSERT_TRUE(write_chunks(store, data, sizeof(data)));
+    TEST_ASSERT_FALSE(store.Commit());
+    TEST_ASSERT_TRUE(store.Load() == nullptr);
+
+#if defined(FLASHIAP_APP_ROM_END_ADDR) && defined(MBED_ROM_START)
+    // Refused before anything is erased
+    ModelStore app_store(MBED_ROM_START, MBED_CONF_APP_MODEL_STORE_SIZE);
+    TEST_ASSERT_FALSE(app_store.Begin(sizeof(data), sha256_hex(data, sizeof(data))));
+#endif
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (120s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(120, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Test ModelStore stores and maps a model", model_store_test_1),
+    Case("Test ModelStore rejects bad updates", model_store_test_2)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
@@ -0,0 +1,99 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/model/TFLM_Model.h"
+#include "camera/model/OpProfiler.h"
+#include "camera/model_data/person_detection_int8/model_data.h"
+
+using namespace utest::v1;
+
+static constexpr size_t arena_size = 150 * 1024;
+alignas(16) static uint8_t arena[arena_size];
+static OpProfiler profiler;
+
+static void record(const char* tag, int node)
+{
+    uint32_t handle = profiler.BeginEvent(tag, tflite::Profiler::EventType::OPERATOR_INVOKE_EVENT, node, 0);
+    profiler.EndEvent(handle);
+}
+
+// Check that the ring buffer keeps the latest events in order and the totals keep every event
+static control_t op_profiler_test_1(const size_t call_count)
+{
+    static const char conv[] = "CONV_2D";
+    static const char pool[] = "AVERAGE_POOL_2D";
+    profiler.Reset();
+    for (size_t i = 0; i < OpProfiler::MAX_EVENTS + 10; i++) {
+        record((i % 2) ? pool : conv, i);
+    }
+    TEST_ASSERT_EQUAL_UINT(OpProfiler::MAX_EVENTS, profiler.GetNumEvents());
+    OpProfiler::op_event_t event;
+    TEST_ASSERT_TRUE(profiler.GetEvent(0, event));
+    TEST_ASSERT_EQUAL_UINT(10, event.node);
+    TEST_ASSERT_TRUE(profiler.GetEvent(OpProfiler::MAX_EVENTS - 1, event));
+    TEST_ASSERT_EQUAL_UINT(OpProfiler::MAX_EVENTS + 9, event.node);
+    TEST_ASSERT_FALSE(profiler.GetEvent(OpProfiler::MAX_EVENTS, event));
+
+    TEST_ASSERT_EQUAL_UINT(2, profiler.GetNumOpTypes());
+    TEST_ASSERT_EQUAL_STRING("CONV_2D", profiler.GetOpTotal(0).tag);
+    TEST_ASSERT_EQUAL_UINT((OpProfiler::MAX_EVENTS + 10) / 2, profiler.GetOpTotal(0).count);
+    TEST_ASSERT_TRUE(profiler.Summary().find("AVERAGE_POOL_2D:37:") != std::string::npos);
+
+    profiler.Reset();
+    TEST_ASSERT_EQUAL_UINT(0, profiler.GetNumEvents());
+    TEST_ASSERT_EQUAL_UINT(0, profiler.GetNumOpTypes());
+    TEST_ASSERT_TRUE(profiler.Summary().empty());
+    return CaseNext;
+}
+
+// Check that every node of an invoke is profiled. 
+// Needs a debug build, or the model-profiler option in release builds.
+static control_t op_profiler_test_2(const size_t call_count)
+{
+    TFLM_Model model(g_person_detect_model_data, arena_size, arena);
+    model.Initialize();
+    model.SetProfiler(&profiler);
+    TEST_ASSERT_TRUE(model.IsInitialized());
+    profiler.Reset();
+    TEST_ASSERT_FALSE(model.Invoke<int8_t>().empty());
+
+    size_t num_nodes = tflite::GetModel(g_person_detect_model_data)->subgraphs()->Get(0)->operators()->size();
+    TEST_ASSERT_EQUAL_UINT(num_nodes, profiler.GetNumEvents());
+    size_t count = 0;
+    for (size_t i = 0; i < profiler.GetNumOpTypes(); i++) {
+        count += profiler.GetOpTotal(i).count;
+    }
+    TEST_ASSERT_EQUAL_UINT(num_nodes, count);
+    TEST_ASSERT_TRUE(profiler.GetTotalTicks() > 0);
+    profiler.Dump();
+    printf("%s\r\n", profiler.Summary().c_str());
+
+    model.SetProfiler(nullptr);
+    profiler.Reset();
+    TEST_ASSERT_FALSE(model.Invoke<int8_t>().empty());
+    TEST_ASSERT_EQUAL_UINT(0, profiler.GetNumEvents());
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Check OpProfiler ring buffer and totals", op_profiler_test_1),
+    Case("Check OpProfiler records every node", op_profiler_test_2)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
@@ -0,0 +1,242 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include <vector>
+#include "flatbuffers/flatbuffers.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+/*  Tests of the TFLM operator fusion pass (lib/tensorflow/lite/micro/micro_fusion.h) on
+    small int8 models built here: each model is run with and without fusion, and the
+    fused interpreter must give the same outputs from a smaller arena.
+ */
+
+using namespace utest::v1;
+
+static uint32_t rng_state = 1;
+
+// Deterministic pseudo-random numbers, so that a failure can be reproduced
+static int32_t random_int(int32_t min, int32_t max)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return min + (int32_t)((rng_state >> 8) % (uint32_t)(max - min + 1));
+}
+
+static constexpr int height = 8;
+static constexpr int depth = 8;
+static constexpr size_t arena_size = 16 * 1024;
+alignas(16) static uint8_t fused_arena[arena_size];
+alignas(16) static uint8_t unfused_arena[arena_size];
+
+// Builds int8 flatbuffer models out of PAD, CONV_2D and ADD operators, all on
+// height x width x depth activations
+class ModelBuilder {
+public:
+    ModelBuilder()
+    {
+        // Buffer 0 is the empty buffer of all the activations
+        buffers.push_back(tflite::CreateBuffer(fbb));
+        opcodes.push_back(tflite::CreateOperatorCode(fbb, tflite::BuiltinOperator_PAD));
+        opcodes.push_back(tflite::CreateOperatorCode(fbb, tflite::BuiltinOperator_CONV_2D));
+        opcodes.push_back(tflite::CreateOperatorCode(fbb, tflite::BuiltinOperator_ADD));
+    }
+
+    int activation(int size, float scale, int zero_point)
+    {
+        return add_tensor({1, size, size, depth}, tflite::TensorType_INT8, 0,
+            quantization({scale}, {zero_point}));
+    }
+
+    int pad(int input, int output)
+    {
+        const int32_t paddings[] = {0, 0, 1, 1, 1, 1, 0, 0};
+        int paddings_tensor = add_tensor({4, 2}, tflite::TensorType_INT32,
+            add_buffer(paddings, sizeof(paddings)), 0);
+        add_operator(0, {input, paddings_tensor}, output, tflite::BuiltinOptions_PadOptions,
+            tflite::CreatePadOptions(fbb).Union());
+        return output;
+    }
+
+    int conv(int input, int output, tflite::Padding padding, float input_scale)
+    {
+        std::vector<int8_t> filter(depth * 3 * 3 * depth);
+        for (int8_t& value : filter) {
+            value = (int8_t)random_int(-127, 127);
+        }
+        std::vector<int32_t> bias(depth);
+        std::vector<float> filter_scales(depth);
+        std::vector<float> bias_scales(depth);
+        for (int c = 0; c < depth; c++) {
+            bias[c] = random_int(-2000, 2000);
+            filter_scales[c] = 0.002f * random_int(1, 10);
+            bias_scales[c] = input_scale * filter_scales[c];
+        }
+        int filter_tensor = add_tensor({depth, 3, 3, depth}, tflite::TensorType_INT8,
+            add_buffer(filter.data(), filter.size()),
+            quantization(filter_scales, std::vector<int>(depth, 0)));
+        int bias_tensor = add_tensor({depth}, tflite::TensorType_INT32,
+            add_buffer(bias.data(), bias.size() * sizeof(int32_t)),
+            quantization(bias_scales, std::vector<int>(depth, 0)));
+        add_operator(1, {input, filter_tensor, bias_tensor}, output,
+            tflite::BuiltinOptions_Conv2DOptions,
+            tflite::CreateConv2DOptions(fbb, padding, 1, 1).Union());
+        return output;
+    }
+
+    int add(int input1, int input2, int output)
+    {
+        add_operator(2, {input1, input2}, output, tflite::BuiltinOptions_AddOptions,
+            tflite::CreateAddOptions(fbb, tflite::ActivationFunctionType_RELU).Union());
+        return output;
+    }
+
+    const tflite::Model* finish(int input, const std::vector<int>& outputs)
+    {
+        std::vector<int> inputs = {input};
+        auto subgraph = tflite::CreateSubGraph(fbb, fbb.CreateVector(tensors),
+            fbb.CreateVector(inputs), fbb.CreateVector(outputs), fbb.CreateVector(operators));
+        std::vector<flatbuffers::Offset<tflite::SubGraph>> subgraphs = {subgraph};
+        fbb.Finish(tflite::CreateModel(fbb, TFLITE_SCHEMA_VERSION, fbb.CreateVector(opcodes),
+            fbb.CreateVector(subgraphs), 0, fbb.CreateVector(buffers)));
+        return tflite::GetModel(fbb.GetBufferPointer());
+    }
+
+private:
+    flatbuffers::Offset<tflite::QuantizationParameters> quantization(
+        const std::vector<float>& scales, const std::vector<int>& zero_points)
+    {
+        std::vector<int64_t> zero_points64(zero_points.begin(), zero_points.end());
+        return tflite::CreateQuantizationParameters(fbb, 0, 0, fbb.CreateVector(scales),
+            fbb.CreateVector(zero_points64));
+    }
+
+    int add_buffer(const void* data, size_t size)
+    {
+        buffers.push_back(tflite::CreateBuffer(fbb,
+            fbb.CreateVector(static_cast<const uint8_t*>(data), size)));
+        return buffers.size() - 1;
+    }
+
+    int add_tensor(const std::vector<int>& shape, tflite::TensorType type, int buffer,
+        flatbuffers::Offset<tflite::QuantizationParameters> quantization)
+    {
+        tensors.push_back(tflite::CreateTensor(fbb, fbb.CreateVector(shape), type, buffer, 0,
+            quantization));
+        return tensors.size() - 1;
+    }
+
+    void add_operator(int opcode, const std::vector<int>& inputs, int output,
+        tflite::BuiltinOptions options_type, flatbuffers::Offset<void> options)
+    {
+        std::vector<int> outputs = {output};
+        operators.push_back(tflite::CreateOperator(fbb, opcode, fbb.CreateVector(inputs),
+            fbb.CreateVector(outputs), options_type, options));
+    }
+
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<tflite::Buffer>> buffers;
+    std::vector<flatbuffers::Offset<tflite::OperatorCode>> opcodes;
+    std::vector<flatbuffers::Offset<tflite::Tensor>> tensors;
+    std::vector<flatbuffers::Offset<tflite::Operator>> operators;
+};
+
+// Runs the model with and without fusion on random inputs, checks that all the outputs
+// match and returns the number of fused operators. Both arena sizes are printed.
+static size_t run_fused_and_unfused(const tflite::Model* model, size_t* fused_arena_bytes,
+    size_t* unfused_arena_bytes)
+{
+    static tflite::MicroErrorReporter error_reporter;
+    tflite::MicroMutableOpResolver<3> resolver;
+    resolver.AddPad();
+    resolver.AddConv2D();
+    resolver.AddAdd();
+
+    tflite::MicroInterpreter fused(model, resolver, fused_arena, arena_size, &error_reporter);
+    tflite::MicroInterpreter unfused(model, resolver, unfused_arena, arena_size, &error_reporter);
+    unfused.set_operator_fusion(false);
+    TEST_ASSERT_EQUAL(kTfLiteOk, fused.AllocateTensors());
+    TEST_ASSERT_EQUAL(kTfLiteOk, unfused.AllocateTensors());
+    TEST_ASSERT_EQUAL(0, unfused.fused_operators());
+    *fused_arena_bytes = fused.arena_used_bytes();
+    *unfused_arena_bytes = unfused.arena_used_bytes();
+    printf("%d fused operators, arena %d bytes fused, %d bytes unfused\r\n",
+        (int)fused.fused_operators(), (int)*fused_arena_bytes, (int)*unfused_arena_bytes);
+
+    for (int run = 0; run < 3; run++) {
+        TfLiteTensor* input = fused.input(0);
+        for (size_t i = 0; i < input->bytes; i++) {
+            input->data.int8[i] = (int8_t)random_int(-128, 127);
+        }
+        memcpy(unfused.input(0)->data.int8, input->data.int8, input->bytes);
+        TEST_ASSERT_EQUAL(kTfLiteOk, fused.Invoke());
+        TEST_ASSERT_EQUAL(kTfLiteOk, unfused.Invoke());
+        for (size_t i = 0; i < fused.outputs_size(); i++) {
+            TEST_ASSERT_EQUAL(unfused.output(i)->bytes, fused.output(i)->bytes);
+            TEST_ASSERT_EQUAL_INT8_ARRAY(unfused.output(i)->data.int8, fused.output(i)->data.int8,
+                fused.output(i)->bytes);
+        }
+    }
+    return fused.fused_operators();
+}
+
+// Test two residual blocks, PAD -> CONV_2D (VALID) -> ADD and CONV_2D (SAME) -> ADD, where
+// the second block's residual is the output of the first fused node
+static control_t operator_fusion_test_1(const size_t call_count)
+{
+    ModelBuilder builder;
+    int input = builder.activation(height, 0.05f, -3);
+    int padded = builder.pad(input, builder.activation(height + 2, 0.05f, -3));
+    int conv1 = builder.conv(padded, builder.activation(height, 0.1f, 5), tflite::Padding_VALID, 0.05f);
+    int block1 = builder.add(conv1, input, builder.activation(height, 0.12f, -2));
+    int conv2 = builder.conv(block1, builder.activation(height, 0.2f, 1), tflite::Padding_SAME, 0.12f);
+    int block2 = builder.add(block1, conv2, builder.activation(height, 0.25f, 0));
+    const tflite::Model* model = builder.finish(input, {block2});
+
+    size_t fused_arena_bytes, unfused_arena_bytes;
+    TEST_ASSERT_EQUAL(3, run_fused_and_unfused(model, &fused_arena_bytes, &unfused_arena_bytes));
+    TEST_ASSERT_TRUE(fused_arena_bytes < unfused_arena_bytes);
+    return CaseNext;
+}
+
+// Test that intermediates read elsewhere are kept: the convolution output is also an output
+// of the model, so only the PAD is fused
+static control_t operator_fusion_test_2(const size_t call_count)
+{
+    ModelBuilder builder;
+    int input = builder.activation(height, 0.05f, -3);
+    int padded = builder.pad(input, builder.activation(height + 2, 0.05f, -3));
+    int conv = builder.conv(padded, builder.activation(height, 0.1f, 5), tflite::Padding_VALID, 0.05f);
+    int sum = builder.add(conv, input, builder.activation(height, 0.12f, -2));
+    const tflite::Model* model = builder.finish(input, {sum, conv});
+
+    size_t fused_arena_bytes, unfused_arena_bytes;
+    TEST_ASSERT_EQUAL(1, run_fused_and_unfused(model, &fused_arena_bytes, &unfused_arena_bytes));
+    TEST_ASSERT_TRUE(fused_arena_bytes <= unfused_arena_bytes);
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Test fused residual blocks match the unfused model with a smaller arena", operator_fusion_test_1),
+    Case("Test tensors read by other operators are not fused away", operator_fusion_test_2)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
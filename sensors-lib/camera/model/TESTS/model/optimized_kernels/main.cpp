@@ -0,0 +1,334 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/pointwise_conv.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/depthwise_conv.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/depthwise_conv.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/fully_connected.h"
+
+using namespace utest::v1;
+
+static uint32_t rng_state = 1;
+
+// Deterministic pseudo-random numbers, so that a failure can be reproduced
+static int32_t random_int(int32_t min, int32_t max)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return min + (int32_t)((rng_state >> 8) % (uint32_t)(max - min + 1));
+}
+
+static void random_int8(int8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (int8_t)random_int(-128, 127);
+    }
+}
+
+static constexpr size_t max_elements = 4096;
+static int8_t input[max_elements];
+static int8_t filter[max_elements];
+static int8_t packed_filter[max_elements];
+static int32_t bias[64];
+static int32_t multiplier[64];
+static int32_t shift[64];
+static int8_t expected[max_elements];
+static int8_t actual[max_elements];
+static int16_t im2col[max_elements];
+static int32_t folded_bias[64];
+
+static void random_quantization(int channels)
+{
+    for (int c = 0; c < channels; c++) {
+        bias[c] = random_int(-20000, 20000);
+        multiplier[c] = random_int(1 << 30, 0x7fffffff);
+        shift[c] = random_int(-10, -6);
+    }
+}
+
+// Test the optimised int8 convolution against the reference over random shapes, strides,
+// dilations and padding, including odd channel counts and depths that are not a multiple of 4
+static control_t optimized_kernels_test_1(const size_t call_count)
+{
+    for (int iteration = 0; iteration < 200; iteration++) {
+        const int batches = random_int(1, 2);
+        const int input_height = random_int(1, 9);
+        const int input_width = random_int(1, 9);
+        const int input_depth = random_int(1, 11);
+        const int output_depth = random_int(1, 9);
+        const int filter_height = random_int(1, 3);
+        const int filter_width = random_int(1, 3);
+
+        tflite::ConvParams params;
+        params.stride_height = random_int(1, 2);
+        params.stride_width = random_int(1, 2);
+        params.dilation_height_factor = random_int(1, 2);
+        params.dilation_width_factor = random_int(1, 2);
+        params.padding_values.height = random_int(0, filter_height / 2 + 1);
+        params.padding_values.width = random_int(0, filter_width / 2 + 1);
+        params.input_offset = random_int(-127, 128);
+        params.output_offset = random_int(-128, 127);
+        params.quantized_activation_min = (iteration % 3 == 0) ? 0 : -128;
+        params.quantized_activation_max = (iteration % 5 == 0) ? 100 : 127;
+
+        const int output_height = 1 + (input_height + 2 * params.padding_values.height
+            - params.dilation_height_factor * (filter_height - 1) - 1) / params.stride_height;
+        const int output_width = 1 + (input_width + 2 * params.padding_values.width
+            - params.dilation_width_factor * (filter_width - 1) - 1) / params.stride_width;
+        if (output_height < 1 || output_width < 1) {
+            continue;
+        }
+        const tflite::RuntimeShape input_shape({batches, input_height, input_width, input_depth});
+        const tflite::RuntimeShape filter_shape({output_depth, filter_height, filter_width, input_depth});
+        const tflite::RuntimeShape bias_shape({output_depth});
+        const tflite::RuntimeShape output_shape({batches, output_height, output_width, output_depth});
+        TEST_ASSERT_TRUE(input_shape.FlatSize() <= (int)max_elements);
+        TEST_ASSERT_TRUE(output_shape.FlatSize() <= (int)max_elements);
+
+        random_int8(input, input_shape.FlatSize());
+        random_int8(filter, filter_shape.FlatSize());
+        random_quantization(output_depth);
+        const int32_t* bias_data = (iteration % 4 == 0) ? nullptr : bias;
+
+        tflite::reference_integer_ops::ConvPerChannel(params, multiplier, shift,
+            input_shape, input, filter_shape, filter, bias_shape, bias_data, output_shape, expected);
+        tflite::optimized_integer_ops::ConvPerChannel(params, multiplier, shift,
+            input_shape, input, filter_shape, filter, bias_shape, bias_data, output_shape, actual, im2col);
+        TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, output_shape.FlatSize());
+    }
+    return CaseNext;
+}
+
+// Test the depthwise convolution against the reference: the 3x3 stride 1 and stride 2 paths
+// with every padding, channel counts around the 4-channel groups, and shapes that fall back
+static control_t optimized_kernels_test_2(const size_t call_count)
+{
+    for (int iteration = 0; iteration < 300; iteration++) {
+        const bool specialised = iteration % 4 != 0;
+        const int batches = random_int(1, 2);
+        const int input_height = random_int(1, 10);
+        const int input_width = random_int(1, 10);
+        const int depth_multiplier = specialised ? 1 : random_int(1, 2);
+        const int input_depth = random_int(1, 10);
+        const int output_depth = input_depth * depth_multiplier;
+        const int filter_height = specialised ? 3 : random_int(1, 3);
+        const int filter_width = specialised ? 3 : random_int(1, 3);
+
+        tflite::DepthwiseParams params;
+        params.stride_height = random_int(1, 2);
+        params.stride_width = random_int(1, 2);
+        params.dilation_height_factor = specialised ? 1 : random_int(1, 2);
+        params.dilation_width_factor = specialised ? 1 : random_int(1, 2);
+        params.depth_multiplier = depth_multiplier;
+        params.padding_values.height = random_int(0, 2);
+        params.padding_values.width = random_int(0, 2);
+        params.input_offset = random_int(-127, 128);
+        params.weights_offset = 0;
+        params.output_offset = random_int(-128, 127);
+        params.quantized_activation_min = (iteration % 3 == 0) ? -100 : -128;
+        params.quantized_activation_max = (iteration % 5 == 0) ? 90 : 127;
+
+        const int output_height = 1 + (input_height + 2 * params.padding_values.height
+            - params.dilation_height_factor * (filter_height - 1) - 1) / params.stride_height;
+        const int output_width = 1 + (input_width + 2 * params.padding_values.width
+            - params.dilation_width_factor * (filter_width - 1) - 1) / params.stride_width;
+        if (output_height < 1 || output_width < 1) {
+            continue;
+        }
+        const tflite::RuntimeShape input_shape({batches, input_height, input_width, input_depth});
+        const tflite::RuntimeShape filter_shape({1, filter_height, filter_width, output_depth});
+        const tflite::RuntimeShape bias_shape({output_depth});
+        const tflite::RuntimeShape output_shape({batches, output_height, output_width, output_depth});
+        if (specialised) {
+            TEST_ASSERT_TRUE(tflite::optimized_integer_ops::IsDepthwiseConv3x3(params, filter_shape));
+        }
+        TEST_ASSERT_TRUE(input_shape.FlatSize() <= (int)max_elements);
+        TEST_ASSERT_TRUE(output_shape.FlatSize() <= (int)max_elements);
+
+        random_int8(input, input_shape.FlatSize());
+        random_int8(filter, filter_shape.FlatSize());
+        random_quantization(output_depth);
+
+        tflite::reference_integer_ops::DepthwiseConvPerChannel(params, multiplier, shift,
+            input_shape, input, filter_shape, filter, bias_shape, bias, output_shape, expected);
+        tflite::optimized_integer_ops::DepthwiseConvPerChannel(params, multiplier, shift,
+            input_shape, input, filter_shape, filter, bias_shape, bias, output_shape, actual);
+        TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, output_shape.FlatSize());
+    }
+    return CaseNext;
+}
+
+// Test the fully-connected layer with folded filter sums against the reference,
+// for symmetric and asymmetric filters, with and without bias
+static control_t optimized_kernels_test_3(const size_t call_count)
+{
+    for (int iteration = 0; iteration < 200; iteration++) {
+        const int batches = random_int(1, 3);
+        const int accum_depth = random_int(1, 300);
+        const int output_depth = random_int(1, 12);
+
+        tflite::FullyConnectedParams params;
+        params.input_offset = random_int(-127, 128);
+        params.weights_offset = (iteration % 2 == 0) ? 0 : random_int(-127, 128);
+        params.output_offset = random_int(-128, 127);
+        params.output_multiplier = random_int(1 << 30, 0x7fffffff);
+        params.output_shift = random_int(-12, -8);
+        params.quantized_activation_min = (iteration % 3 == 0) ? 0 : -128;
+        params.quantized_activation_max = 127;
+
+        const tflite::RuntimeShape input_shape({batches, accum_depth});
+        const tflite::RuntimeShape filter_shape({output_depth, accum_depth});
+        const tflite::RuntimeShape bias_shape({output_depth});
+        const tflite::RuntimeShape output_shape({batches, output_depth});
+        TEST_ASSERT_TRUE(input_shape.FlatSize() <= (int)max_elements);
+        TEST_ASSERT_TRUE(filter_shape.FlatSize() <= (int)max_elements);
+
+        random_int8(input, input_shape.FlatSize());
+        random_int8(filter, filter_shape.FlatSize());
+        random_quantization(output_depth);
+        const int32_t* bias_data = (iteration % 5 == 0) ? nullptr : bias;
+
+        tflite::reference_integer_ops::FullyConnected(params, input_shape, input,
+            filter_shape, filter, bias_shape, bias_data, output_shape, expected);
+        tflite::optimized_integer_ops::FoldFilterSumsIntoBias(params, filter_shape, filter,
+            bias_data, output_depth, folded_bias);
+        tflite::optimized_integer_ops::FullyConnected(params, input_shape, input,
+            filter_shape, filter, folded_bias, output_shape, actual);
+        TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, output_shape.FlatSize());
+    }
+    return CaseNext;
+}
+
+// Test the 1x1 convolution GEMM against the reference, with odd pixel and channel counts
+// for the edges of the 2x2 blocks
+static control_t optimized_kernels_test_4(const size_t call_count)
+{
+    for (int iteration = 0; iteration < 200; iteration++) {
+        const int batches = random_int(1, 2);
+        const int height = random_int(1, 7);
+        const int width = random_int(1, 7);
+        const int input_depth = random_int(1, 40);
+        const int output_depth = random_int(1, 20);
+
+        tflite::ConvParams params;
+        params.stride_height = 1;
+        params.stride_width = 1;
+        params.dilation_height_factor = 1;
+        params.dilation_width_factor = 1;
+        params.padding_values.height = 0;
+        params.padding_values.width = 0;
+        params.input_offset = random_int(-127, 128);
+        params.output_offset = random_int(-128, 127);
+        params.quantized_activation_min = (iteration % 3 == 0) ? 0 : -128;
+        params.quantized_activation_max = 127;
+
+        const tflite::RuntimeShape input_shape({batches, height, width, input_depth});
+        const tflite::RuntimeShape filter_shape({output_depth, 1, 1, input_depth});
+        const tflite::RuntimeShape bias_shape({output_depth});
+        const tflite::RuntimeShape output_shape({batches, height, width, output_depth});
+        TEST_ASSERT_TRUE(tflite::optimized_integer_ops::IsPointwiseConv(params, filter_shape));
+        TEST_ASSERT_TRUE(input_shape.FlatSize() <= (int)max_elements);
+        TEST_ASSERT_TRUE(output_shape.FlatSize() <= (int)max_elements);
+
+        random_int8(input, input_shape.FlatSize());
+        random_int8(filter, filter_shape.FlatSize());
+        random_quantization(output_depth);
+        const int32_t* bias_data = (iteration % 4 == 0) ? nullptr : bias;
+
+        tflite::reference_integer_ops::ConvPerChannel(params, multiplier, shift,
+            input_shape, input, filter_shape, filter, bias_shape, bias_data, output_shape, expected);
+        tflite::optimized_integer_ops::PointwiseConvPerChannel(params, multiplier, shift,
+            input_shape, input, filter_shape, filter, bias_shape, bias_data, output_shape, actual, im2col);
+        TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, output_shape.FlatSize());
+    }
+    return CaseNext;
+}
+
+// Test both convolution kernels on filters repacked with PackFilterPairs() against the
+// reference on the original filter, with odd channel counts for the unpaired last row and
+// depths that are not a multiple of 4 for the tails of each pair
+static control_t optimized_kernels_test_5(const size_t call_count)
+{
+    for (int iteration = 0; iteration < 200; iteration++) {
+        const bool pointwise = iteration % 2 == 0;
+        const int batches = random_int(1, 2);
+        const int input_height = random_int(1, 7);
+        const int input_width = random_int(1, 7);
+        const int input_depth = random_int(1, 24);
+        const int output_depth = random_int(1, 11);
+        const int filter_height = pointwise ? 1 : random_int(1, 3);
+        const int filter_width = pointwise ? 1 : random_int(1, 3);
+
+        tflite::ConvParams params;
+        params.stride_height = pointwise ? 1 : random_int(1, 2);
+        params.stride_width = pointwise ? 1 : random_int(1, 2);
+        params.dilation_height_factor = 1;
+        params.dilation_width_factor = 1;
+        params.padding_values.height = pointwise ? 0 : filter_height / 2;
+        params.padding_values.width = pointwise ? 0 : filter_width / 2;
+        params.input_offset = random_int(-127, 128);
+        params.output_offset = random_int(-128, 127);
+        params.quantized_activation_min = (iteration % 3 == 0) ? 0 : -128;
+        params.quantized_activation_max = 127;
+
+        const int output_height = 1 + (input_height + 2 * params.padding_values.height
+            - filter_height) / params.stride_height;
+        const int output_width = 1 + (input_width + 2 * params.padding_values.width
+            - filter_width) / params.stride_width;
+        const tflite::RuntimeShape input_shape({batches, input_height, input_width, input_depth});
+        const tflite::RuntimeShape filter_shape({output_depth, filter_height, filter_width, input_depth});
+        const tflite::RuntimeShape bias_shape({output_depth});
+        const tflite::RuntimeShape output_shape({batches, output_height, output_width, output_depth});
+        TEST_ASSERT_TRUE(input_shape.FlatSize() <= (int)max_elements);
+        TEST_ASSERT_TRUE(filter_shape.FlatSize() <= (int)max_elements);
+        TEST_ASSERT_TRUE(output_shape.FlatSize() <= (int)max_elements);
+
+        random_int8(input, input_shape.FlatSize());
+        random_int8(filter, filter_shape.FlatSize());
+        random_quantization(output_depth);
+        const int32_t* bias_data = (iteration % 4 == 1) ? nullptr : bias;
+        tflite::optimized_integer_ops::PackFilterPairs(filter, output_depth,
+            filter_shape.FlatSize() / output_depth, packed_filter);
+
+        tflite::reference_integer_ops::ConvPerChannel(params, multiplier, shift,
+            input_shape, input, filter_shape, filter, bias_shape, bias_data, output_shape, expected);
+        tflite::optimized_integer_ops::ConvPerChannel(params, multiplier, shift, input_shape, input,
+            filter_shape, packed_filter, bias_shape, bias_data, output_shape, actual, im2col, true);
+        TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, output_shape.FlatSize());
+        if (pointwise) {
+            tflite::optimized_integer_ops::PointwiseConvPerChannel(params, multiplier, shift,
+                input_shape, input, filter_shape, packed_filter, bias_shape, bias_data, output_shape,
+                actual, im2col, true);
+            TEST_ASSERT_EQUAL_INT8_ARRAY(expected, actual, output_shape.FlatSize());
+        }
+    }
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Test optimised int8 convolution is bit-exact with the reference", optimized_kernels_test_1),
+    Case("Test optimised int8 depthwise convolution is bit-exact with the reference", optimized_kernels_test_2),
+    Case("Test optimised int8 fully-connected layer is bit-exact with the reference", optimized_kernels_test_3),
+    Case("Test int8 1x1 convolution GEMM is bit-exact with the reference", optimized_kernels_test_4),
+    Case("Test convolutions on repacked filters are bit-exact with the reference", optimized_kernels_test_5)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
@@ -1,8 +1,32 @@
 #include "model/TFLM_Model.h"
 #include "mbed_trace.h"
+#if MBED_CONF_APP_ALL_OPS_RESOLVER
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#else
+#include "model_data/model_op_resolver.h"
+#endif
 
 # define TRACE_GROUP "TFLM_Model.cpp"
 
+/*  @brief  Get the op resolver shared by every model. It holds no per-model state.
+            Only the ops of the models listed in model_op_resolver.h (see tools/make_op_resolver.py) 
+            are linked, unless the all-ops-resolver option is set in mbed_app.json.
+    @return nullptr if the ops could not be registered.
+    */
+static const tflite::MicroOpResolver* GetResolver(tflite::ErrorReporter* error_reporter)
+{
+#if MBED_CONF_APP_ALL_OPS_RESOLVER
+    static tflite::AllOpsResolver resolver;
+#else
+    static ModelOpResolver resolver(error_reporter);
+    if (resolver.GetRegistrationLength() == 0 && RegisterModelOps(resolver) != kTfLiteOk)
+    {
+        return nullptr;
+    }
+#endif
+    return &resolver;
+}
+
 /*  @brief  Allocates memory for the TFLM model and initializes various components.
     @author Daniel Tan
     @return Void;
@@ -13,6 +37,13 @@ void TFLM_Model::Initialize()
     // lifetime uncertainty, but since this has a trivial destructor it's okay.
 
     tr_debug("TFLM_Model::Initialize() called");
+    // Initializing again, e.g. after SetModel(), replaces the previous interpreter
+    ClearMemory();
+    if (model == nullptr)
+    {
+        tr_err("No model data");
+        return;
+    }
     tr_debug("Initializing error reporter");
     static tflite::MicroErrorReporter micro_error_reporter;
     this->error_reporter = &micro_error_reporter;
@@ -32,19 +63,23 @@ void TFLM_Model::Initialize()
         return;
     }
 
-    // This pulls in all the operation implementations we need.
+    // This pulls in the operation implementations we need.
     tr_debug("Initializing ops resolver");
-    static tflite::AllOpsResolver resolver;
+    const tflite::MicroOpResolver* resolver = GetResolver(error_reporter);
+    if (resolver == nullptr)
+    {
+        TF_LITE_REPORT_ERROR(error_reporter, "Op registration failed\n");
+        return;
+    }
     if (verbose)
     {
         TF_LITE_REPORT_ERROR(error_reporter, "Resolver initialized \n");
     }
 
     // Build an interpreter to run the model with.
-    tr_debug("Initializing static interpreter");
-    static tflite::MicroInterpreter static_interpreter(
-        model, resolver, tensor_arena, kTensorArenaSize, error_reporter);
-    this->interpreter = &static_interpreter;
+    tr_debug("Initializing interpreter");
+    this->interpreter = new (interpreter_storage) tflite::MicroInterpreter(
+        model, *resolver, tensor_arena, kTensorArenaSize, error_reporter, profiler);
     if (verbose)
     {
         TF_LITE_REPORT_ERROR(error_reporter, "Interpreter initialized \n");
@@ -88,11 +123,84 @@ void TFLM_Model::Initialize()
         input->dims->data[2],
         input->dims->data[3]);
 
+    // The leading dimension is the batch; each invoke can process that many windows
+    batch_size = (input->dims->size > 0 && input->dims->data[0] > 1) ? input->dims->data[0] : 1;
+    input_item_bytes = input->bytes / batch_size;
+    output_item_bytes = output->bytes / batch_size;
+    tr_debug("Model batch size: %d", batch_size);
+
+    // Inputs are [batch, height, width, channels]. The last output dimension holds the class scores; 
+    // a fully-convolutional model has more than one row of scores per batch item, one for each cell.
+    if (input->dims->size == 4)
+    {
+        input_height = input->dims->data[1];
+        input_width = input->dims->data[2];
+    }
+    size_t output_elements = 1;
+    for (int i = 0; i < output->dims->size; i++)
+    {
+        output_elements *= output->dims->data[i];
+    }
+    num_classes = output->dims->data[output->dims->size - 1];
+    num_cells = output_elements / (batch_size * num_classes);
+    tr_debug("Model scores %d cells of %d classes per input", num_cells, num_classes);
+
     // Keep track of how many inferences we have performed.
     inference_count = 0;
     tr_debug("TFLM_Model::Initialize() resolved");
 }
 
+/*  @brief  Destroy the interpreter and forget the tensor layout, 
+            so that the tensor arena can be reused by another model.
+    */
+void TFLM_Model::ClearMemory(void)
+{
+    if (interpreter != nullptr)
+    {
+        interpreter->~MicroInterpreter();
+        interpreter = nullptr;
+    }
+    input = nullptr;
+    output = nullptr;
+    batch_size = 1;
+    input_item_bytes = 0;
+    output_item_bytes = 0;
+    input_height = 0;
+    input_width = 0;
+    num_cells = 0;
+    num_classes = 0;
+}
+
+/*  @brief  Switch to a different model in flash. Takes effect on the next Initialize().
+    @param  model_data: Flatbuffer of the model, which must outlive this object.
+    */
+void TFLM_Model::SetModel(const unsigned char* model_data)
+{
+    ClearMemory();
+    model = (model_data == nullptr) ? nullptr : tflite::GetModel(model_data);
+}
+
+/*  @brief  Record every node invoke with a profiler, e.g. an OpProfiler, or stop with nullptr.
+            The interpreter takes the profiler when it is created, so a loaded model is 
+            initialized again.
+    @param  profiler: Profiler that outlives the interpreter.
+    */
+void TFLM_Model::SetProfiler(tflite::Profiler* profiler)
+{
+    this->profiler = profiler;
+    if (interpreter != nullptr)
+    {
+        Initialize();
+    }
+}
+
+/*  @brief  Check whether the last Initialize() allocated the tensors and the model can be invoked.
+    */
+bool TFLM_Model::IsInitialized(void) const
+{
+    return input != nullptr && output != nullptr;
+}
+
 /*  @brief  Helper function to get the number of bytes in a tensor. Assumes tensor is type uint8. 
     @author Daniel Tan
     @return Void;
@@ -109,18 +217,51 @@ size_t compute_uint8_tensor_size(TfLiteTensor* tensor)
 }
 
 /*  @brief  Performs inference on data in input_buf and copies output to output_buf. 
+            For a batched model, input_buf is loaded into the first slot only, 
+            and the output of the first slot is returned.
     @author Daniel Tan
-    @return Void;
+    @return Pointer to the output tensor data, or nullptr if inference failed.
     */
 uint8_t* TFLM_Model::RunInference(uint8_t* input_buf)
 {
-    // Copy input buffer to model input. 
+    if (!LoadInput(0, input_buf) || !InvokeInterpreter())
+    {
+        return nullptr;
+    }
+    return output->data.uint8;
+}
+
+/*  @brief  Copy one window into a slot of the input tensor. 
+            The slot must be smaller than GetBatchSize(); 
+            each slot holds the same number of bytes as a batch-1 model input.
+            Prefer filling GetInput() in place, which avoids the copy.
+    @return True if the slot exists and the input tensor is allocated. 
+    */
+bool TFLM_Model::LoadInput(size_t slot, const uint8_t* input_buf)
+{
+    if (input == nullptr || slot >= batch_size)
+    {
+        return false;
+    }
     if (verbose) 
     {
-        TF_LITE_REPORT_ERROR(error_reporter, "Copying data to input tensor");
+        TF_LITE_REPORT_ERROR(error_reporter, "Copying data to input tensor slot %d", slot);
     }
-    for (size_t i = 0; i < input->bytes; ++i) {
-        input->data.uint8[i] = input_buf[i];
+    uint8_t* slot_data = input->data.uint8 + slot * input_item_bytes;
+    for (size_t i = 0; i < input_item_bytes; ++i) {
+        slot_data[i] = input_buf[i];
+    }
+    return true;
+}
+
+/*  @brief  Run the model on the current contents of the input tensor. 
+    @return True if inference succeeded.
+    */
+bool TFLM_Model::InvokeInterpreter(void)
+{
+    if (interpreter == nullptr || output == nullptr)
+    {
+        return false;
     }
 
     // Run inference, and report any error
@@ -133,9 +274,101 @@ uint8_t* TFLM_Model::RunInference(uint8_t* input_buf)
     if (invoke_status != kTfLiteOk) 
     {
         TF_LITE_REPORT_ERROR(error_reporter, "Invoke failed. A total of %d successful inferences\n", inference_count);
-        return nullptr;
+        return false;
     }
     inference_count++;
+    return true;
+}
 
-    return output->data.uint8;
+
+/*  @brief  Get the number of windows processed by one invoke.
+    @return Leading dimension of the model input, or 1 if the model is not batched.
+    */
+size_t TFLM_Model::GetBatchSize(void) const
+{
+    return batch_size;
+}
+
+/*  @brief  Get the number of output bytes produced for each input slot. 
+    */
+size_t TFLM_Model::GetOutputItemBytes(void) const
+{
+    return output_item_bytes;
+}
+
+/*  @brief  Get the number of tensor arena bytes used by the model. Only valid after Initialize().
+    */
+size_t TFLM_Model::GetArenaUsedBytes(void) const
+{
+    return interpreter == nullptr ? 0 : interpreter->arena_used_bytes();
+}
+
+/*  @brief  Measure the tensor arena use of the model by category, see ArenaSizer.h.
+            The interpreter is destroyed; call Initialize() again to run the model.
+    @return False if there is no model or it does not fit in the tensor arena.
+    */
+bool TFLM_Model::MeasureArena(arena_usage_t& usage)
+{
+    ClearMemory();
+    static tflite::MicroErrorReporter micro_error_reporter;
+    const tflite::MicroOpResolver* resolver = GetResolver(&micro_error_reporter);
+    if (model == nullptr || resolver == nullptr)
+    {
+        return false;
+    }
+    return ArenaSizer::Measure(model, *resolver, tensor_arena, kTensorArenaSize, &micro_error_reporter, usage);
+}
+
+/*  @brief  Get the height of one input slot in pixels. Only valid after Initialize().
+    */
+size_t TFLM_Model::GetInputHeight(void) const
+{
+    return input_height;
+}
+
+/*  @brief  Get the width of one input slot in pixels. Only valid after Initialize().
+    */
+size_t TFLM_Model::GetInputWidth(void) const
+{
+    return input_width;
+}
+
+/*  @brief  Get the number of cells scored for each input slot.
+    @return 1 for a window classifier, or the number of grid cells for a fully-convolutional model.
+    */
+size_t TFLM_Model::GetNumCells(void) const
+{
+    return num_cells;
+}
+
+/*  @brief  Get the number of class scores per cell.
+    */
+size_t TFLM_Model::GetNumClasses(void) const
+{
+    return num_classes;
+}
+
+/*  @brief  Get the type and quantisation of the output tensor. Only valid after Initialize().
+    */
+output_quant_t TFLM_Model::GetOutputQuant(void) const
+{
+    if (output == nullptr)
+    {
+        return {kTfLiteNoType, 0.0f, 0};
+    }
+    return {output->type, output->params.scale, output->params.zero_point};
+}
+
+/*  @brief  Get the class scores of one output item of the last invoke.
+    @param  index: Item index, slot * GetNumCells() + cell.
+    @return The scores, or an empty result if the item does not exist
+            or the output is not 8-bit quantised.
+    */
+InferenceResult TFLM_Model::GetResult(size_t index) const
+{
+    if (output == nullptr || num_classes == 0 || index >= batch_size * num_cells)
+    {
+        return InferenceResult();
+    }
+    return InferenceResult(GetOutputQuant(), output->data.raw + index * num_classes, num_classes);
 }
@@ -1,7 +1,7 @@
 # ifndef TFLM_MODEL_H
 # define TFLM_MODEL_H
 
-#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include <new>
 #include "tensorflow/lite/micro/micro_error_reporter.h"
 #include "tensorflow/lite/micro/micro_interpreter.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -9,6 +9,17 @@
 #include "tensorflow/lite/micro/testing/micro_test.h"
 
 #include "model/Base_Model.h"
+#include "model/TensorSpan.h"
+#include "model/ArenaSizer.h"
+#include "model/InferenceResult.h"
+
+// Tensor element type matching a C++ type, for the typed tensor accessors of TFLM_Model
+template <typename T> struct TfLiteTypeOf;
+template <> struct TfLiteTypeOf<int8_t> { static constexpr TfLiteType value = kTfLiteInt8; };
+template <> struct TfLiteTypeOf<uint8_t> { static constexpr TfLiteType value = kTfLiteUInt8; };
+template <> struct TfLiteTypeOf<int16_t> { static constexpr TfLiteType value = kTfLiteInt16; };
+template <> struct TfLiteTypeOf<int32_t> { static constexpr TfLiteType value = kTfLiteInt32; };
+template <> struct TfLiteTypeOf<float> { static constexpr TfLiteType value = kTfLiteFloat32; };
 
 class TFLM_Model : Base_Model
 {
@@ -18,38 +29,84 @@ class TFLM_Model : Base_Model
                     uint8_t* tensor_arena,
                     bool verbose = false):
             kTensorArenaSize(kTensorArenaSize),
-            model(tflite::GetModel(model_data)),
+            model(model_data == nullptr ? nullptr : tflite::GetModel(model_data)),
             tensor_arena(tensor_arena),
             verbose(verbose)
         {
             this->error_reporter = nullptr;
             this->interpreter = nullptr;
+            this->profiler = nullptr;
             this->input = nullptr;
             this->output = nullptr;
             this->inference_count = 0;
+            this->batch_size = 1;
+            this->input_item_bytes = 0;
+            this->output_item_bytes = 0;
+            this->input_height = 0;
+            this->input_width = 0;
+            this->num_cells = 0;
+            this->num_classes = 0;
         };
         ~TFLM_Model() {
             ClearMemory();
         }
 
-        /* @brief: Delete all objects created with 'new'
-         */
-        void ClearMemory(void) 
-        {
-
-        };
+        void ClearMemory(void);
+        void SetModel(const unsigned char* model_data);
+        void SetProfiler(tflite::Profiler* profiler);
+        bool IsInitialized(void) const;
 
         void Initialize(void);
         uint8_t* RunInference(uint8_t* input_buf);
 
+        // Batched inference, for models exported with batch dimension > 1
+        bool LoadInput(size_t slot, const uint8_t* input_buf);
+        size_t GetBatchSize(void) const;
+        size_t GetOutputItemBytes(void) const;
+        size_t GetArenaUsedBytes(void) const;
+        bool MeasureArena(arena_usage_t& usage);
+
+        // Zero-copy access to the tensors in the arena. T must match the tensor type, 
+        // otherwise an empty span is returned.
+        template <typename T> TensorSpan<T> GetInput(size_t slot);
+        template <typename T> TensorSpan<const T> GetOutput(void) const;
+        template <typename T> TensorSpan<const T> Invoke(void);
+
+        // Typed, quantisation-aware view of the output, see InferenceResult.h
+        output_quant_t GetOutputQuant(void) const;
+        InferenceResult GetResult(size_t index) const;
+
+        // Input and output layout, see Base_Model
+        size_t GetInputHeight(void) const;
+        size_t GetInputWidth(void) const;
+        size_t GetNumCells(void) const;
+        size_t GetNumClasses(void) const;
+
     private:
+        bool InvokeInterpreter(void);
+
         tflite::ErrorReporter* error_reporter;
         const tflite::Model* model;
         tflite::MicroInterpreter* interpreter;
+        tflite::Profiler* profiler;
+        // The interpreter is constructed in place here, so that every instance has its own
+        // and a new model can be loaded into the same arena without heap allocation
+        alignas(tflite::MicroInterpreter) uint8_t interpreter_storage[sizeof(tflite::MicroInterpreter)];
         TfLiteTensor* input;
         TfLiteTensor* output;
         int inference_count;
 
+        // Number of windows packed into one invoke, and bytes per window in the input / output tensors
+        size_t batch_size;
+        size_t input_item_bytes;
+        size_t output_item_bytes;
+
+        // Spatial size of one input slot, and cells x classes scores in one output slot
+        size_t input_height;
+        size_t input_width;
+        size_t num_cells;
+        size_t num_classes;
+
         // Create an area of memory to use for input, output, and intermediate arrays.
         // Minimum arena size, at the time of writing. After allocating tensors
         // you can retrieve this value by invoking interpreter.arena_used_bytes().
@@ -59,4 +116,48 @@ class TFLM_Model : Base_Model
         const bool verbose;
 };
 
+/*  @brief  Get one slot of the input tensor, to be filled in place instead of copied in with LoadInput().
+    @return Span of one batch item, or an empty span if the slot does not exist 
+            or the input tensor is not of type T.
+    */
+template <typename T>
+TensorSpan<T> TFLM_Model::GetInput(size_t slot)
+{
+    if (input == nullptr || slot >= batch_size || input->type != TfLiteTypeOf<T>::value)
+    {
+        return TensorSpan<T>();
+    }
+    size_t item_size = input_item_bytes / sizeof(T);
+    return TensorSpan<T>(reinterpret_cast<T*>(input->data.raw) + slot * item_size, item_size);
+}
+
+/*  @brief  Get the whole output tensor, for every slot. 
+            Output for slot i starts at element i * GetOutputItemBytes() / sizeof(T).
+    @return Span of the output tensor, or an empty span if it is not allocated or not of type T.
+    */
+template <typename T>
+TensorSpan<const T> TFLM_Model::GetOutput(void) const
+{
+    if (output == nullptr || output->type != TfLiteTypeOf<T>::value)
+    {
+        return TensorSpan<const T>();
+    }
+    return TensorSpan<const T>(reinterpret_cast<const T*>(output->data.raw), output->bytes / sizeof(T));
+}
+
+/*  @brief  Run the model on the current contents of the input tensor. 
+            Slots that were not filled since the last invoke hold stale data and should be ignored.
+    @return Span of the output tensor, or an empty span if inference failed 
+            or the output tensor is not of type T.
+    */
+template <typename T>
+TensorSpan<const T> TFLM_Model::Invoke(void)
+{
+    if (!InvokeInterpreter())
+    {
+        return TensorSpan<const T>();
+    }
+    return GetOutput<T>();
+}
+
 #endif //TFLM_MODEL_H
\ No newline at end of file
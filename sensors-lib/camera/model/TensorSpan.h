@@ -0,0 +1,59 @@
+# ifndef TENSOR_SPAN_H
+# define TENSOR_SPAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+/** TensorSpan class.
+ *  @brief  Typed, size-checked view over memory owned by someone else, 
+            usually a slot of a model input or output tensor inside the tensor arena.
+            A span never owns or copies its data. An empty span (size() == 0) 
+            signals that the requested tensor or slot does not exist or has a different type.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "TensorSpan.h"
+ *
+ *  int main()
+ *  {
+        TensorSpan<int8_t> input = model.GetInput<int8_t>(0);
+        if (input.size() == 96 * 96) {
+            fill_window(input.data());
+        }
+        TensorSpan<const int8_t> output = model.Invoke<int8_t>();
+        int8_t person = output.empty() ? 0 : output[1];
+ *  }
+ *  @endcode
+ */
+template <typename T>
+class TensorSpan {
+
+    public:
+        TensorSpan(void): data_(nullptr), size_(0) {}
+        TensorSpan(T* data, size_t size): data_(data), size_(data == nullptr ? 0 : size) {}
+
+        T* data(void) const { return data_; }
+        size_t size(void) const { return size_; }
+        size_t size_bytes(void) const { return size_ * sizeof(T); }
+        bool empty(void) const { return size_ == 0; }
+        T* begin(void) const { return data_; }
+        T* end(void) const { return data_ + size_; }
+        T& operator[](size_t idx) const { return data_[idx]; }
+
+        /*  @brief  Get count elements starting at offset.
+            @return An empty span if the range does not fit in this span.
+         */
+        TensorSpan<T> Slice(size_t offset, size_t count) const 
+        {
+            if (offset > size_ || count > size_ - offset) {
+                return TensorSpan<T>();
+            }
+            return TensorSpan<T>(data_ + offset, count);
+        }
+
+    private:
+        T* data_;
+        size_t size_;
+};
+
+# endif // TENSOR_SPAN_H
@@ -0,0 +1,19 @@
+// Generated by tools/arena_sizer (32-bit host) with:
+//   sensors-lib/camera/model_data/person_detection_int8/model_data.cc: 109792 bytes
+//     head (tensor data and scratch buffers): 55296
+//     tail (persistent): 54496
+//       TfLiteTensor structs and quantization: 29136
+//       node and registration structs: 1240
+//       operator data: 808
+//       variable tensors: 0
+//       allocator bookkeeping: 23312
+// Do not edit; rerun the tool when a model changes.
+# ifndef MODEL_ARENA_SIZE_H
+# define MODEL_ARENA_SIZE_H
+
+// Tensor arena bytes needed by the largest model
+constexpr int kModelArenaSize = 109792;
+// Free bytes kept after the largest model
+constexpr int kModelArenaHeadroom = 500;
+
+# endif // MODEL_ARENA_SIZE_H
@@ -0,0 +1,23 @@
+// Generated by tools/make_op_resolver.py from:
+//   sensors-lib/camera/model_data/person_detection_int8/model_data.cc
+// Do not edit; rerun the tool when a model changes.
+# ifndef MODEL_OP_RESOLVER_H
+# define MODEL_OP_RESOLVER_H
+
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+
+// Builtin ops used by the models: AVERAGE_POOL_2D, CONV_2D, DEPTHWISE_CONV_2D, RESHAPE, SOFTMAX
+constexpr unsigned int kModelOpCount = 5;
+typedef tflite::MicroMutableOpResolver<kModelOpCount> ModelOpResolver;
+
+inline TfLiteStatus RegisterModelOps(ModelOpResolver& resolver)
+{
+    TF_LITE_ENSURE_STATUS(resolver.AddAveragePool2D());
+    TF_LITE_ENSURE_STATUS(resolver.AddConv2D());
+    TF_LITE_ENSURE_STATUS(resolver.AddDepthwiseConv2D());
+    TF_LITE_ENSURE_STATUS(resolver.AddReshape());
+    TF_LITE_ENSURE_STATUS(resolver.AddSoftmax());
+    return kTfLiteOk;
+}
+
+# endif // MODEL_OP_RESOLVER_H
@@ -0,0 +1,89 @@
+# include "camera/window/EdgeFilter.h"
+
+/*  @brief  Initialize the filter with empty statistics.
+    @param  threshold: Minimum edge energy for a window to pass. 0 passes every window.
+ */
+EdgeFilter::EdgeFilter(uint32_t threshold):
+    threshold_(threshold),
+    num_tested_(0),
+    num_passed_(0)
+{
+}
+
+/*  @brief  Compute the edge energy of a grayscale window.
+            Energy is the mean of |dx| + |dy| over sampled pixels,
+            so it is in grey levels and independent of the window size.
+    @param  buf:    Row-major grayscale window.
+            height: Window height in pixels.
+            width:  Window width in pixels.
+    @return Edge energy in [0, 510].
+ */
+uint32_t EdgeFilter::Measure(const uint8_t* buf, size_t height, size_t width) const
+{
+    if (height < 2 || width < 2) {
+        return 0;
+    }
+    uint32_t sum = 0;
+    uint32_t count = 0;
+    for (size_t row = 0; row + 1 < height; row += SAMPLE_STEP) {
+        const uint8_t* line = buf + row * width;
+        const uint8_t* next = line + width;
+        for (size_t col = 0; col + 1 < width; col += SAMPLE_STEP) {
+            int dx = (int)line[col + 1] - (int)line[col];
+            int dy = (int)next[col] - (int)line[col];
+            sum += (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+            count++;
+        }
+    }
+    return sum / count;
+}
+
+/*  @brief  Test a window against the threshold and update the pass statistics.
+    @return True if the window should be passed on to the next stage.
+ */
+bool EdgeFilter::Pass(const uint8_t* buf, size_t height, size_t width)
+{
+    num_tested_++;
+    // Skip the measurement entirely when the filter is disabled
+    bool pass = (threshold_ == 0) || (Measure(buf, height, width) >= threshold_);
+    if (pass) {
+        num_passed_++;
+    }
+    return pass;
+}
+
+/*  @brief  Change the rejection threshold. Statistics are kept.
+ */
+void EdgeFilter::SetThreshold(uint32_t threshold)
+{
+    threshold_ = threshold;
+}
+
+/*  @brief  Get the current rejection threshold.
+ */
+uint32_t EdgeFilter::GetThreshold(void) const
+{
+    return threshold_;
+}
+
+/*  @brief  Clear the tested and passed window counts.
+ */
+void EdgeFilter::ResetStats(void)
+{
+    num_tested_ = 0;
+    num_passed_ = 0;
+}
+
+/*  @brief  Get the number of windows tested since the last ResetStats().
+ */
+size_t EdgeFilter::GetNumTested(void) const
+{
+    return num_tested_;
+}
+
+/*  @brief  Get the number of windows passed since the last ResetStats().
+ */
+size_t EdgeFilter::GetNumPassed(void) const
+{
+    return num_passed_;
+}
@@ -0,0 +1,53 @@
+# ifndef EDGE_FILTER_H
+# define EDGE_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/** EdgeFilter class.
+ *  @brief  Integer pre-filter for the detection cascade.
+            Measures the mean absolute gradient (edge energy) of a grayscale window,
+            and rejects windows whose energy is below a threshold.
+            Flat windows, e.g. empty floor, walls or an over-exposed patch,
+            are rejected before they reach the much more expensive person-detect model.
+            A threshold of 0 disables the filter.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "EdgeFilter.h"
+ *
+ *  int main()
+ *  {
+        EdgeFilter filter(4);
+        // window_buf is a 96 x 96 grayscale window
+        if (filter.Pass(window_buf, 96, 96)) {
+            // Run the model on window_buf
+        }
+        printf("%d of %d windows passed", filter.GetNumPassed(), filter.GetNumTested());
+ *  }
+ *  @endcode
+ */
+class EdgeFilter {
+
+    public:
+        // Pixels are sampled every SAMPLE_STEP rows and cols to bound the cost per window
+        static constexpr size_t SAMPLE_STEP = 2;
+
+        EdgeFilter(uint32_t threshold);
+
+        uint32_t Measure(const uint8_t* buf, size_t height, size_t width) const;
+        bool Pass(const uint8_t* buf, size_t height, size_t width);
+
+        void SetThreshold(uint32_t threshold);
+        uint32_t GetThreshold(void) const;
+        void ResetStats(void);
+        size_t GetNumTested(void) const;
+        size_t GetNumPassed(void) const;
+
+    private:
+        uint32_t threshold_;
+        size_t num_tested_;
+        size_t num_passed_;
+};
+
+# endif // EDGE_FILTER_H
@@ -0,0 +1,177 @@
+# include "camera/window/OccupancyTracker.h"
+
+/*  @brief  Initialize the tracker with every cell unobserved.
+ */
+OccupancyTracker::OccupancyTracker(const tracker_config_t& config):
+    config_(config)
+{
+    Reset();
+}
+
+/*  @brief  Get the default tuning.
+            A confident observation is trusted for about five frames,
+            and a single confident score is enough to flip the occupied state.
+ */
+tracker_config_t OccupancyTracker::DefaultConfig(void)
+{
+    tracker_config_t config;
+    config.ema_alpha = 160;
+    config.decay = 192;
+    config.reinfer_confidence = 64;
+    config.motion_threshold = 8;
+    config.occupied_on = 136;
+    config.occupied_off = 120;
+    return config;
+}
+
+/*  @brief  Change the tuning. Cell state is kept.
+ */
+void OccupancyTracker::SetConfig(const tracker_config_t& config)
+{
+    config_ = config;
+}
+
+/*  @brief  Get the current tuning.
+ */
+const tracker_config_t& OccupancyTracker::GetConfig(void) const
+{
+    return config_;
+}
+
+/*  @brief  Forget every cell, e.g. after the window geometry changes.
+ */
+void OccupancyTracker::Reset(void)
+{
+    for (size_t cell = 0; cell < MAX_CELLS; cell++) {
+        cells_[cell].valid = false;
+        cells_[cell].occupied = false;
+        cells_[cell].has_thumb = false;
+        cells_[cell].ema = 0;
+        cells_[cell].confidence = 0;
+        for (size_t i = 0; i < THUMB_BYTES; i++) {
+            cells_[cell].thumb[i] = 0;
+        }
+    }
+}
+
+/*  @brief  Decay the confidence of every cell. Call once at the start of each frame.
+ */
+void OccupancyTracker::BeginFrame(void)
+{
+    for (size_t cell = 0; cell < MAX_CELLS; cell++) {
+        cells_[cell].confidence = (cells_[cell].confidence * config_.decay) >> 8;
+    }
+}
+
+/*  @brief  Reduce a grayscale window to THUMB_SIZE x THUMB_SIZE block means,
+            sampling every other pixel of each block.
+ */
+void OccupancyTracker::Thumbnail(const uint8_t* window, size_t height, size_t width, uint8_t* thumb)
+{
+    size_t block_h = height / THUMB_SIZE;
+    size_t block_w = width / THUMB_SIZE;
+    for (size_t br = 0; br < THUMB_SIZE; br++) {
+        for (size_t bc = 0; bc < THUMB_SIZE; bc++) {
+            uint32_t sum = 0;
+            uint32_t count = 0;
+            for (size_t row = br * block_h; row < (br + 1) * block_h; row += 2) {
+                const uint8_t* line = window + row * width;
+                for (size_t col = bc * block_w; col < (bc + 1) * block_w; col += 2) {
+                    sum += line[col];
+                    count++;
+                }
+            }
+            thumb[br * THUMB_SIZE + bc] = count ? sum / count : 0;
+        }
+    }
+}
+
+/*  @brief  Decide whether a cell must be run through the model this frame,
+            and remember its thumbnail for the next motion check.
+    @param  cell:   Row-major cell index.
+            window: Grayscale window of the cell for the current frame.
+            height: Window height in pixels.
+            width:  Window width in pixels.
+    @return True if the cell was never observed, its confidence has decayed below
+            reinfer_confidence, or its content moved by more than motion_threshold.
+ */
+bool OccupancyTracker::NeedsInference(size_t cell, const uint8_t* window, size_t height, size_t width)
+{
+    if (cell >= MAX_CELLS) {
+        return true;
+    }
+    cell_state_t& state = cells_[cell];
+    uint8_t thumb[THUMB_BYTES];
+    Thumbnail(window, height, width, thumb);
+
+    uint32_t diff = 0;
+    for (size_t i = 0; i < THUMB_BYTES; i++) {
+        int d = (int)thumb[i] - (int)state.thumb[i];
+        diff += (d < 0) ? -d : d;
+    }
+    bool motion = !state.has_thumb || (diff / THUMB_BYTES) >= config_.motion_threshold;
+    for (size_t i = 0; i < THUMB_BYTES; i++) {
+        state.thumb[i] = thumb[i];
+    }
+    state.has_thumb = true;
+
+    return !state.valid || motion || state.confidence < config_.reinfer_confidence;
+}
+
+/*  @brief  Fold a new observation into a cell and restore its confidence.
+    @param  cell:  Row-major cell index.
+            score: Person score margin in [-255, 255].
+ */
+void OccupancyTracker::Update(size_t cell, int16_t score)
+{
+    if (cell >= MAX_CELLS) {
+        return;
+    }
+    cell_state_t& state = cells_[cell];
+    // Map the margin onto [0, 255], with 128 as the decision boundary
+    int p = (score + 256) / 2;
+    p = (p < 0) ? 0 : (p > 255 ? 255 : p);
+
+    if (!state.valid) {
+        state.ema = p;
+        state.valid = true;
+    } else {
+        state.ema += ((p - (int)state.ema) * config_.ema_alpha) / 256;
+    }
+    if (!state.occupied && state.ema >= config_.occupied_on) {
+        state.occupied = true;
+    } else if (state.occupied && state.ema <= config_.occupied_off) {
+        state.occupied = false;
+    }
+    state.confidence = 255;
+}
+
+/*  @brief  Get the smoothed score of a cell, clamped to the side of the decision boundary
+            given by its hysteresis state.
+    @return Person score margin, >= 0 if the cell is occupied, or NO_SCORE if never observed.
+ */
+int16_t OccupancyTracker::GetScore(size_t cell) const
+{
+    if (cell >= MAX_CELLS || !cells_[cell].valid) {
+        return NO_SCORE;
+    }
+    int16_t score = 2 * (int16_t)cells_[cell].ema - 255;
+    if (cells_[cell].occupied) {
+        return (score < 0) ? 0 : score;
+    }
+    return (score >= 0) ? -1 : score;
+}
+
+/*  @brief  Get the hysteresis state of a cell.
+ */
+bool OccupancyTracker::IsOccupied(size_t cell) const
+{
+    return (cell < MAX_CELLS) && cells_[cell].occupied;
+}
+
+/*  @brief  Get the remaining confidence of a cell, 255 right after an observation.
+ */
+uint8_t OccupancyTracker::GetConfidence(size_t cell) const
+{
+    return (cell < MAX_CELLS) ? cells_[cell].confidence : 0;
+}
@@ -0,0 +1,92 @@
+# ifndef OCCUPANCY_TRACKER_H
+# define OCCUPANCY_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*  Tracker tuning. All fields are in 1/256 units unless noted.
+    ema_alpha:          Weight of a new observation in the smoothed score.
+    decay:              Confidence is multiplied by decay / 256 every frame. 0 re-infers every cell every frame.
+    reinfer_confidence: A cell is re-inferred once its confidence drops below this value.
+    motion_threshold:   A cell is re-inferred if its thumbnail changed by more than this
+                        mean absolute difference, in grey levels. 0 re-infers every cell every frame.
+    occupied_on:        Smoothed score at or above which a free cell becomes occupied.
+    occupied_off:       Smoothed score at or below which an occupied cell becomes free.
+ */
+typedef struct {
+    uint8_t ema_alpha;
+    uint8_t decay;
+    uint8_t reinfer_confidence;
+    uint8_t motion_threshold;
+    uint8_t occupied_on;
+    uint8_t occupied_off;
+} tracker_config_t;
+
+/** OccupancyTracker class.
+ *  @brief  Fixed-memory temporal filter over the window grid.
+            Each cell keeps an exponential moving average of its person score,
+            a hysteresis occupied / free state, a confidence that decays every frame,
+            and a small thumbnail of the last window seen.
+            A cell only needs to go through the model again when its confidence has decayed
+            or its thumbnail shows motion; otherwise its smoothed score is reused.
+            Scores are person score margins as used by ScoreGrid, with >= 0 meaning a person.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "OccupancyTracker.h"
+ *
+ *  int main()
+ *  {
+        OccupancyTracker tracker(OccupancyTracker::DefaultConfig());
+        // Once per frame
+        tracker.BeginFrame();
+        // For each window; window_buf is a 96 x 96 grayscale window of cell 3
+        if (tracker.NeedsInference(3, window_buf, 96, 96)) {
+            tracker.Update(3, person_score_margin);
+        }
+        int16_t score = tracker.GetScore(3);
+ *  }
+ *  @endcode
+ */
+class OccupancyTracker {
+
+    public:
+        static constexpr size_t MAX_CELLS = 64;
+        // Thumbnails are THUMB_SIZE x THUMB_SIZE block means of the window
+        static constexpr size_t THUMB_SIZE = 4;
+        static constexpr size_t THUMB_BYTES = THUMB_SIZE * THUMB_SIZE;
+        // Score of a cell that has never been observed
+        static constexpr int16_t NO_SCORE = INT16_MIN;
+
+        OccupancyTracker(const tracker_config_t& config);
+
+        static tracker_config_t DefaultConfig(void);
+        void SetConfig(const tracker_config_t& config);
+        const tracker_config_t& GetConfig(void) const;
+
+        void Reset(void);
+        void BeginFrame(void);
+        bool NeedsInference(size_t cell, const uint8_t* window, size_t height, size_t width);
+        void Update(size_t cell, int16_t score);
+
+        int16_t GetScore(size_t cell) const;
+        bool IsOccupied(size_t cell) const;
+        uint8_t GetConfidence(size_t cell) const;
+
+    private:
+        typedef struct {
+            bool valid;
+            bool occupied;
+            bool has_thumb;
+            uint8_t ema;
+            uint8_t confidence;
+            uint8_t thumb[THUMB_BYTES];
+        } cell_state_t;
+
+        tracker_config_t config_;
+        cell_state_t cells_[MAX_CELLS];
+
+        static void Thumbnail(const uint8_t* window, size_t height, size_t width, uint8_t* thumb);
+};
+
+# endif // OCCUPANCY_TRACKER_H
@@ -0,0 +1,168 @@
+# include "camera/window/ResultCache.h"
+
+/*  @brief  Initialize an empty cache.
+    @param  capacity:     Number of entries in use, at most MAX_ENTRIES. 0 disables the cache.
+            max_distance: Largest Hamming distance between hashes that still counts as a hit.
+ */
+ResultCache::ResultCache(size_t capacity, size_t max_distance):
+    capacity_(capacity > MAX_ENTRIES ? MAX_ENTRIES : capacity),
+    max_distance_(max_distance),
+    clock_(0),
+    num_lookups_(0),
+    num_hits_(0)
+{
+    Clear();
+}
+
+/*  @brief  Compute the 64-bit difference hash of a grayscale window.
+            Block means are taken over every other pixel of each block.
+    @param  window: Row-major grayscale window, at least 9 pixels wide and 8 pixels high.
+            height: Window height in pixels.
+            width:  Window width in pixels.
+ */
+uint64_t ResultCache::Hash(const uint8_t* window, size_t height, size_t width)
+{
+    uint64_t hash = 0;
+    for (size_t br = 0; br < 8; br++) {
+        size_t row_begin = br * height / 8;
+        size_t row_end = (br + 1) * height / 8;
+        uint32_t prev = 0;
+        for (size_t bc = 0; bc < 9; bc++) {
+            size_t col_begin = bc * width / 9;
+            size_t col_end = (bc + 1) * width / 9;
+            uint32_t sum = 0;
+            uint32_t count = 0;
+            for (size_t row = row_begin; row < row_end; row += 2) {
+                const uint8_t* line = window + row * width;
+                for (size_t col = col_begin; col < col_end; col += 2) {
+                    sum += line[col];
+                    count++;
+                }
+            }
+            uint32_t mean = count ? sum / count : 0;
+            if (bc > 0) {
+                hash = (hash << 1) | (prev > mean ? 1 : 0);
+            }
+            prev = mean;
+        }
+    }
+    return hash;
+}
+
+/*  @brief  Count the differing bits of two hashes.
+ */
+size_t ResultCache::Distance(uint64_t a, uint64_t b)
+{
+    size_t count = 0;
+    for (uint64_t diff = a ^ b; diff != 0; diff &= diff - 1) {
+        count++;
+    }
+    return count;
+}
+
+/*  @brief  Find the closest cached hash within max_distance and mark it as recently used.
+    @param  hash:  Hash of the window to look up.
+            score: Set to the cached score on a hit.
+    @return True on a cache hit.
+ */
+bool ResultCache::Lookup(uint64_t hash, int16_t& score)
+{
+    if (capacity_ == 0) {
+        return false;
+    }
+    num_lookups_++;
+    size_t best = capacity_;
+    size_t best_distance = max_distance_ + 1;
+    for (size_t i = 0; i < capacity_; i++) {
+        if (!entries_[i].valid) {
+            continue;
+        }
+        size_t distance = Distance(hash, entries_[i].hash);
+        if (distance < best_distance) {
+            best = i;
+            best_distance = distance;
+        }
+    }
+    if (best == capacity_) {
+        return false;
+    }
+    entries_[best].last_used = ++clock_;
+    score = entries_[best].score;
+    num_hits_++;
+    return true;
+}
+
+/*  @brief  Store a score, replacing an empty or the least recently used entry.
+ */
+void ResultCache::Insert(uint64_t hash, int16_t score)
+{
+    if (capacity_ == 0) {
+        return;
+    }
+    size_t victim = 0;
+    for (size_t i = 0; i < capacity_; i++) {
+        if (!entries_[i].valid) {
+            victim = i;
+            break;
+        }
+        if (entries_[i].last_used < entries_[victim].last_used) {
+            victim = i;
+        }
+    }
+    entries_[victim].hash = hash;
+    entries_[victim].score = score;
+    entries_[victim].last_used = ++clock_;
+    entries_[victim].valid = true;
+}
+
+/*  @brief  Change the number of entries in use and empty the cache.
+    @return False, leaving the cache unchanged, if capacity exceeds MAX_ENTRIES.
+ */
+bool ResultCache::SetCapacity(size_t capacity)
+{
+    if (capacity > MAX_ENTRIES) {
+        return false;
+    }
+    capacity_ = capacity;
+    Clear();
+    return true;
+}
+
+/*  @brief  Get the number of entries in use.
+ */
+size_t ResultCache::GetCapacity(void) const
+{
+    return capacity_;
+}
+
+/*  @brief  Remove every entry, e.g. after the model changes.
+ */
+void ResultCache::Clear(void)
+{
+    for (size_t i = 0; i < MAX_ENTRIES; i++) {
+        entries_[i].valid = false;
+        entries_[i].last_used = 0;
+    }
+}
+
+/*  @brief  Clear the lookup and hit counts.
+ */
+void ResultCache::ResetStats(void)
+{
+    num_lookups_ = 0;
+    num_hits_ = 0;
+}
+
+/*  @brief  Get the number of lookups since the last ResetStats(), excluding lookups while disabled.
+ */
+size_t ResultCache::GetNumLookups(void) const
+{
+    return num_lookups_;
+}
+
+/*  @brief  Get the number of hits since the last ResetStats().
+ */
+size_t ResultCache::GetNumHits(void) const
+{
+    return num_hits_;
+}
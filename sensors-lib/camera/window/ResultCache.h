@@ -0,0 +1,68 @@
+# ifndef RESULT_CACHE_H
+# define RESULT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/** ResultCache class.
+ *  @brief  Small LRU cache of model scores keyed by a 64-bit perceptual hash of the window.
+            The hash is a difference hash (dHash): the window is reduced to 9 x 8 block means
+            and each bit records whether a block is brighter than its right neighbour.
+            It ignores uniform brightness changes, so windows that only drift in lighting
+            still hit the cache, while a person entering the window changes many bits.
+            Entries live in a fixed static buffer of MAX_ENTRIES; the number in use is configurable.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "ResultCache.h"
+ *
+ *  int main()
+ *  {
+        ResultCache cache(16, 2);
+        // window_buf is a 96 x 96 grayscale window
+        uint64_t hash = ResultCache::Hash(window_buf, 96, 96);
+        int16_t score;
+        if (!cache.Lookup(hash, score)) {
+            score = run_model(window_buf);
+            cache.Insert(hash, score);
+        }
+ *  }
+ *  @endcode
+ */
+class ResultCache {
+
+    public:
+        static constexpr size_t MAX_ENTRIES = 32;
+
+        ResultCache(size_t capacity, size_t max_distance);
+
+        static uint64_t Hash(const uint8_t* window, size_t height, size_t width);
+        bool Lookup(uint64_t hash, int16_t& score);
+        void Insert(uint64_t hash, int16_t score);
+
+        bool SetCapacity(size_t capacity);
+        size_t GetCapacity(void) const;
+        void Clear(void);
+        void ResetStats(void);
+        size_t GetNumLookups(void) const;
+        size_t GetNumHits(void) const;
+
+    private:
+        typedef struct {
+            uint64_t hash;
+            uint32_t last_used;
+            int16_t score;
+            bool valid;
+        } entry_t;
+
+        entry_t entries_[MAX_ENTRIES];
+        size_t capacity_;
+        size_t max_distance_;
+        uint32_t clock_;
+        size_t num_lookups_;
+        size_t num_hits_;
+
+        static size_t Distance(uint64_t a, uint64_t b);
+};
+
+# endif // RESULT_CACHE_H
@@ -0,0 +1,213 @@
+# include "camera/window/ScoreGrid.h"
+
+/*  @brief  Initialize an empty 0 x 0 grid. Configure() must be called before use.
+ */
+ScoreGrid::ScoreGrid(void):
+    rows_(0),
+    cols_(0),
+    num_offsets_(0),
+    positive_mask_(0),
+    peak_mask_(0)
+{
+    Clear();
+}
+
+/*  @brief  Set the grid size and precompute the suppression neighbourhood.
+            Two windows of the same length whose top-left corners are (dr, dc) cells apart
+            overlap by (length - |dr| * stride) * (length - |dc| * stride) pixels.
+            They are neighbours if their intersection over union is at least iou_q8 / 256.
+            Neighbours further than MAX_RADIUS cells apart are ignored.
+    @param  rows, cols: Size of the window grid.
+            length:     Window side length.
+            stride:     Distance between neighbouring windows. stride >= length disables suppression.
+            iou_q8:     Minimum IoU for suppression, in 1/256 units.
+    @return False, leaving the grid unchanged, if the grid has more than MAX_CELLS cells.
+ */
+bool ScoreGrid::Configure(size_t rows, size_t cols, size_t length, size_t stride, uint32_t iou_q8)
+{
+    if (rows * cols > MAX_CELLS || stride == 0) {
+        return false;
+    }
+    rows_ = rows;
+    cols_ = cols;
+    num_offsets_ = 0;
+    uint64_t area = (uint64_t)length * length;
+    for (int dr = -MAX_RADIUS; dr <= MAX_RADIUS; dr++) {
+        for (int dc = -MAX_RADIUS; dc <= MAX_RADIUS; dc++) {
+            size_t shift_r = (dr < 0 ? -dr : dr) * stride;
+            size_t shift_c = (dc < 0 ? -dc : dc) * stride;
+            if ((dr == 0 && dc == 0) || shift_r >= length || shift_c >= length) {
+                continue;
+            }
+            uint64_t inter = (uint64_t)(length - shift_r) * (length - shift_c);
+            uint64_t uni = 2 * area - inter;
+            if (inter * 256 >= iou_q8 * uni) {
+                offsets_[num_offsets_].row = dr;
+                offsets_[num_offsets_].col = dc;
+                num_offsets_++;
+            }
+        }
+    }
+    Clear();
+    return true;
+}
+
+/*  @brief  Reset every cell to NO_SCORE, e.g. at the start of a frame.
+ */
+void ScoreGrid::Clear(void)
+{
+    for (size_t cell = 0; cell < MAX_CELLS; cell++) {
+        scores_[cell] = NO_SCORE;
+    }
+    positive_mask_ = 0;
+    peak_mask_ = 0;
+}
+
+/*  @brief  Record the score of one cell for the current frame.
+    @param  cell:  Row-major cell index.
+            score: Person score margin; the cell is positive if score >= 0.
+ */
+void ScoreGrid::SetScore(size_t cell, int16_t score)
+{
+    if (cell < MAX_CELLS) {
+        scores_[cell] = score;
+    }
+}
+
+/*  @brief  Check whether a cell wins against a neighbour. Ties go to the lower cell index,
+            so that two equal neighbouring peaks are counted once.
+ */
+bool ScoreGrid::Beats(size_t cell, size_t other) const
+{
+    return (scores_[cell] > scores_[other]) || (scores_[cell] == scores_[other] && cell < other);
+}
+
+/*  @brief  Find the positive cells that beat every neighbour in their suppression neighbourhood.
+            This is peak merging rather than greedy NMS: a cell suppressed by a stronger
+            neighbour can still suppress its own weaker neighbours.
+    @return Number of peaks, i.e. the number of people in the frame.
+ */
+size_t ScoreGrid::Suppress(void)
+{
+    positive_mask_ = 0;
+    peak_mask_ = 0;
+    size_t num_peaks = 0;
+    for (size_t row = 0; row < rows_; row++) {
+        for (size_t col = 0; col < cols_; col++) {
+            size_t cell = row * cols_ + col;
+            if (scores_[cell] < 0) {
+                continue;
+            }
+            positive_mask_ |= (uint64_t)1 << cell;
+            bool peak = true;
+            for (size_t i = 0; i < num_offsets_ && peak; i++) {
+                int r = (int)row + offsets_[i].row;
+                int c = (int)col + offsets_[i].col;
+                if (r < 0 || c < 0 || r >= (int)rows_ || c >= (int)cols_) {
+                    continue;
+                }
+                peak = Beats(cell, r * cols_ + c);
+            }
+            if (peak) {
+                peak_mask_ |= (uint64_t)1 << cell;
+                num_peaks++;
+            }
+        }
+    }
+    return num_peaks;
+}
+
+/*  @brief  Get the score recorded for a cell in the current frame, or NO_SCORE.
+ */
+int16_t ScoreGrid::GetScore(size_t cell) const
+{
+    return (cell < MAX_CELLS) ? scores_[cell] : NO_SCORE;
+}
+
+/*  @brief  Get a bitmask of the positive cells found by the last Suppress().
+ */
+uint64_t ScoreGrid::GetPositiveMask(void) const
+{
+    return positive_mask_;
+}
+
+/*  @brief  Get a bitmask of the peak cells found by the last Suppress().
+ */
+uint64_t ScoreGrid::GetPeakMask(void) const
+{
+    return peak_mask_;
+}
+
+/*  @brief  Get the number of positive cells found by the last Suppress(), before suppression.
+ */
+size_t ScoreGrid::GetNumPositive(void) const
+{
+    size_t count = 0;
+    for (uint64_t mask = positive_mask_; mask != 0; mask &= mask - 1) {
+        count++;
+    }
+    return count;
+}
+
+/*  @brief  Get the number of cells in the grid.
+ */
+size_t ScoreGrid::GetNumCells(void) const
+{
+    return rows_ * cols_;
+}
+
+/*  @brief  Get the number of rows in the grid.
+ */
+size_t ScoreGrid::GetRows(void) const
+{
+    return rows_;
+}
+
+/*  @brief  Get the number of cols in the grid.
+ */
+size_t ScoreGrid::GetCols(void) const
+{
+    return cols_;
+}
+
+/*  @brief  Quantise a person score margin to 4 bits.
+    @return 0 for NO_SCORE, else 1 to 15 over [-255, 255]. Values of 8 and above are positive scores.
+ */
+uint8_t ScoreGrid::QuantiseScore(int16_t score)
+{
+    if (score == NO_SCORE) {
+        return 0;
+    }
+    int clamped = (score < -255) ? -255 : (score > 255 ? 255 : score);
+    return 1 + ((clamped + 256) * 14) / 511;
+}
+
+/*  @brief  Serialise the grid as of the last Suppress() into a compact byte layout, see ScoreGrid.h.
+    @param  buf: Output buffer, MAX_PACKED_BYTES is always enough.
+            len: Size of buf in bytes.
+    @return Number of bytes written, or 0 if buf is too small.
+ */
+size_t ScoreGrid::Pack(uint8_t* buf, size_t len) const
+{
+    size_t num_cells = GetNumCells();
+    size_t mask_bytes = (num_cells + 7) / 8;
+    size_t score_bytes = (num_cells + 1) / 2;
+    size_t size = 2 + mask_bytes + score_bytes;
+    if (len < size) {
+        return 0;
+    }
+    buf[0] = rows_;
+    buf[1] = cols_;
+    uint8_t* mask = buf + 2;
+    uint8_t* scores = mask + mask_bytes;
+    for (size_t i = 0; i < mask_bytes; i++) {
+        mask[i] = (peak_mask_ >> (8 * i)) & 0xFF;
+    }
+    for (size_t i = 0; i < score_bytes; i++) {
+        scores[i] = 0;
+    }
+    for (size_t cell = 0; cell < num_cells; cell++) {
+        scores[cell / 2] |= QuantiseScore(scores_[cell]) << (4 * (cell % 2));
+    }
+    return size;
+}
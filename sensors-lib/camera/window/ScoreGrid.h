@@ -0,0 +1,82 @@
+# ifndef SCORE_GRID_H
+# define SCORE_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+
+/** ScoreGrid class.
+ *  @brief  Per-frame person scores over the window grid, with peak-merge
+            non-maximum suppression for overlapping windows.
+            When the window stride is smaller than the window length, one person
+            is seen by several neighbouring windows. Suppress() keeps only positive
+            cells that are the local maximum among all neighbours whose windows
+            overlap them by at least the IoU threshold, so each person is counted once.
+            The neighbourhood is precomputed by Configure(), so Suppress() is O(cells)
+            for a given window geometry and uses no memory beyond the fixed cell buffer.
+            Pack() serialises the grid for telemetry in 2 + ceil(cells / 8) + ceil(cells / 2) bytes:
+            the row and col counts, the peak bitmask (cell 0 in bit 0 of the first byte),
+            then one 4-bit quantised score per cell (cell 0 in the low nibble).
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "ScoreGrid.h"
+ *
+ *  int main()
+ *  {
+        ScoreGrid grid;
+        // 5 x 7 windows of length 80 with stride 40, suppress at IoU >= 0.3
+        grid.Configure(5, 7, 80, 40, 77);
+        grid.Clear();
+        grid.SetScore(8, 120);
+        grid.SetScore(9, 30);
+        size_t count = grid.Suppress(); // 1, cell 9 overlaps cell 8
+ *  }
+ *  @endcode
+ */
+class ScoreGrid {
+
+    public:
+        static constexpr size_t MAX_CELLS = 64;
+        // Largest neighbourhood is (2 * MAX_RADIUS + 1)^2 cells, including the centre
+        static constexpr int MAX_RADIUS = 3;
+        // Score of a cell that was not run through the model
+        static constexpr int16_t NO_SCORE = INT16_MIN;
+        // Largest output of Pack()
+        static constexpr size_t MAX_PACKED_BYTES = 2 + MAX_CELLS / 8 + MAX_CELLS / 2;
+
+        ScoreGrid(void);
+
+        bool Configure(size_t rows, size_t cols, size_t length, size_t stride, uint32_t iou_q8);
+        void Clear(void);
+        void SetScore(size_t cell, int16_t score);
+        size_t Suppress(void);
+
+        int16_t GetScore(size_t cell) const;
+        uint64_t GetPositiveMask(void) const;
+        uint64_t GetPeakMask(void) const;
+        size_t GetNumPositive(void) const;
+        size_t GetNumCells(void) const;
+        size_t GetRows(void) const;
+        size_t GetCols(void) const;
+
+        size_t Pack(uint8_t* buf, size_t len) const;
+        static uint8_t QuantiseScore(int16_t score);
+
+    private:
+        typedef struct {
+            int8_t row;
+            int8_t col;
+        } offset_t;
+
+        size_t rows_;
+        size_t cols_;
+        size_t num_offsets_;
+        int16_t scores_[MAX_CELLS];
+        offset_t offsets_[(2 * MAX_RADIUS + 1) * (2 * MAX_RADIUS + 1)];
+        uint64_t positive_mask_;
+        uint64_t peak_mask_;
+
+        bool Beats(size_t cell, size_t other) const;
+};
+
+# endif // SCORE_GRID_H
@@ -0,0 +1,83 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/window/EdgeFilter.h"
+
+using namespace utest::v1;
+
+static constexpr size_t length = 96;
+static uint8_t window_buf[length * length];
+
+// Test that a flat window has zero energy and is rejected
+static control_t edge_filter_test_1(const size_t call_count)
+{
+    for (size_t i = 0; i < sizeof(window_buf); i++) {
+        window_buf[i] = 128;
+    }
+    EdgeFilter filter(1);
+    TEST_ASSERT_EQUAL_UINT32(0, filter.Measure(window_buf, length, length));
+    TEST_ASSERT_FALSE(filter.Pass(window_buf, length, length));
+    TEST_ASSERT_EQUAL_UINT(1, filter.GetNumTested());
+    TEST_ASSERT_EQUAL_UINT(0, filter.GetNumPassed());
+    return CaseNext;
+}
+
+// Test energy of a vertical stripe pattern against the threshold
+static control_t edge_filter_test_2(const size_t call_count)
+{
+    // Alternate 0 and 40 every column, so every sampled |dx| is 40 and every |dy| is 0
+    for (size_t row = 0; row < length; row++) {
+        for (size_t col = 0; col < length; col++) {
+            window_buf[row * length + col] = (col % 2) ? 40 : 0;
+        }
+    }
+    EdgeFilter filter(40);
+    TEST_ASSERT_EQUAL_UINT32(40, filter.Measure(window_buf, length, length));
+    TEST_ASSERT_TRUE(filter.Pass(window_buf, length, length));
+    filter.SetThreshold(41);
+    TEST_ASSERT_FALSE(filter.Pass(window_buf, length, length));
+    TEST_ASSERT_EQUAL_UINT(2, filter.GetNumTested());
+    TEST_ASSERT_EQUAL_UINT(1, filter.GetNumPassed());
+    return CaseNext;
+}
+
+// Test that a zero threshold passes every window and stats can be reset
+static control_t edge_filter_test_3(const size_t call_count)
+{
+    for (size_t i = 0; i < sizeof(window_buf); i++) {
+        window_buf[i] = 0;
+    }
+    EdgeFilter filter(0);
+    for (size_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(filter.Pass(window_buf, length, length));
+    }
+    TEST_ASSERT_EQUAL_UINT(5, filter.GetNumPassed());
+    filter.ResetStats();
+    TEST_ASSERT_EQUAL_UINT(0, filter.GetNumTested());
+    TEST_ASSERT_EQUAL_UINT(0, filter.GetNumPassed());
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Test EdgeFilter rejects flat window", edge_filter_test_1),
+    Case("Test EdgeFilter stripe energy and threshold", edge_filter_test_2),
+    Case("Test EdgeFilter disabled threshold and stats reset", edge_filter_test_3)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
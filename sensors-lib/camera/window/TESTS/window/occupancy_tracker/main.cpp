@@ -0,0 +1,102 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/window/OccupancyTracker.h"
+
+using namespace utest::v1;
+
+static constexpr size_t length = 96;
+static uint8_t window_buf[length * length];
+
+static void fill_window(uint8_t value)
+{
+    for (size_t i = 0; i < sizeof(window_buf); i++) {
+        window_buf[i] = value;
+    }
+}
+
+// Test that a static cell is re-inferred only after its confidence decays
+static control_t occupancy_tracker_test_1(const size_t call_count)
+{
+    OccupancyTracker tracker(OccupancyTracker::DefaultConfig());
+    fill_window(100);
+    size_t inferences = 0;
+    for (size_t frame = 0; frame < 12; frame++) {
+        tracker.BeginFrame();
+        if (tracker.NeedsInference(0, window_buf, length, length)) {
+            tracker.Update(0, 200);
+            inferences++;
+        }
+    }
+    // Confidence 255 decays by 3/4 per frame and drops below 64 on the 5th frame
+    TEST_ASSERT_EQUAL_UINT(3, inferences);
+    TEST_ASSERT_TRUE(tracker.IsOccupied(0));
+    TEST_ASSERT_TRUE(tracker.GetScore(0) >= 0);
+    return CaseNext;
+}
+
+// Test that motion forces a re-inference
+static control_t occupancy_tracker_test_2(const size_t call_count)
+{
+    OccupancyTracker tracker(OccupancyTracker::DefaultConfig());
+    fill_window(100);
+    tracker.BeginFrame();
+    TEST_ASSERT_TRUE(tracker.NeedsInference(5, window_buf, length, length));
+    tracker.Update(5, -200);
+
+    tracker.BeginFrame();
+    TEST_ASSERT_FALSE(tracker.NeedsInference(5, window_buf, length, length));
+
+    // Brighten the bottom half of the window
+    for (size_t i = sizeof(window_buf) / 2; i < sizeof(window_buf); i++) {
+        window_buf[i] = 160;
+    }
+    tracker.BeginFrame();
+    TEST_ASSERT_TRUE(tracker.NeedsInference(5, window_buf, length, length));
+    return CaseNext;
+}
+
+// Test that hysteresis holds the occupied state through a weak negative score
+static control_t occupancy_tracker_test_3(const size_t call_count)
+{
+    OccupancyTracker tracker(OccupancyTracker::DefaultConfig());
+    TEST_ASSERT_EQUAL_INT16(OccupancyTracker::NO_SCORE, tracker.GetScore(2));
+
+    tracker.Update(2, 100);
+    TEST_ASSERT_TRUE(tracker.IsOccupied(2));
+    tracker.Update(2, -20);
+    TEST_ASSERT_TRUE(tracker.IsOccupied(2));
+    TEST_ASSERT_TRUE(tracker.GetScore(2) >= 0);
+
+    tracker.Update(2, -200);
+    TEST_ASSERT_FALSE(tracker.IsOccupied(2));
+    TEST_ASSERT_TRUE(tracker.GetScore(2) < 0);
+
+    tracker.Reset();
+    TEST_ASSERT_EQUAL_INT16(OccupancyTracker::NO_SCORE, tracker.GetScore(2));
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Test OccupancyTracker confidence decay", occupancy_tracker_test_1),
+    Case("Test OccupancyTracker motion detection", occupancy_tracker_test_2),
+    Case("Test OccupancyTracker hysteresis", occupancy_tracker_test_3)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
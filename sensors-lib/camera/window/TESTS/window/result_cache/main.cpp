@@ -0,0 +1,92 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/window/ResultCache.h"
+
+using namespace utest::v1;
+
+static constexpr size_t length = 96;
+static uint8_t window_buf[length * length];
+
+// Fill the window with a pattern offset by a constant brightness
+static void fill_window(uint32_t seed, uint8_t brightness)
+{
+    for (size_t row = 0; row < length; row++) {
+        for (size_t col = 0; col < length; col++) {
+            uint32_t value = ((row / 12) * 7 + (col / 11) * seed) % 100;
+            window_buf[row * length + col] = value + brightness;
+        }
+    }
+}
+
+// Test that the hash ignores a uniform brightness change but not a content change
+static control_t result_cache_test_1(const size_t call_count)
+{
+    fill_window(13, 20);
+    uint64_t hash = ResultCache::Hash(window_buf, length, length);
+    fill_window(13, 120);
+    TEST_ASSERT_TRUE(hash == ResultCache::Hash(window_buf, length, length));
+    fill_window(29, 20);
+    TEST_ASSERT_FALSE(hash == ResultCache::Hash(window_buf, length, length));
+    return CaseNext;
+}
+
+// Test hits within the Hamming distance and the hit statistics
+static control_t result_cache_test_2(const size_t call_count)
+{
+    ResultCache cache(4, 2);
+    int16_t score = 0;
+    TEST_ASSERT_FALSE(cache.Lookup(0xF0F0, score));
+    cache.Insert(0xF0F0, 42);
+    TEST_ASSERT_TRUE(cache.Lookup(0xF0F3, score));
+    TEST_ASSERT_EQUAL_INT(42, score);
+    TEST_ASSERT_FALSE(cache.Lookup(0xF0F7, score));
+    TEST_ASSERT_EQUAL_UINT(3, cache.GetNumLookups());
+    TEST_ASSERT_EQUAL_UINT(1, cache.GetNumHits());
+    return CaseNext;
+}
+
+// Test that the least recently used entry is evicted, and that capacity 0 disables the cache
+static control_t result_cache_test_3(const size_t call_count)
+{
+    ResultCache cache(2, 0);
+    int16_t score = 0;
+    cache.Insert(1, 10);
+    cache.Insert(2, 20);
+    TEST_ASSERT_TRUE(cache.Lookup(1, score));
+    cache.Insert(4, 40);
+    TEST_ASSERT_TRUE(cache.Lookup(1, score));
+    TEST_ASSERT_FALSE(cache.Lookup(2, score));
+    TEST_ASSERT_TRUE(cache.Lookup(4, score));
+    TEST_ASSERT_EQUAL_INT(40, score);
+
+    TEST_ASSERT_FALSE(cache.SetCapacity(ResultCache::MAX_ENTRIES + 1));
+    TEST_ASSERT_TRUE(cache.SetCapacity(0));
+    cache.Insert(1, 10);
+    TEST_ASSERT_FALSE(cache.Lookup(1, score));
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Test ResultCache hash is brightness invariant", result_cache_test_1),
+    Case("Test ResultCache Hamming distance hits", result_cache_test_2),
+    Case("Test ResultCache LRU eviction and disable", result_cache_test_3)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
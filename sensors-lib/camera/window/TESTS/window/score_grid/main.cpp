@@ -0,0 +1,109 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/window/ScoreGrid.h"
+
+using namespace utest::v1;
+
+// IoU threshold of 0.3 in 1/256 units
+static constexpr uint32_t iou_q8 = 77;
+static ScoreGrid grid;
+
+// Test that non-overlapping windows count every positive cell
+static control_t score_grid_test_1(const size_t call_count)
+{
+    TEST_ASSERT_TRUE(grid.Configure(3, 4, 80, 80, iou_q8));
+    grid.SetScore(0, 10);
+    grid.SetScore(1, 20);
+    grid.SetScore(5, 0);
+    grid.SetScore(6, -5);
+    TEST_ASSERT_EQUAL_UINT(3, grid.Suppress());
+    TEST_ASSERT_TRUE(grid.GetPeakMask() == 0x23);
+    TEST_ASSERT_TRUE(grid.GetPositiveMask() == 0x23);
+    return CaseNext;
+}
+
+// Test that one person seen by overlapping windows is counted once
+static control_t score_grid_test_2(const size_t call_count)
+{
+    // Length 80, stride 40: 5 x 7 windows over QVGA, horizontal and vertical neighbours overlap
+    TEST_ASSERT_TRUE(grid.Configure(5, 7, 80, 40, iou_q8));
+    grid.SetScore(8, 30);
+    grid.SetScore(9, 120);
+    grid.SetScore(16, 50);
+    TEST_ASSERT_EQUAL_UINT(1, grid.Suppress());
+    TEST_ASSERT_TRUE(grid.GetPeakMask() == (uint64_t)1 << 9);
+
+    // A second person two cells away does not overlap the first
+    grid.SetScore(11, 40);
+    TEST_ASSERT_EQUAL_UINT(2, grid.Suppress());
+    return CaseNext;
+}
+
+// Test that equal neighbouring peaks are counted once and diagonal windows are not suppressed
+static control_t score_grid_test_3(const size_t call_count)
+{
+    TEST_ASSERT_TRUE(grid.Configure(5, 7, 80, 40, iou_q8));
+    grid.SetScore(8, 60);
+    grid.SetScore(9, 60);
+    TEST_ASSERT_EQUAL_UINT(1, grid.Suppress());
+    TEST_ASSERT_TRUE(grid.GetPeakMask() == (uint64_t)1 << 8);
+
+    // Diagonal neighbours overlap by IoU 1/7, below the threshold
+    grid.Clear();
+    grid.SetScore(8, 60);
+    grid.SetScore(16, 70);
+    TEST_ASSERT_EQUAL_UINT(2, grid.Suppress());
+
+    TEST_ASSERT_FALSE(grid.Configure(9, 9, 80, 40, iou_q8));
+    TEST_ASSERT_EQUAL_UINT(35, grid.GetNumCells());
+    return CaseNext;
+}
+
+// Test the packed telemetry layout and score quantisation
+static control_t score_grid_test_4(const size_t call_count)
+{
+    TEST_ASSERT_EQUAL_UINT(0, ScoreGrid::QuantiseScore(ScoreGrid::NO_SCORE));
+    TEST_ASSERT_EQUAL_UINT(1, ScoreGrid::QuantiseScore(-255));
+    TEST_ASSERT_EQUAL_UINT(7, ScoreGrid::QuantiseScore(-1));
+    TEST_ASSERT_EQUAL_UINT(8, ScoreGrid::QuantiseScore(0));
+    TEST_ASSERT_EQUAL_UINT(15, ScoreGrid::QuantiseScore(255));
+
+    TEST_ASSERT_TRUE(grid.Configure(3, 4, 80, 80, iou_q8));
+    grid.SetScore(0, 255);
+    grid.SetScore(1, -255);
+    grid.SetScore(9, 0);
+    TEST_ASSERT_EQUAL_UINT(2, grid.Suppress());
+
+    uint8_t buf[ScoreGrid::MAX_PACKED_BYTES];
+    TEST_ASSERT_EQUAL_UINT(0, grid.Pack(buf, 9));
+    TEST_ASSERT_EQUAL_UINT(10, grid.Pack(buf, sizeof(buf)));
+    const uint8_t expected[] = {3, 4, 0x01, 0x02, 0x1F, 0x00, 0x00, 0x00, 0x80, 0x00};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buf, sizeof(expected));
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Test ScoreGrid without overlap", score_grid_test_1),
+    Case("Test ScoreGrid merges overlapping detections", score_grid_test_2),
+    Case("Test ScoreGrid ties, diagonals and invalid size", score_grid_test_3),
+    Case("Test ScoreGrid packed telemetry", score_grid_test_4)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
@@ -0,0 +1,182 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/window/WindowPlan.h"
+
+using namespace utest::v1;
+
+static constexpr size_t img_height = 240;
+static constexpr size_t img_width = 320;
+static constexpr size_t out_length = 96;
+static uint8_t img_buf[img_height * img_width * 2];
+static uint8_t out_buf[out_length * out_length];
+static uint8_t frame_buf[96 * 128];
+static WindowPlan plan;
+
+// Test default non-overlapping grid over a QVGA image
+static control_t window_plan_test_1(const size_t call_count) 
+{
+    window_config_t config = WindowPlan::DefaultConfig(80);
+    TEST_ASSERT_TRUE(plan.Build(config, img_height, img_width, out_length, out_length));
+    TEST_ASSERT_EQUAL_UINT(3, plan.GetGridRows());
+    TEST_ASSERT_EQUAL_UINT(4, plan.GetGridCols());
+    TEST_ASSERT_EQUAL_UINT(12, plan.GetNumWindows());
+
+    const window_rect_t& last = plan.GetWindow(11);
+    TEST_ASSERT_EQUAL_UINT(160, last.top);
+    TEST_ASSERT_EQUAL_UINT(240, last.left);
+    TEST_ASSERT_EQUAL_UINT(11, last.cell);
+    return CaseNext;
+}
+
+// Test overlapping stride, offsets and cell enable mask
+static control_t window_plan_test_2(const size_t call_count) 
+{
+    window_config_t config = {80, 40, 10, 20, 0};
+    config.enable_mask = (1ULL << 0) | (1ULL << 6) | (1ULL << 7);
+    TEST_ASSERT_TRUE(plan.Build(config, img_height, img_width, out_length, out_length));
+    // (240 - 10 - 80) / 40 + 1 rows, (320 - 20 - 80) / 40 + 1 cols
+    TEST_ASSERT_EQUAL_UINT(4, plan.GetGridRows());
+    TEST_ASSERT_EQUAL_UINT(6, plan.GetGridCols());
+    TEST_ASSERT_EQUAL_UINT(24, plan.GetNumCells());
+    TEST_ASSERT_EQUAL_UINT(3, plan.GetNumWindows());
+
+    const window_rect_t& rect = plan.GetWindow(2);
+    TEST_ASSERT_EQUAL_UINT(7, rect.cell);
+    TEST_ASSERT_EQUAL_UINT(1, rect.grid_row);
+    TEST_ASSERT_EQUAL_UINT(1, rect.grid_col);
+    TEST_ASSERT_EQUAL_UINT(50, rect.top);
+    TEST_ASSERT_EQUAL_UINT(60, rect.left);
+    return CaseNext;
+}
+
+// Test that an invalid config is rejected and the previous plan is kept
+static control_t window_plan_test_3(const size_t call_count) 
+{
+    window_config_t config = WindowPlan::DefaultConfig(80);
+    TEST_ASSERT_TRUE(plan.Build(config, img_height, img_width, out_length, out_length));
+
+    window_config_t too_long = WindowPlan::DefaultConfig(241);
+    TEST_ASSERT_FALSE(plan.Build(too_long, img_height, img_width, out_length, out_length));
+    window_config_t zero_stride = {80, 0, 0, 0, ~0ULL};
+    TEST_ASSERT_FALSE(plan.Build(zero_stride, img_height, img_width, out_length, out_length));
+    window_config_t too_many = {8, 8, 0, 0, ~0ULL};
+    TEST_ASSERT_FALSE(plan.Build(too_many, img_height, img_width, out_length, out_length));
+
+    TEST_ASSERT_EQUAL_UINT(80, plan.GetConfig().length);
+    TEST_ASSERT_EQUAL_UINT(12, plan.GetNumWindows());
+    return CaseNext;
+}
+
+// Test that extraction of a flat RGB565 image matches Pixel grayscale conversion
+static control_t window_plan_test_4(const size_t call_count) 
+{
+    Image image(img_height, img_width, Pixel::RGB565, img_buf);
+    uint8_t rgb[Pixel::MAX_PIXEL_BYTES] = {200, 100, 50, 0};
+    Pixel pixel = Pixel(Pixel::RGB888, rgb).Reformat(Pixel::RGB565);
+    for (size_t row = 0; row < img_height; row++) {
+        for (size_t col = 0; col < img_width; col++) {
+            image.SetPixel(row, col, pixel);
+        }
+    }
+    uint8_t expected = pixel.Reformat(Pixel::GRAYSCALE).GetBytes()[0];
+
+    window_config_t config = WindowPlan::DefaultConfig(80);
+    TEST_ASSERT_TRUE(plan.Build(config, img_height, img_width, out_length, out_length));
+    plan.Extract(image, 5, out_buf);
+    for (size_t i = 0; i < sizeof(out_buf); i++) {
+        TEST_ASSERT_EQUAL_UINT8(expected, out_buf[i]);
+    }
+    return CaseNext;
+}
+
+// Test that extraction reads only from the window's source rect
+static control_t window_plan_test_5(const size_t call_count) 
+{
+    Image image(img_height, img_width, Pixel::GRAYSCALE, img_buf);
+    // Fill each 80x80 cell with its own cell index
+    for (size_t row = 0; row < img_height; row++) {
+        for (size_t col = 0; col < img_width; col++) {
+            img_buf[row * img_width + col] = (row / 80) * 4 + (col / 80);
+        }
+    }
+    window_config_t config = WindowPlan::DefaultConfig(80);
+    TEST_ASSERT_TRUE(plan.Build(config, img_height, img_width, out_length, out_length));
+    for (size_t idx = 0; idx < plan.GetNumWindows(); idx++) {
+        plan.Extract(image, idx, out_buf);
+        TEST_ASSERT_EQUAL_UINT8(plan.GetWindow(idx).cell, out_buf[0]);
+        TEST_ASSERT_EQUAL_UINT8(plan.GetWindow(idx).cell, out_buf[sizeof(out_buf) - 1]);
+    }
+    return CaseNext;
+}
+
+// Test that a frame plan resizes the whole image into a single window
+static control_t window_plan_test_6(const size_t call_count) 
+{
+    Image image(img_height, img_width, Pixel::GRAYSCALE, img_buf);
+    for (size_t row = 0; row < img_height; row++) {
+        for (size_t col = 0; col < img_width; col++) {
+            img_buf[row * img_width + col] = (row / 80) * 4 + (col / 80);
+        }
+    }
+    TEST_ASSERT_TRUE(plan.BuildFrame(img_height, img_width, 96, 128));
+    TEST_ASSERT_EQUAL_UINT(1, plan.GetNumWindows());
+    plan.Extract(image, 0, frame_buf);
+    // Each 80x80 cell maps onto a 32x32 block of the 96x128 output
+    for (size_t cell = 0; cell < 12; cell++) {
+        size_t row = (cell / 4) * 32 + 16;
+        size_t col = (cell % 4) * 32 + 16;
+        TEST_ASSERT_EQUAL_UINT8(cell, frame_buf[row * 128 + col]);
+    }
+    TEST_ASSERT_FALSE(plan.BuildFrame(img_height, img_width, 96, 129));
+    return CaseNext;
+}
+
+// Test that only rows under enabled windows are marked as covered
+static control_t window_plan_test_7(const size_t call_count) 
+{
+    window_config_t config = WindowPlan::DefaultConfig(80);
+    config.enable_mask = (1ULL << 1) | (1ULL << 5);
+    TEST_ASSERT_TRUE(plan.Build(config, img_height, img_width, out_length, out_length));
+    // Cell 1 is in grid row 0 and cell 5 in grid row 1, so rows 0-159 are covered
+    TEST_ASSERT_EQUAL_UINT(160, plan.GetNumCoveredRows());
+    TEST_ASSERT_TRUE(plan.IsRowCovered(0));
+    TEST_ASSERT_TRUE(plan.IsRowCovered(159));
+    TEST_ASSERT_FALSE(plan.IsRowCovered(160));
+
+    config.enable_mask = 0;
+    TEST_ASSERT_TRUE(plan.Build(config, img_height, img_width, out_length, out_length));
+    TEST_ASSERT_EQUAL_UINT(0, plan.GetNumCoveredRows());
+
+    TEST_ASSERT_TRUE(plan.BuildFrame(img_height, img_width, 96, 128));
+    TEST_ASSERT_EQUAL_UINT(img_height, plan.GetNumCoveredRows());
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases) 
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] = 
+{
+    Case("Test WindowPlan default QVGA grid", window_plan_test_1),
+    Case("Test WindowPlan stride, offsets and enable mask", window_plan_test_2),
+    Case("Test WindowPlan rejects invalid configs", window_plan_test_3),
+    Case("Test WindowPlan RGB565 extraction matches Pixel conversion", window_plan_test_4),
+    Case("Test WindowPlan extraction stays within source rect", window_plan_test_5),
+    Case("Test WindowPlan frame plan covers whole image", window_plan_test_6),
+    Case("Test WindowPlan row coverage follows enable mask", window_plan_test_7)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main() 
+{
+    return !Harness::run(specification);
+}
@@ -0,0 +1,76 @@
+#include "mbed.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+#include "camera/window/WindowScheduler.h"
+
+using namespace utest::v1;
+
+static WindowPlan plan;
+static uint8_t order[WindowPlan::MAX_WINDOWS];
+
+// Test that fresh cells keep the plan order, and occupied, active and priority cells go first
+static control_t window_scheduler_test_1(const size_t call_count)
+{
+    TEST_ASSERT_TRUE(plan.Build(WindowPlan::DefaultConfig(80), 240, 320, 96, 96));
+    WindowScheduler scheduler;
+    TEST_ASSERT_EQUAL_UINT(12, scheduler.Order(plan, 0, order));
+    for (size_t i = 0; i < 12; i++) {
+        TEST_ASSERT_EQUAL_UINT(i, order[i]);
+        scheduler.MarkVisited(i, i == 7);
+    }
+
+    scheduler.SetPriorityMask((uint64_t)1 << 9);
+    scheduler.Order(plan, (uint64_t)1 << 4, order);
+    TEST_ASSERT_EQUAL_UINT(4, order[0]);
+    TEST_ASSERT_EQUAL_UINT(7, order[1]);
+    TEST_ASSERT_EQUAL_UINT(9, order[2]);
+    TEST_ASSERT_EQUAL_UINT(0, order[3]);
+    return CaseNext;
+}
+
+// Test that windows cut off by the budget go first in the next frame
+static control_t window_scheduler_test_2(const size_t call_count)
+{
+    TEST_ASSERT_TRUE(plan.Build(WindowPlan::DefaultConfig(80), 240, 320, 96, 96));
+    WindowScheduler scheduler;
+    scheduler.Order(plan, 0, order);
+    for (size_t i = 0; i < 5; i++) {
+        scheduler.MarkVisited(order[i], true);
+    }
+
+    // Occupied and active cells 0-4 still go after the 7 carried-over cells
+    scheduler.Order(plan, 0x1F, order);
+    for (size_t i = 0; i < 7; i++) {
+        TEST_ASSERT_EQUAL_UINT(5 + i, order[i]);
+        TEST_ASSERT_EQUAL_UINT(2, scheduler.GetAge(order[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT(0, order[7]);
+    TEST_ASSERT_EQUAL_UINT(1, scheduler.GetAge(0));
+
+    scheduler.Reset();
+    TEST_ASSERT_EQUAL_UINT(0, scheduler.GetAge(5));
+    return CaseNext;
+}
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
+    GREENTEA_SETUP(60, "default_auto");
+
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+// List of test cases in this file
+Case cases[] =
+{
+    Case("Test WindowScheduler priority order", window_scheduler_test_1),
+    Case("Test WindowScheduler carry-over", window_scheduler_test_2)
+};
+
+Specification specification(greentea_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
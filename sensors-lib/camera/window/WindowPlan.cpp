@@ -0,0 +1,307 @@
+# include "camera/window/WindowPlan.h"
+
+/*  @brief  Initialize an empty plan. Build() must be called before use.
+ */
+WindowPlan::WindowPlan(void):
+    valid_(false),
+    src_height_(0),
+    src_width_(0),
+    out_height_(0),
+    out_width_(0),
+    grid_rows_(0),
+    grid_cols_(0),
+    num_windows_(0),
+    num_covered_rows_(0)
+{
+    config_ = DefaultConfig(0);
+    for (size_t i = 0; i < sizeof(covered_rows_); i++) {
+        covered_rows_[i] = 0;
+    }
+}
+
+/*  @brief  Get a config with non-overlapping windows of the given length anchored at (0, 0),
+            with every cell enabled.
+    @param  length: Side length of each square window.
+ */
+window_config_t WindowPlan::DefaultConfig(size_t length)
+{
+    window_config_t config = {length, length, 0, 0, ~(uint64_t)0};
+    return config;
+}
+
+/*  @brief  Precompute resize coefficients mapping out_length samples onto src_length samples.
+            Uses the same source coordinate mapping as Image::Resize, i.e. out * src / out_length,
+            with the fractional part kept in 8-bit fixed point.
+ */
+void WindowPlan::ComputeCoeffs(size_t src_length, size_t out_length, resize_coeff_t* coeffs)
+{
+    for (size_t i = 0; i < out_length; i++) {
+        size_t pos = (i * src_length * 256) / out_length;
+        size_t lo = pos >> 8;
+        coeffs[i].lo = lo;
+        coeffs[i].hi = (lo + 1 < src_length) ? lo + 1 : lo;
+        coeffs[i].frac = pos & 0xFF;
+    }
+}
+
+/*  @brief  Compile a window config into the window table.
+            The plan is left unchanged if the config does not fit the image.
+    @param  config:     Window geometry. See window_config_t.
+            img_height: Height of the camera image.
+            img_width:  Width of the camera image.
+            out_height: Height of each extracted window, i.e. the model input height.
+            out_width:  Width of each extracted window, i.e. the model input width.
+    @return True if the config was valid and the plan was rebuilt.
+ */
+bool WindowPlan::Build(const window_config_t& config,
+                size_t img_height, size_t img_width,
+                size_t out_height, size_t out_width)
+{
+    if (config.length == 0 || config.stride == 0 || config.length > MAX_WINDOW_LENGTH) {
+        return false;
+    }
+    if (config.row_offset + config.length > img_height || config.col_offset + config.length > img_width) {
+        return false;
+    }
+    if (img_height > MAX_IMAGE_HEIGHT) {
+        return false;
+    }
+    if (out_height == 0 || out_width == 0 || out_height > MAX_OUTPUT_LENGTH || out_width > MAX_OUTPUT_LENGTH) {
+        return false;
+    }
+    size_t grid_rows = (img_height - config.row_offset - config.length) / config.stride + 1;
+    size_t grid_cols = (img_width - config.col_offset - config.length) / config.stride + 1;
+    if (grid_rows * grid_cols > MAX_WINDOWS) {
+        return false;
+    }
+
+    config_ = config;
+    src_height_ = config.length;
+    src_width_ = config.length;
+    out_height_ = out_height;
+    out_width_ = out_width;
+    grid_rows_ = grid_rows;
+    grid_cols_ = grid_cols;
+    num_windows_ = 0;
+    for (size_t grid_row = 0; grid_row < grid_rows; grid_row++) {
+        for (size_t grid_col = 0; grid_col < grid_cols; grid_col++) {
+            size_t cell = grid_row * grid_cols + grid_col;
+            if (!((config.enable_mask >> cell) & 1)) {
+                continue;
+            }
+            window_rect_t& rect = windows_[num_windows_++];
+            rect.top = config.row_offset + grid_row * config.stride;
+            rect.left = config.col_offset + grid_col * config.stride;
+            rect.cell = cell;
+            rect.grid_row = grid_row;
+            rect.grid_col = grid_col;
+        }
+    }
+    ComputeCoeffs(config.length, out_height, row_coeffs_);
+    ComputeCoeffs(config.length, out_width, col_coeffs_);
+    ComputeCoverage();
+    valid_ = true;
+    return true;
+}
+
+/*  @brief  Mark the image rows read by the enabled windows, 
+            so that rows outside every window can be skipped when the image is read.
+ */
+void WindowPlan::ComputeCoverage(void)
+{
+    for (size_t i = 0; i < sizeof(covered_rows_); i++) {
+        covered_rows_[i] = 0;
+    }
+    num_covered_rows_ = 0;
+    for (size_t idx = 0; idx < num_windows_; idx++) {
+        size_t top = windows_[idx].top;
+        for (size_t row = top; row < top + src_height_; row++) {
+            if (!IsRowCovered(row)) {
+                covered_rows_[row / 8] |= 1 << (row % 8);
+                num_covered_rows_++;
+            }
+        }
+    }
+}
+
+/*  @brief  Build a plan with one window covering the whole image, 
+            resized to out_height x out_width. The image and output aspect ratios should match,
+            otherwise the frame is stretched.
+            The plan is left unchanged if the sizes are out of range.
+            The window config is reset to a single enabled cell of length 0.
+    @return True if the plan was rebuilt.
+ */
+bool WindowPlan::BuildFrame(size_t img_height, size_t img_width,
+                size_t out_height, size_t out_width)
+{
+    if (img_height == 0 || img_width == 0 || img_width > MAX_WINDOW_LENGTH || img_height > MAX_IMAGE_HEIGHT) {
+        return false;
+    }
+    if (out_height == 0 || out_width == 0 || out_height > MAX_OUTPUT_LENGTH || out_width > MAX_OUTPUT_LENGTH) {
+        return false;
+    }
+
+    config_ = DefaultConfig(0);
+    src_height_ = img_height;
+    src_width_ = img_width;
+    out_height_ = out_height;
+    out_width_ = out_width;
+    grid_rows_ = 1;
+    grid_cols_ = 1;
+    num_windows_ = 1;
+    window_rect_t& rect = windows_[0];
+    rect.top = 0;
+    rect.left = 0;
+    rect.cell = 0;
+    rect.grid_row = 0;
+    rect.grid_col = 0;
+    ComputeCoeffs(img_height, out_height, row_coeffs_);
+    ComputeCoeffs(img_width, out_width, col_coeffs_);
+    ComputeCoverage();
+    valid_ = true;
+    return true;
+}
+
+/*  @brief  Convert one window row of the image, starting at column left, to grayscale.
+            Conversion matches Pixel::Reformat(Pixel::GRAYSCALE) so that model inputs are unchanged.
+ */
+void WindowPlan::ConvertLine(const Image& image, size_t row, size_t left, uint8_t* line) const
+{
+    size_t channels = image.GetChannels();
+    const uint8_t* src = image.GetBuffer() + (row * image.GetWidth() + left) * channels;
+    size_t length = src_width_;
+
+    switch (image.GetFormat()) {
+        case Pixel::GRAYSCALE:
+            for (size_t i = 0; i < length; i++) {
+                line[i] = src[i];
+            }
+            break;
+        case Pixel::RGB565:
+            for (size_t i = 0; i < length; i++) {
+                // Little-endian, see Pixel::ConvertRgb565ToRgb888()
+                uint8_t pix_lo = src[2 * i];
+                uint8_t pix_hi = src[2 * i + 1];
+                uint8_t red = (0xF8 & pix_hi);
+                uint8_t green = ((0x07 & pix_hi) << 5) | ((0xE0 & pix_lo) >> 3);
+                uint8_t blue = (0x1F & pix_lo) << 3;
+                line[i] = (red / 3) + (green / 3) + (blue / 3);
+            }
+            break;
+        case Pixel::RGB888:
+            for (size_t i = 0; i < length; i++) {
+                line[i] = (src[3 * i] / 3) + (src[3 * i + 1] / 3) + (src[3 * i + 2] / 3);
+            }
+            break;
+    }
+}
+
+/*  @brief  Crop, convert to grayscale and bilinearly resize one planned window in a single pass.
+            Each source row is converted at most once per window.
+    @param  image:   Camera image the plan was built for.
+            idx:     Window index in [0, GetNumWindows()).
+            out_buf: Buffer of at least out_height * out_width bytes.
+ */
+void WindowPlan::Extract(const Image& image, size_t idx, uint8_t* out_buf) const
+{
+    const window_rect_t& rect = windows_[idx];
+    // Row indices currently held in the line buffers, relative to rect.top
+    int cached_lo = -1;
+    int cached_hi = -1;
+
+    for (size_t row = 0; row < out_height_; row++) {
+        const resize_coeff_t& rc = row_coeffs_[row];
+        if (cached_lo != rc.lo) {
+            if (cached_hi == rc.lo) {
+                // Moving down by one source row; reuse the converted line
+                for (size_t i = 0; i < src_width_; i++) {
+                    line_lo_[i] = line_hi_[i];
+                }
+            } else {
+                ConvertLine(image, rect.top + rc.lo, rect.left, line_lo_);
+            }
+            cached_lo = rc.lo;
+        }
+        if (cached_hi != rc.hi) {
+            ConvertLine(image, rect.top + rc.hi, rect.left, line_hi_);
+            cached_hi = rc.hi;
+        }
+
+        uint8_t* out_row = out_buf + row * out_width_;
+        uint32_t wy = rc.frac;
+        for (size_t col = 0; col < out_width_; col++) {
+            const resize_coeff_t& cc = col_coeffs_[col];
+            uint32_t wx = cc.frac;
+            uint32_t top = line_lo_[cc.lo] * (256 - wx) + line_lo_[cc.hi] * wx;
+            uint32_t bottom = line_hi_[cc.lo] * (256 - wx) + line_hi_[cc.hi] * wx;
+            out_row[col] = (top * (256 - wy) + bottom * wy) >> 16;
+        }
+    }
+}
+
+/*  @brief  Check whether Build() has succeeded at least once.
+ */
+bool WindowPlan::IsValid(void) const
+{
+    return valid_;
+}
+
+/*  @brief  Get the number of enabled windows in the plan.
+ */
+size_t WindowPlan::GetNumWindows(void) const
+{
+    return num_windows_;
+}
+
+/*  @brief  Get the total number of cells in the window grid, including disabled cells.
+ */
+size_t WindowPlan::GetNumCells(void) const
+{
+    return grid_rows_ * grid_cols_;
+}
+
+/*  @brief  Get the number of rows in the window grid.
+ */
+size_t WindowPlan::GetGridRows(void) const
+{
+    return grid_rows_;
+}
+
+/*  @brief  Get the number of cols in the window grid.
+ */
+size_t WindowPlan::GetGridCols(void) const
+{
+    return grid_cols_;
+}
+
+/*  @brief  Get the source rectangle of a planned window.
+    @param  idx: Window index in [0, GetNumWindows()).
+ */
+const window_rect_t& WindowPlan::GetWindow(size_t idx) const
+{
+    return windows_[idx];
+}
+
+/*  @brief  Get the config the plan was last built from.
+ */
+const window_config_t& WindowPlan::GetConfig(void) const
+{
+    return config_;
+}
+
+/*  @brief  Check whether an image row is read by any enabled window.
+ */
+bool WindowPlan::IsRowCovered(size_t row) const
+{
+    if (row >= MAX_IMAGE_HEIGHT) {
+        return false;
+    }
+    return (covered_rows_[row / 8] >> (row % 8)) & 1;
+}
+
+/*  @brief  Get the number of image rows read by at least one enabled window.
+ */
+size_t WindowPlan::GetNumCoveredRows(void) const
+{
+    return num_covered_rows_;
+}
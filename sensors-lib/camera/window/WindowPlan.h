@@ -0,0 +1,125 @@
+# ifndef WINDOW_PLAN_H
+# define WINDOW_PLAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "camera/image/Image.h"
+
+/*  Runtime sliding window geometry.
+    All lengths are in pixels of the camera image.
+    Cells are numbered in row-major order over the window grid,
+    and bit i of enable_mask enables cell i.
+ */
+typedef struct {
+    size_t length;
+    size_t stride;
+    size_t row_offset;
+    size_t col_offset;
+    uint64_t enable_mask;
+} window_config_t;
+
+/*  Source rectangle of a single window in the plan.
+ */
+typedef struct {
+    uint16_t top;
+    uint16_t left;
+    uint8_t cell;
+    uint8_t grid_row;
+    uint8_t grid_col;
+} window_rect_t;
+
+/*  Resize coefficient for one output row or column.
+    The output sample is interpolated between source offsets lo and hi
+    with weight frac / 256 on hi.
+ */
+typedef struct {
+    uint16_t lo;
+    uint16_t hi;
+    uint16_t frac;
+} resize_coeff_t;
+
+/** WindowPlan class.
+ *  @brief  Precomputed table of sliding windows over a camera image.
+            The plan is built once per configuration change,
+            so that the per-frame loop only iterates over the window rects
+            and reuses the shared resize coefficients.
+            BuildFrame() makes a plan with a single window covering the whole image,
+            for models that score the full frame in one invoke.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "WindowPlan.h"
+ *
+ *  int main()
+ *  {
+        static uint8_t window_buf[96 * 96];
+        WindowPlan plan;
+        window_config_t config = WindowPlan::DefaultConfig(80);
+        if (plan.Build(config, 240, 320, 96, 96))
+        {
+            for (size_t i = 0; i < plan.GetNumWindows(); i++) {
+                // camera_image is a 320 x 240 Image
+                plan.Extract(camera_image, i, window_buf);
+                // window_buf now holds a 96 x 96 grayscale crop
+            }
+        }
+ *  }
+ *  @endcode
+ */
+class WindowPlan {
+
+    public:
+        static constexpr size_t MAX_WINDOWS = 64;
+        static constexpr size_t MAX_WINDOW_LENGTH = 320;
+        static constexpr size_t MAX_OUTPUT_LENGTH = 128;
+        static constexpr size_t MAX_IMAGE_HEIGHT = 480;
+
+        WindowPlan(void);
+
+        static window_config_t DefaultConfig(size_t length);
+        bool Build(const window_config_t& config,
+                size_t img_height, size_t img_width,
+                size_t out_height, size_t out_width);
+        bool BuildFrame(size_t img_height, size_t img_width,
+                size_t out_height, size_t out_width);
+        void Extract(const Image& image, size_t idx, uint8_t* out_buf) const;
+
+        bool IsValid(void) const;
+        size_t GetNumWindows(void) const;
+        size_t GetNumCells(void) const;
+        size_t GetGridRows(void) const;
+        size_t GetGridCols(void) const;
+        const window_rect_t& GetWindow(size_t idx) const;
+        const window_config_t& GetConfig(void) const;
+        bool IsRowCovered(size_t row) const;
+        size_t GetNumCoveredRows(void) const;
+
+    private:
+        window_config_t config_;
+        bool valid_;
+        // Source size of every window; both equal config_.length unless built with BuildFrame()
+        size_t src_height_;
+        size_t src_width_;
+        size_t out_height_;
+        size_t out_width_;
+        size_t grid_rows_;
+        size_t grid_cols_;
+        size_t num_windows_;
+        window_rect_t windows_[MAX_WINDOWS];
+        resize_coeff_t row_coeffs_[MAX_OUTPUT_LENGTH];
+        resize_coeff_t col_coeffs_[MAX_OUTPUT_LENGTH];
+        // Bitset of image rows read by at least one enabled window
+        uint8_t covered_rows_[MAX_IMAGE_HEIGHT / 8];
+        size_t num_covered_rows_;
+
+        // Grayscale line buffers for the two source rows being interpolated
+        mutable uint8_t line_lo_[MAX_WINDOW_LENGTH];
+        mutable uint8_t line_hi_[MAX_WINDOW_LENGTH];
+
+        static void ComputeCoeffs(size_t src_length, size_t out_length, resize_coeff_t* coeffs);
+        void ComputeCoverage(void);
+        void ConvertLine(const Image& image, size_t row, size_t left, uint8_t* line) const;
+};
+
+# endif // WINDOW_PLAN_H
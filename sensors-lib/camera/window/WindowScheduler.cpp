@@ -0,0 +1,99 @@
+# include "camera/window/WindowScheduler.h"
+
+/*  @brief  Initialize with every cell unvisited and an empty priority mask.
+ */
+WindowScheduler::WindowScheduler(void):
+    priority_mask_(0)
+{
+    Reset();
+}
+
+/*  @brief  Forget which cells were visited, e.g. after the window geometry changes.
+            The priority mask is kept.
+ */
+void WindowScheduler::Reset(void)
+{
+    for (size_t cell = 0; cell < MAX_CELLS; cell++) {
+        age_[cell] = 0;
+    }
+    active_mask_ = 0;
+}
+
+/*  @brief  Set the cells that go first among windows of equal age and state.
+ */
+void WindowScheduler::SetPriorityMask(uint64_t mask)
+{
+    priority_mask_ = mask;
+}
+
+/*  @brief  Get the cells that go first among windows of equal age and state.
+ */
+uint64_t WindowScheduler::GetPriorityMask(void) const
+{
+    return priority_mask_;
+}
+
+/*  @brief  Compute the priority of a cell, see WindowScheduler.h.
+ */
+uint16_t WindowScheduler::Priority(size_t cell, uint64_t occupied_mask) const
+{
+    uint64_t bit = (uint64_t)1 << cell;
+    return ((uint16_t)age_[cell] << 3)
+        | ((occupied_mask & bit) ? 4 : 0)
+        | ((active_mask_ & bit) ? 2 : 0)
+        | ((priority_mask_ & bit) ? 1 : 0);
+}
+
+/*  @brief  Start a frame: age every cell and sort the windows of the plan by priority.
+            Call once per frame, then MarkVisited() for each window actually processed.
+    @param  plan:          Window plan of the frame.
+            occupied_mask: Bitmask of cells currently occupied, cell 0 in bit 0.
+            order:         Filled with window indices into the plan, highest priority first.
+                           Must hold plan.GetNumWindows() entries.
+    @return Number of windows in order.
+ */
+size_t WindowScheduler::Order(const WindowPlan& plan, uint64_t occupied_mask, uint8_t* order)
+{
+    for (size_t cell = 0; cell < MAX_CELLS; cell++) {
+        if (age_[cell] < MAX_AGE) {
+            age_[cell]++;
+        }
+    }
+    uint16_t priorities[WindowPlan::MAX_WINDOWS];
+    size_t count = plan.GetNumWindows();
+    // Insertion sort, stable so that ties keep the plan order
+    for (size_t idx = 0; idx < count; idx++) {
+        size_t cell = plan.GetWindow(idx).cell;
+        uint16_t priority = (cell < MAX_CELLS) ? Priority(cell, occupied_mask) : 0;
+        size_t pos = idx;
+        while (pos > 0 && priorities[pos - 1] < priority) {
+            priorities[pos] = priorities[pos - 1];
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        priorities[pos] = priority;
+        order[pos] = idx;
+    }
+    return count;
+}
+
+/*  @brief  Record that the window of a cell was processed this frame.
+    @param  cell:   Row-major cell index.
+            active: True if the window needed inference, i.e. it moved or its result had decayed.
+ */
+void WindowScheduler::MarkVisited(size_t cell, bool active)
+{
+    if (cell >= MAX_CELLS) {
+        return;
+    }
+    uint64_t bit = (uint64_t)1 << cell;
+    age_[cell] = 0;
+    active_mask_ = active ? (active_mask_ | bit) : (active_mask_ & ~bit);
+}
+
+/*  @brief  Get the number of frames since a cell was last visited, as of the last Order().
+ */
+uint8_t WindowScheduler::GetAge(size_t cell) const
+{
+    return (cell < MAX_CELLS) ? age_[cell] : 0;
+}
@@ -0,0 +1,61 @@
+# ifndef WINDOW_SCHEDULER_H
+# define WINDOW_SCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "camera/window/WindowPlan.h"
+
+/** WindowScheduler class.
+ *  @brief  Orders the windows of a plan so that a frame can be cut short when its
+            inference budget runs out, with the remaining windows carried over to the next frame.
+            Each cell has a priority built from, most significant first:
+            - its age, the number of frames since it was last visited, so carried-over
+              windows always go before windows visited in the previous frame;
+            - whether it was occupied, so recent positives are re-checked first;
+            - whether it was active, i.e. needed inference because of motion or decay;
+            - whether it is in the priority mask, a per-site weighting of the region of interest.
+            Ties go to the lower window index, which keeps the plan order.
+ *
+ *  Example:
+ *  @code{.cpp}
+ *  #include "WindowScheduler.h"
+ *
+ *  int main()
+ *  {
+        WindowScheduler scheduler;
+        uint8_t order[WindowPlan::MAX_WINDOWS];
+        size_t count = scheduler.Order(plan, occupied_mask, order);
+        for (size_t i = 0; i < count && !out_of_time(); i++) {
+            const window_rect_t& rect = plan.GetWindow(order[i]);
+            bool active = run_window(order[i]);
+            scheduler.MarkVisited(rect.cell, active);
+        }
+ *  }
+ *  @endcode
+ */
+class WindowScheduler {
+
+    public:
+        static constexpr size_t MAX_CELLS = 64;
+        // Age saturates here, which still outranks every other priority term
+        static constexpr uint8_t MAX_AGE = 31;
+
+        WindowScheduler(void);
+
+        void Reset(void);
+        void SetPriorityMask(uint64_t mask);
+        uint64_t GetPriorityMask(void) const;
+
+        size_t Order(const WindowPlan& plan, uint64_t occupied_mask, uint8_t* order);
+        void MarkVisited(size_t cell, bool active);
+        uint8_t GetAge(size_t cell) const;
+
+    private:
+        uint8_t age_[MAX_CELLS];
+        uint64_t active_mask_;
+        uint64_t priority_mask_;
+
+        uint16_t Priority(size_t cell, uint64_t occupied_mask) const;
+};
+
+# endif // WINDOW_SCHEDULER_H
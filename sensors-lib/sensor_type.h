@@ -52,6 +52,7 @@ public:
         DATA_CRC_ERR,
         DATA_NOT_RDY,
 		DATA_OUT_OF_RANGE,
+		DATA_PENDING,		// data is still being computed; call GetData() again
 	};
 	
 	virtual std::string GetName() = 0;
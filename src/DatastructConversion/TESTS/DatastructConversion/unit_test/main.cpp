@@ -409,6 +409,84 @@ static control_t convert_string_to_double_test_3(const size_t call_count)
     return CaseNext;
 }
 
+// Test for 64-bit value
+static control_t convert_uint64_to_hex_test_1(const size_t call_count) 
+{
+    uint64_t actual = 0x8000000000000fffULL;
+    std::string actual_hex = Uint64ToHex(actual);
+    std::string expected_hex = "8000000000000fff";
+
+    TEST_ASSERT_EQUAL_STRING(expected_hex.c_str(), actual_hex.c_str());
+    return CaseNext;
+}
+
+// Test for round trip through hex string
+static control_t convert_hex_to_uint64_test_1(const size_t call_count) 
+{
+    uint64_t expected = 0xfedcba9876543210ULL;
+    uint64_t actual = HexToUint64(Uint64ToHex(expected));
+
+    TEST_ASSERT_TRUE(expected == actual);
+    return CaseNext;
+}
+
+// Test for invalid hex string
+static control_t convert_hex_to_uint64_test_2(const size_t call_count) 
+{
+    uint64_t actual = HexToUint64("xyz");
+
+    TEST_ASSERT_TRUE(actual == 0);
+    return CaseNext;
+}
+
+// Test for base64 padding of 1, 2 and 3 byte inputs
+static control_t convert_bytes_to_base64_test_1(const size_t call_count) 
+{
+    const uint8_t input[] = {'f', 'o', 'o', 'b'};
+
+    TEST_ASSERT_EQUAL_STRING("Zg==", BytesToBase64(input, 1).c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm8=", BytesToBase64(input, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm9v", BytesToBase64(input, 3).c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm9vYg==", BytesToBase64(input, 4).c_str());
+    return CaseNext;
+}
+
+// Test for empty input and bytes using the top of the alphabet
+static control_t convert_bytes_to_base64_test_2(const size_t call_count) 
+{
+    const uint8_t input[] = {0xFB, 0xFF, 0xBF};
+
+    TEST_ASSERT_EQUAL_STRING("", BytesToBase64(input, 0).c_str());
+    TEST_ASSERT_EQUAL_STRING("+/+/", BytesToBase64(input, 3).c_str());
+    return CaseNext;
+}
+
+// Test for base64 round trip
+static control_t convert_base64_to_bytes_test_1(const size_t call_count) 
+{
+    const uint8_t input[] = {0x00, 0xFB, 0xFF, 0xBF, 0x10};
+    uint8_t output[8];
+
+    for (size_t len = 0; len <= sizeof(input); len++)
+    {
+        TEST_ASSERT_EQUAL_INT(len, Base64ToBytes(BytesToBase64(input, len), output, sizeof(output)));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(input, output, len);
+    }
+    return CaseNext;
+}
+
+// Test for invalid base64 and a too small output buffer
+static control_t convert_base64_to_bytes_test_2(const size_t call_count) 
+{
+    uint8_t output[8];
+
+    TEST_ASSERT_EQUAL_INT(-1, Base64ToBytes("Zm9", output, sizeof(output)));
+    TEST_ASSERT_EQUAL_INT(-1, Base64ToBytes("Zm!v", output, sizeof(output)));
+    TEST_ASSERT_EQUAL_INT(-1, Base64ToBytes("Zg==Zm9v", output, sizeof(output)));
+    TEST_ASSERT_EQUAL_INT(-1, Base64ToBytes("Zm9vYg==", output, 3));
+    return CaseNext;
+}
+
 utest::v1::status_t greentea_setup(const size_t number_of_cases) 
 {
     // Here, we specify the timeout (60s) and the host test (a built-in host test or the name of our Python file)
@@ -452,7 +530,14 @@ Case cases[] =
     Case("Check ToLowerCase converting uppercase alphabets to lowercase - null input string", convert_uppercase_to_lowercase_alphabets_test_3),
     Case("Check StringToDouble converting string to double - long (8) decimal places", convert_string_to_double_test_1),
     Case("Check StringToDouble converting string to double - integer input", convert_string_to_double_test_2),
-    Case("Check StringToDouble converting string to double - negative number", convert_string_to_double_test_3)
+    Case("Check StringToDouble converting string to double - negative number", convert_string_to_double_test_3),
+    Case("Check Uint64ToHex 64-bit value", convert_uint64_to_hex_test_1),
+    Case("Check HexToUint64 Round trip", convert_hex_to_uint64_test_1),
+    Case("Check HexToUint64 Invalid hex", convert_hex_to_uint64_test_2),
+    Case("Check BytesToBase64 Padding", convert_bytes_to_base64_test_1),
+    Case("Check BytesToBase64 Empty input and high characters", convert_bytes_to_base64_test_2),
+    Case("Check Base64ToBytes Round trip", convert_base64_to_bytes_test_1),
+    Case("Check Base64ToBytes Invalid input", convert_base64_to_bytes_test_2)
 
 };
 
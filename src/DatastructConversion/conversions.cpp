@@ -193,4 +193,99 @@ double StringToDouble (std::string s)
     return std::stod(s);
 }
 
+/**
+ *  @brief  Converts a 64-bit unsigned integer to string-type hex.
+ *  @param  i Integer to be converted to hex string
+ *  @return Hexadecimal of string format, without leading zeros
+ */
+std::string Uint64ToHex(uint64_t i)
+{
+    std::stringstream stream;
+    stream << std::hex << i;
+    return stream.str();
+}
+
+/**
+ *  @brief  Converts string-type hex to a 64-bit unsigned integer. Inverse of Uint64ToHex.
+ *  @param  str Hexadecimal of string format, with or without "0x" prefix
+ *  @return Integer value of str, or 0 if str is not valid hex
+ */
+uint64_t HexToUint64(const std::string& str)
+{
+    return std::strtoull(str.c_str(), NULL, 16);
+}
+
+/**
+ *  @brief  Converts a byte array to a standard (RFC 4648) base64 string, with '=' padding.
+ *  @param  data Bytes to be encoded
+ *  @param  len  Number of bytes in data
+ *  @return Base64 of string format, 4 characters for every 3 bytes
+ */
+std::string BytesToBase64(const uint8_t* data, size_t len)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve(((len + 2) / 3) * 4);
+    for (size_t i = 0; i < len; i += 3)
+    {
+        uint32_t group = (uint32_t)data[i] << 16;
+        if (i + 1 < len) group |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len) group |= data[i + 2];
+        out += alphabet[(group >> 18) & 0x3F];
+        out += alphabet[(group >> 12) & 0x3F];
+        out += (i + 1 < len) ? alphabet[(group >> 6) & 0x3F] : '=';
+        out += (i + 2 < len) ? alphabet[group & 0x3F] : '=';
+    }
+    return out;
+}
+
+/**
+ *  @brief  Converts a standard (RFC 4648) base64 string to bytes. Inverse of BytesToBase64.
+ *  @param  str     Base64 of string format, with '=' padding
+ *  @param  out     Buffer to store the decoded bytes
+ *  @param  max_len Size of out in bytes
+ *  @return Number of decoded bytes, or -1 if str is not valid base64 or does not fit in out
+ */
+int Base64ToBytes(const std::string& str, uint8_t* out, size_t max_len)
+{
+    if (str.size() % 4 != 0)
+    {
+        return -1;
+    }
+    size_t len = 0;
+    for (size_t i = 0; i < str.size(); i += 4)
+    {
+        uint32_t group = 0;
+        size_t padding = 0;
+        for (size_t j = 0; j < 4; j++)
+        {
+            char c = str[i + j];
+            uint32_t v;
+            if (c >= 'A' && c <= 'Z') v = c - 'A';
+            else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+            else if (c >= '0' && c <= '9') v = c - '0' + 52;
+            else if (c == '+') v = 62;
+            else if (c == '/') v = 63;
+            else if (c == '=' && i + 4 == str.size() && j >= 2) { v = 0; padding++; }
+            else return -1;
+            // Padding may only be followed by padding
+            if (padding > 0 && c != '=')
+            {
+                return -1;
+            }
+            group = (group << 6) | v;
+        }
+        size_t count = 3 - padding;
+        if (len + count > max_len)
+        {
+            return -1;
+        }
+        for (size_t j = 0; j < count; j++)
+        {
+            out[len++] = (group >> (16 - 8 * j)) & 0xFF;
+        }
+    }
+    return len;
+}
+
 /** @}*/
\ No newline at end of file
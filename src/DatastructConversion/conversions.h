@@ -32,5 +32,9 @@ std::time_t StringToTime(const std::string& str);
 std::string ToUpperCase (std::string s);
 std::string ToLowerCase (std::string s);
 double StringToDouble (std::string s);
+std::string Uint64ToHex(uint64_t i);
+uint64_t HexToUint64(const std::string& str);
+std::string BytesToBase64(const uint8_t* data, size_t len);
+int Base64ToBytes(const std::string& str, uint8_t* out, size_t max_len);
 
 #endif  // CONVERSIONS_H
\ No newline at end of file
@@ -39,4 +39,27 @@ void DistributeControlMessage (std::string param, int value, std::string msg_id,
     }
 }
 
+/**
+ *  @brief  Forward a model update message from MQTT subscribe to the sensor thread.
+ *          The value is kept as a string because model chunks are base64 data.
+ *  @param  param   model_update_begin, model_update_chunk, model_update_commit or model_update_abort
+ *  @param  value   string value of the parameter
+ */
+void DistributeModelUpdateMessage (std::string param, std::string value, std::string msg_id, std::string endpoint_id)
+{
+    model_update_mail_t *model_update_mail = model_update_mail_box.calloc();
+    while (model_update_mail == NULL)
+    {
+        model_update_mail = model_update_mail_box.calloc();
+        tr_warn("Memory full. NULL pointer allocated");
+        wait(0.5);
+    }
+
+    model_update_mail->param = StringToChar(param);
+    model_update_mail->value = StringToChar(value);
+    model_update_mail->msg_id = StringToChar(msg_id);
+    model_update_mail->endpoint_id = StringToChar(endpoint_id);
+    model_update_mail_box.put(model_update_mail);
+}
+
 /** @}*/
\ No newline at end of file
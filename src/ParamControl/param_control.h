@@ -19,5 +19,6 @@
 #include <string>
 
 void DistributeControlMessage (std::string param, int value, std::string msg_id, std::string endpoint_id);
+void DistributeModelUpdateMessage (std::string param, std::string value, std::string msg_id, std::string endpoint_id);
 
 #endif  // PARAM_CONTROL_H
\ No newline at end of file
@@ -36,6 +36,24 @@ namespace PersistKey
     KeyName CLIENT_CERTIFICATE =            {"client_certificate"};
     KeyName CLIENT_CERTIFICATE_SN =         {"client_certificate_sn"};
     KeyName SSL_PRIVATE_KEY =               {"ssl_private_key"};    
+
+    /* Camera Sliding Window */
+    KeyName CAMERA_WINDOW_LENGTH =          {"camera_window_length"};
+    KeyName CAMERA_WINDOW_STRIDE =          {"camera_window_stride"};
+    KeyName CAMERA_WINDOW_ROW_OFFSET =      {"camera_window_row_offset"};
+    KeyName CAMERA_WINDOW_COL_OFFSET =      {"camera_window_col_offset"};
+    KeyName CAMERA_WINDOW_MASK =            {"camera_window_mask"};
+
+    /* Camera Detection Cascade */
+    KeyName CAMERA_PREFILTER_THRESHOLD =    {"camera_prefilter_threshold"};
+    KeyName CAMERA_TRACKER_DECAY =          {"camera_tracker_decay"};
+    KeyName CAMERA_TRACKER_MOTION =         {"camera_tracker_motion"};
+    KeyName CAMERA_CACHE_SIZE =             {"camera_cache_size"};
+    KeyName CAMERA_GRID_TELEMETRY =         {"camera_grid_telemetry"};
+    KeyName CAMERA_INFERENCE_BUDGET =       {"camera_inference_budget"};
+    KeyName CAMERA_PRIORITY_MASK =          {"camera_priority_mask"};
+    KeyName CAMERA_MODEL =                  {"camera_model"};
+    KeyName CAMERA_PERSON_THRESHOLD =       {"camera_person_threshold"};
 }
 
 using namespace std;
@@ -188,6 +206,174 @@ void WriteSSLPrivateKey(const std::string key)
     );
 }
 
+/**
+ *  @brief  Writes camera sliding window length to flash memory.
+ *  @param  length side length of each window in camera pixels
+ */
+void WriteCameraWindowLength(const std::string length)
+{
+    WriteKey(
+        PersistKey::CAMERA_WINDOW_LENGTH,
+        length
+    );
+}
+
+/**
+ *  @brief  Writes camera sliding window stride to flash memory.
+ *  @param  stride distance between neighbouring windows in camera pixels
+ */
+void WriteCameraWindowStride(const std::string stride)
+{
+    WriteKey(
+        PersistKey::CAMERA_WINDOW_STRIDE,
+        stride
+    );
+}
+
+/**
+ *  @brief  Writes camera sliding window row offset to flash memory.
+ *  @param  offset first row of the window grid
+ */
+void WriteCameraWindowRowOffset(const std::string offset)
+{
+    WriteKey(
+        PersistKey::CAMERA_WINDOW_ROW_OFFSET,
+        offset
+    );
+}
+
+/**
+ *  @brief  Writes camera sliding window column offset to flash memory.
+ *  @param  offset first column of the window grid
+ */
+void WriteCameraWindowColOffset(const std::string offset)
+{
+    WriteKey(
+        PersistKey::CAMERA_WINDOW_COL_OFFSET,
+        offset
+    );
+}
+
+/**
+ *  @brief  Writes camera sliding window cell enable mask to flash memory.
+ *  @param  mask bitmask of enabled cells, in hexadecimal
+ */
+void WriteCameraWindowMask(const std::string mask)
+{
+    WriteKey(
+        PersistKey::CAMERA_WINDOW_MASK,
+        mask
+    );
+}
+
+/**
+ *  @brief  Writes camera pre-filter edge energy threshold to flash memory.
+ *  @param  threshold minimum edge energy for a window to reach the model
+ */
+void WriteCameraPrefilterThreshold(const std::string threshold)
+{
+    WriteKey(
+        PersistKey::CAMERA_PREFILTER_THRESHOLD,
+        threshold
+    );
+}
+
+/**
+ *  @brief  Writes camera occupancy tracker confidence decay to flash memory.
+ *  @param  decay per-frame confidence decay factor, in 1/256 units
+ */
+void WriteCameraTrackerDecay(const std::string decay)
+{
+    WriteKey(
+        PersistKey::CAMERA_TRACKER_DECAY,
+        decay
+    );
+}
+
+/**
+ *  @brief  Writes camera occupancy tracker motion threshold to flash memory.
+ *  @param  threshold mean absolute thumbnail change that forces re-inference, in grey levels
+ */
+void WriteCameraTrackerMotion(const std::string threshold)
+{
+    WriteKey(
+        PersistKey::CAMERA_TRACKER_MOTION,
+        threshold
+    );
+}
+
+/**
+ *  @brief  Writes camera inference result cache size to flash memory.
+ *  @param  size number of cached window results
+ */
+void WriteCameraCacheSize(const std::string size)
+{
+    WriteKey(
+        PersistKey::CAMERA_CACHE_SIZE,
+        size
+    );
+}
+
+/**
+ *  @brief  Writes camera occupancy grid telemetry flag to flash memory.
+ *  @param  enable "1" to publish the occupancy grid, "0" otherwise
+ */
+void WriteCameraGridTelemetry(const std::string enable)
+{
+    WriteKey(
+        PersistKey::CAMERA_GRID_TELEMETRY,
+        enable
+    );
+}
+
+/**
+ *  @brief  Writes camera inference budget per poll to flash memory.
+ *  @param  budget inference time budget in milliseconds
+ */
+void WriteCameraInferenceBudget(const std::string budget)
+{
+    WriteKey(
+        PersistKey::CAMERA_INFERENCE_BUDGET,
+        budget
+    );
+}
+
+/**
+ *  @brief  Writes camera window priority mask to flash memory.
+ *  @param  mask hexadecimal bitmask of high-priority window cells
+ */
+void WriteCameraPriorityMask(const std::string mask)
+{
+    WriteKey(
+        PersistKey::CAMERA_PRIORITY_MASK,
+        mask
+    );
+}
+
+/**
+ *  @brief  Writes camera active model id to flash memory.
+ *  @param  id index of the model in the camera model table
+ */
+void WriteCameraModel(const std::string id)
+{
+    WriteKey(
+        PersistKey::CAMERA_MODEL,
+        id
+    );
+}
+
+/**
+ *  @brief  Writes camera person detection threshold to flash memory.
+ *  @param  threshold person probability, in percent, at which a window counts as a person
+ */
+void WriteCameraPersonThreshold(const std::string threshold)
+{
+    WriteKey(
+        PersistKey::CAMERA_PERSON_THRESHOLD,
+        threshold
+    );
+}
+
 ////////////////////////////////////////////////////////////////////
 //
 //   Public functions for reading from persistent storage
@@ -309,6 +495,146 @@ std::string ReadSSLPrivateKey(void)
     return ssl_private_key;
 }
 
+/**
+ *  @brief  Reads the camera sliding window length from flash memory.
+ *  @return Window length, or an empty string if never written
+ */
+std::string ReadCameraWindowLength(void)
+{
+    std::string length = ReadKey(PersistKey::CAMERA_WINDOW_LENGTH);
+    return length;
+}
+
+/**
+ *  @brief  Reads the camera sliding window stride from flash memory.
+ *  @return Window stride, or an empty string if never written
+ */
+std::string ReadCameraWindowStride(void)
+{
+    std::string stride = ReadKey(PersistKey::CAMERA_WINDOW_STRIDE);
+    return stride;
+}
+
+/**
+ *  @brief  Reads the camera sliding window row offset from flash memory.
+ *  @return Window grid row offset, or an empty string if never written
+ */
+std::string ReadCameraWindowRowOffset(void)
+{
+    std::string offset = ReadKey(PersistKey::CAMERA_WINDOW_ROW_OFFSET);
+    return offset;
+}
+
+/**
+ *  @brief  Reads the camera sliding window column offset from flash memory.
+ *  @return Window grid column offset, or an empty string if never written
+ */
+std::string ReadCameraWindowColOffset(void)
+{
+    std::string offset = ReadKey(PersistKey::CAMERA_WINDOW_COL_OFFSET);
+    return offset;
+}
+
+/**
+ *  @brief  Reads the camera sliding window cell enable mask from flash memory.
+ *  @return Cell enable mask in hexadecimal, or an empty string if never written
+ */
+std::string ReadCameraWindowMask(void)
+{
+    std::string mask = ReadKey(PersistKey::CAMERA_WINDOW_MASK);
+    return mask;
+}
+
+/**
+ *  @brief  Reads the camera pre-filter edge energy threshold from flash memory.
+ *  @return Pre-filter threshold, or an empty string if never written
+ */
+std::string ReadCameraPrefilterThreshold(void)
+{
+    std::string threshold = ReadKey(PersistKey::CAMERA_PREFILTER_THRESHOLD);
+    return threshold;
+}
+
+/**
+ *  @brief  Reads the camera occupancy tracker confidence decay from flash memory.
+ *  @return Tracker decay factor, or an empty string if never written
+ */
+std::string ReadCameraTrackerDecay(void)
+{
+    std::string decay = ReadKey(PersistKey::CAMERA_TRACKER_DECAY);
+    return decay;
+}
+
+/**
+ *  @brief  Reads the camera occupancy tracker motion threshold from flash memory.
+ *  @return Tracker motion threshold, or an empty string if never written
+ */
+std::string ReadCameraTrackerMotion(void)
+{
+    std::string threshold = ReadKey(PersistKey::CAMERA_TRACKER_MOTION);
+    return threshold;
+}
+
+/**
+ *  @brief  Reads the camera inference result cache size from flash memory.
+ *  @return Number of cached window results, or an empty string if never written
+ */
+std::string ReadCameraCacheSize(void)
+{
+    std::string size = ReadKey(PersistKey::CAMERA_CACHE_SIZE);
+    return size;
+}
+
+/**
+ *  @brief  Reads the camera occupancy grid telemetry flag from flash memory.
+ *  @return "1" if the occupancy grid is published, or an empty string if never written
+ */
+std::string ReadCameraGridTelemetry(void)
+{
+    std::string enable = ReadKey(PersistKey::CAMERA_GRID_TELEMETRY);
+    return enable;
+}
+
+/**
+ *  @brief  Reads the camera inference budget per poll from flash memory.
+ *  @return Inference time budget in milliseconds, or an empty string if never written
+ */
+std::string ReadCameraInferenceBudget(void)
+{
+    std::string budget = ReadKey(PersistKey::CAMERA_INFERENCE_BUDGET);
+    return budget;
+}
+
+/**
+ *  @brief  Reads the camera window priority mask from flash memory.
+ *  @return Hexadecimal bitmask of high-priority window cells, or an empty string if never written
+ */
+std::string ReadCameraPriorityMask(void)
+{
+    std::string mask = ReadKey(PersistKey::CAMERA_PRIORITY_MASK);
+    return mask;
+}
+
+/**
+ *  @brief  Reads the camera active model id from flash memory.
+ *  @return Index of the model in the camera model table, or an empty string if never written
+ */
+std::string ReadCameraModel(void)
+{
+    std::string id = ReadKey(PersistKey::CAMERA_MODEL);
+    return id;
+}
+
+/**
+ *  @brief  Reads the camera person detection threshold from flash memory.
+ *  @return Person probability threshold in percent, or an empty string if never written
+ */
+std::string ReadCameraPersonThreshold(void)
+{
+    std::string threshold = ReadKey(PersistKey::CAMERA_PERSON_THRESHOLD);
+    return threshold;
+}
+
 ////////////////////////////////////////////////////////////////////
 //
 //   Helper functions for interfacing with global KVStore API
@@ -30,6 +30,20 @@ void WriteCycleInterval(const std::string interval);
 void WriteClientCertificate(const std::string cert);
 void WriteClientCertificateSerialNumber(const std::string cert_sn);
 void WriteSSLPrivateKey(const std::string key);
+void WriteCameraWindowLength(const std::string length);
+void WriteCameraWindowStride(const std::string stride);
+void WriteCameraWindowRowOffset(const std::string offset);
+void WriteCameraWindowColOffset(const std::string offset);
+void WriteCameraWindowMask(const std::string mask);
+void WriteCameraPrefilterThreshold(const std::string threshold);
+void WriteCameraTrackerDecay(const std::string decay);
+void WriteCameraTrackerMotion(const std::string threshold);
+void WriteCameraCacheSize(const std::string size);
+void WriteCameraGridTelemetry(const std::string enable);
+void WriteCameraInferenceBudget(const std::string budget);
+void WriteCameraPriorityMask(const std::string mask);
+void WriteCameraModel(const std::string id);
+void WriteCameraPersonThreshold(const std::string threshold);
 
 PersistConfig ReadConfig(void);
 time_t ReadSystemTime(void);
@@ -41,5 +55,19 @@ std::string ReadCycleInterval(void);
 std::string ReadClientCertificate(void);
 std::string ReadClientCertificateSerialNumber(void);
 std::string ReadSSLPrivateKey(void);
+std::string ReadCameraWindowLength(void);
+std::string ReadCameraWindowStride(void);
+std::string ReadCameraWindowRowOffset(void);
+std::string ReadCameraWindowColOffset(void);
+std::string ReadCameraWindowMask(void);
+std::string ReadCameraPrefilterThreshold(void);
+std::string ReadCameraTrackerDecay(void);
+std::string ReadCameraTrackerMotion(void);
+std::string ReadCameraCacheSize(void);
+std::string ReadCameraGridTelemetry(void);
+std::string ReadCameraInferenceBudget(void);
+std::string ReadCameraPriorityMask(void);
+std::string ReadCameraModel(void);
+std::string ReadCameraPersonThreshold(void);
 
 #endif // PERSIST_STORE_H
\ No newline at end of file
@@ -20,7 +20,9 @@
 \
 \
 /* Sensor Thread*/ \
-X(POLL_RATE_UPDATE, "poll_rate_updated")
+X(POLL_RATE_UPDATE, "poll_rate_updated") \
+X(CAMERA_CONFIG_UPDATE, "camera_config_updated") \
+X(MODEL_UPDATE, "model_update_accepted")
 /* --------------------------------------- */
 #define X(code, value) code,
 enum Trace : size_t
@@ -26,8 +26,9 @@ void event_manager_thread(void)
         // Wait for MQTT connection to be up before continuing
         event_flags.wait_all(FLAG_MQTT_OK, osWaitForever, false);
         
+        // Handle every pending message, so that a model update streamed in many chunks is not throttled
         osEvent evt = mqtt_arrived_mail_box.get(1); 
-        if (evt.status == osEventMail) 
+        while (evt.status == osEventMail) 
         {
             mqtt_arrived_mail_t *mqtt_arrived_mail = (mqtt_arrived_mail_t*) evt.value.p;
             std::string endpoint_id = mqtt_arrived_mail->endpoint_id;
@@ -37,11 +38,21 @@ void event_manager_thread(void)
             std::string param = mqtt_arrived_mail->param;
             free(mqtt_arrived_mail->param);
             std::string value = mqtt_arrived_mail->value;
+            free(mqtt_arrived_mail->value);
 
-            int int_value = StringToInt(value);
-            DistributeControlMessage(param, int_value, msg_id, endpoint_id);
+            if (param.find("model_update_") == 0)
+            {
+                DistributeModelUpdateMessage(param, value, msg_id, endpoint_id);
+            }
+            else
+            {
+                int int_value = StringToInt(value);
+                DistributeControlMessage(param, int_value, msg_id, endpoint_id);
+            }
 
             mqtt_arrived_mail_box.free(mqtt_arrived_mail);
+            watchdog.kick();
+            evt = mqtt_arrived_mail_box.get(1);
         }
 
         watchdog.kick();
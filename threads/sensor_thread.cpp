@@ -18,7 +18,7 @@
 
 #define TMP75_ADDR      0x4B
 
-void execute_sensor_control(int& current_cycle_interval)
+void execute_sensor_control(int& current_cycle_interval, Ardu_Camera& camera)
 {
     #undef TRACE_GROUP
     #define TRACE_GROUP "SensorThread"
@@ -44,12 +44,59 @@ void execute_sensor_control(int& current_cycle_interval)
             WriteCycleInterval(to_string(value*1000));          // Convert to miliseconds and save to persistence 
             current_cycle_interval = value*1000;
         }
+        else if (param.find("sensor_camera_") == 0)
+        {
+            if (camera.Configure(param, value))
+            {
+                tr_info("Camera parameter %s changed to %d", param.c_str(), value);
+                DecadaServiceResponse(endpoint_id, msg_id, trace_name[CAMERA_CONFIG_UPDATE]);
+            }
+            else
+            {
+                tr_warn("Camera parameter %s rejected value %d", param.c_str(), value);
+            }
+        }
         sensor_control_mail_box.free(sensor_control_mail);
     }
 
     return;
 }
 
+void execute_model_update(Ardu_Camera& camera)
+{
+    #undef TRACE_GROUP
+    #define TRACE_GROUP "SensorThread"
+
+    /* Handle every pending chunk, each is acknowledged so the sender can pace the transfer */
+    osEvent evt = model_update_mail_box.get(1);
+    while (evt.status == osEventMail)
+    {
+        model_update_mail_t *model_update_mail = (model_update_mail_t *)evt.value.p;
+        std::string param = model_update_mail->param;
+        free(model_update_mail->param);
+        std::string value = model_update_mail->value;
+        free(model_update_mail->value);
+        std::string msg_id = model_update_mail->msg_id;
+        free(model_update_mail->msg_id);
+        std::string endpoint_id = model_update_mail->endpoint_id;
+        free(model_update_mail->endpoint_id);
+        model_update_mail_box.free(model_update_mail);
+
+        if (camera.UpdateModel(param, value))
+        {
+            DecadaServiceResponse(endpoint_id, msg_id, trace_name[MODEL_UPDATE]);
+        }
+        else
+        {
+            tr_warn("Model update %s rejected", param.c_str());
+        }
+        Watchdog::get_instance().kick();
+        evt = model_update_mail_box.get(1);
+    }
+
+    return;
+}
+
  /* [rtos: thread_3] SensorThread */
 void sensor_thread(void)
 {   
@@ -71,6 +118,7 @@ void sensor_thread(void)
     int current_cycle_interval = StringToInt(ReadCycleInterval());
     int current_poll_count = current_cycle_interval / sensor_thread_sleep_ms;
     int poll_counter = 0;
+    bool camera_pending = false;
 
     tr_debug("Initializing camera class");
     // Statically allocate memory to avoid runtime memory allocation issues
@@ -93,6 +141,23 @@ void sensor_thread(void)
         tr_debug("Poll_counter: %d", poll_counter);
         if (poll_counter == 0)
         {
+            std::vector<std::pair<std::string, std::string>> s_data;
+
+            /* Poll other sensors here */
+            if (!camera_pending)
+            {
+                tr_info("Polling camera sensor");
+            }
+            int cam_stat = arducam.GetData(s_data);
+            camera_pending = (cam_stat == SensorType::DATA_PENDING);
+            if (camera_pending)
+            {
+                /* Inference runs on the inference thread; service control messages and poll again */
+                execute_sensor_control(current_cycle_interval, arducam);
+                execute_model_update(arducam);
+                continue;
+            }
+
             tr_debug("Adding header to sensor data stream");
             /* Start of sensor data stream - Add header */
             llp_sensor_mail_t * llp_mail = llp_sensor_mail_box.calloc();
@@ -107,30 +172,28 @@ void sensor_thread(void)
             llp_mail->raw_time_stamp = RawRtcTimeNow();
             llp_sensor_mail_box.put(llp_mail);
 
-            std::vector<std::pair<std::string, std::string>> s_data;
-
-            /* Poll other sensors here */
-            tr_info("Polling camera sensor");
-            int cam_stat = arducam.GetData(s_data);
             if (cam_stat == SensorType::DATA_NOT_RDY || cam_stat == SensorType::DATA_CRC_ERR)
             {
                 tr_warn("Camera data error");
             }
             if (cam_stat == SensorType::DATA_OK)
             {   
-
-                llp_mail = llp_sensor_mail_box.calloc();
-                while (llp_mail == NULL)
+                /* Publish every measure point reported by the camera */
+                for (size_t i = 0; i < s_data.size(); i++)
                 {
                     llp_mail = llp_sensor_mail_box.calloc();
-                    tr_warn("Memory full. NULL pointer allocated");
-                    ThisThread::sleep_for(500);
+                    while (llp_mail == NULL)
+                    {
+                        llp_mail = llp_sensor_mail_box.calloc();
+                        tr_warn("Memory full. NULL pointer allocated");
+                        ThisThread::sleep_for(500);
+                    }
+
+                    llp_mail->sensor_type = StringToChar(s_data[i].first);
+                    llp_mail->value = StringToChar(s_data[i].second);
+                    llp_mail->raw_time_stamp = RawRtcTimeNow();
+                    llp_sensor_mail_box.put(llp_mail);
                 }
-
-                llp_mail->sensor_type = StringToChar(s_data[0].first);
-                llp_mail->value = StringToChar(s_data[0].second);
-                llp_mail->raw_time_stamp = RawRtcTimeNow();
-                llp_sensor_mail_box.put(llp_mail);
             }
 
 
@@ -156,7 +219,8 @@ void sensor_thread(void)
             poll_counter = 0;
         }
 
-        execute_sensor_control(current_cycle_interval);
+        execute_sensor_control(current_cycle_interval, arducam);
+        execute_model_update(arducam);
         
         watchdog.kick();
 
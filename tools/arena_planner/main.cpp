@@ -0,0 +1,199 @@
+/*  Host tool: compute an offline memory plan for a camera model and embed it in the model,
+    so that TFLM places the activation tensors at the planned offsets instead of running its
+    greedy planner at every start-up.
+
+    Build from the repository root like tools/arena_sizer, with the TFLM options of
+    mbed_app.json, then run on a model and write the planned model:
+
+    g++ -m32 -std=c++11 -O2 -DNDEBUG -DTF_LITE_MICRO_OPTIMIZED_KERNELS=1 \
+        -DTF_LITE_MICRO_FUSE_OPERATORS=1 -DTF_LITE_MICRO_REPACK_MAX_FILTER_BYTES=0 \
+        -I lib -I lib/third_party/flatbuffers/include \
+        -I lib/third_party/gemmlowp -I lib/third_party/ruy -I sensors-lib/camera \
+        tools/arena_planner/main.cpp sensors-lib/camera/model/ArenaPlanner.cpp \
+        sensors-lib/camera/model/ArenaSizer.cpp \
+        $(find lib/tensorflow -name '*.cc' -not -path '*mbed*' -not -path '*testing*' \
+            -not -path '*benchmarks*' -not -name 'test_helpers.cc') \
+        -x c lib/tensorflow/lite/c/common.c -x none \
+        -o arena_planner
+    ./arena_planner sensors-lib/camera/model_data/person_detection_int8/model_data.cc \
+        sensors-lib/camera/model_data/person_detection_int8/model_data.cc [iterations]
+
+    Models are read from and written to .tflite files or model_data.cc style C arrays.
+    The tool checks that the interpreter takes the plan as is; rerun tools/arena_sizer on the
+    planned model afterwards. This directory is listed in .mbedignore, so the tool is not part
+    of the firmware.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "model/ArenaPlanner.h"
+#include "model/ArenaSizer.h"
+#include "model_data/model_op_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+
+static constexpr int default_iterations = 20000;
+static constexpr int startup_runs = 20;
+static constexpr size_t scratch_arena_size = 4 * 1024 * 1024;
+alignas(16) static uint8_t scratch_arena[scratch_arena_size];
+
+// TFLM debug output, provided by lib/tensorflow/lite/micro/mbed on the device
+extern "C" void DebugLog(const char* s)
+{
+    fputs(s, stderr);
+}
+
+static bool ends_with(const std::string& text, const std::string& suffix)
+{
+    return text.size() > suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Symbol and header of the C array written by save_model, taken from the model read if it is a C array
+static std::string array_symbol = "g_person_detect_model_data";
+static std::string array_header = "model_data/person_detection_int8/model_data.h";
+
+// Read a .tflite file, or the hexadecimal bytes of the array in a C source file
+static bool load_model(const std::string& path, std::vector<unsigned char>& data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string text = contents.str();
+    if (ends_with(path, ".tflite")) {
+        data.assign(text.begin(), text.end());
+        return !data.empty();
+    }
+    size_t pos = text.find('{', text.find("[]"));
+    size_t end = text.rfind('}');
+    if (pos == std::string::npos || end == std::string::npos) {
+        return false;
+    }
+    size_t symbol_end = text.find("[]");
+    size_t symbol_start = text.find_last_of(" \t", symbol_end) + 1;
+    array_symbol = text.substr(symbol_start, symbol_end - symbol_start);
+    size_t header_start = text.find("#include \"");
+    if (header_start != std::string::npos && header_start < pos) {
+        header_start += strlen("#include \"");
+        array_header = text.substr(header_start, text.find('"', header_start) - header_start);
+    }
+    while ((pos = text.find("0x", pos)) != std::string::npos && pos < end) {
+        data.push_back(strtoul(text.substr(pos + 2, 2).c_str(), nullptr, 16));
+        pos += 4;
+    }
+    return !data.empty();
+}
+
+// Write a .tflite file, or a C array in the layout of model_data.cc (see tools/tflite_reader.py)
+static bool save_model(const std::string& path, const std::vector<uint8_t>& data)
+{
+    FILE* out = fopen(path.c_str(), ends_with(path, ".tflite") ? "wb" : "w");
+    if (out == nullptr) {
+        return false;
+    }
+    if (ends_with(path, ".tflite")) {
+        fwrite(data.data(), 1, data.size(), out);
+    } else {
+        fprintf(out, "#include \"%s\"\n\n", array_header.c_str());
+        fprintf(out, "// Keep model aligned to 8 bytes to guarantee aligned 64-bit accesses.\n");
+        fprintf(out, "alignas(8) const unsigned char %s[] = {\n", array_symbol.c_str());
+        for (size_t i = 0; i < data.size(); i += 13) {
+            fprintf(out, "   ");
+            for (size_t j = i; j < i + 13 && j < data.size(); j++) {
+                fprintf(out, " 0x%02x,", data[j]);
+            }
+            fprintf(out, "\n");
+        }
+        fprintf(out, "};\nconst int %s_len = %zu;\n", array_symbol.c_str(), data.size());
+    }
+    fclose(out);
+    return true;
+}
+
+// Average time of AllocateTensors, which runs the memory planner, in microseconds
+static long startup_us(const tflite::Model* model, const tflite::MicroOpResolver& resolver,
+    tflite::ErrorReporter* error_reporter)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < startup_runs; i++) {
+        tflite::MicroInterpreter interpreter(model, resolver, scratch_arena, scratch_arena_size, error_reporter);
+        if (interpreter.AllocateTensors() != kTfLiteOk) {
+            return -1;
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / startup_runs;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <model.tflite|model_data.cc> <out.tflite|out.cc> [iterations]\n", argv[0]);
+        return 1;
+    }
+    const int iterations = (argc > 3) ? atoi(argv[3]) : default_iterations;
+    static tflite::MicroErrorReporter error_reporter;
+    static ModelOpResolver resolver(&error_reporter);
+    if (RegisterModelOps(resolver) != kTfLiteOk) {
+        return 1;
+    }
+
+    // The model is kept in an aligned copy, as the flatbuffer in flash is
+    std::vector<unsigned char> data;
+    if (!load_model(argv[1], data)) {
+        fprintf(stderr, "Cannot read model %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<uint64_t> aligned((data.size() + 7) / 8);
+    memcpy(aligned.data(), data.data(), data.size());
+    const tflite::Model* model = tflite::GetModel(aligned.data());
+
+    std::vector<int32_t> offsets;
+    std::vector<uint8_t> planned_data;
+    arena_plan_t plan;
+    if (!ArenaPlanner::Plan(model, resolver, scratch_arena, scratch_arena_size, iterations,
+                &error_reporter, offsets, plan)
+            || !ArenaPlanner::Embed(model, offsets, planned_data)) {
+        fprintf(stderr, "Cannot plan model %s\n", argv[1]);
+        return 1;
+    }
+    printf("%s: %d tensors, %d orders tried\n", argv[1], plan.tensor_count, plan.orders_tried);
+    printf("  lower bound: %zu bytes\n", plan.lower_bound_bytes);
+    printf("  greedy plan: %zu bytes\n", plan.greedy_bytes);
+    printf("  offline plan: %zu bytes\n", plan.planned_bytes);
+
+    std::vector<uint64_t> planned_aligned((planned_data.size() + 7) / 8);
+    memcpy(planned_aligned.data(), planned_data.data(), planned_data.size());
+    const tflite::Model* planned_model = tflite::GetModel(planned_aligned.data());
+    arena_usage_t usage, planned_usage;
+    if (!ArenaSizer::Measure(model, resolver, scratch_arena, scratch_arena_size, &error_reporter, usage)
+            || !ArenaSizer::Measure(planned_model, resolver, scratch_arena, scratch_arena_size,
+                &error_reporter, planned_usage)) {
+        fprintf(stderr, "Cannot allocate model %s\n", argv[1]);
+        return 1;
+    }
+    printf("  interpreter head: %zu bytes online, %zu bytes with the offline plan\n",
+        usage.head_bytes, planned_usage.head_bytes);
+    printf("  AllocateTensors: %ld us online, %ld us with the offline plan\n",
+        startup_us(model, resolver, &error_reporter), startup_us(planned_model, resolver, &error_reporter));
+    if (planned_usage.head_bytes != plan.planned_bytes) {
+        fprintf(stderr, "The interpreter did not take the plan as is, see the messages above\n");
+        return 1;
+    }
+
+    if (!save_model(argv[2], planned_data)) {
+        fprintf(stderr, "Cannot write %s\n", argv[2]);
+        return 1;
+    }
+    printf("Wrote %s: %zu bytes, arena %zu bytes instead of %zu\n", argv[2], planned_data.size(),
+        planned_usage.used_bytes, usage.used_bytes);
+    return 0;
+}
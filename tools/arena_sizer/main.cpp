@@ -0,0 +1,138 @@
+/*  Host tool: measure the tensor arena need of the camera models and write
+    sensors-lib/camera/model_data/model_arena_size.h for Ardu_Camera.
+
+    Build from the repository root with a 32-bit host compiler, so that pointer sizes
+    match the device, and with the TFLM options of mbed_app.json, which change what
+    kernels keep in the arena. Run with every model in the camera_models table:
+
+    g++ -m32 -std=c++11 -O2 -DNDEBUG -DTF_LITE_MICRO_OPTIMIZED_KERNELS=1 \
+        -DTF_LITE_MICRO_FUSE_OPERATORS=1 -DTF_LITE_MICRO_REPACK_MAX_FILTER_BYTES=0 \
+        -I lib -I lib/third_party/flatbuffers/include \
+        -I lib/third_party/gemmlowp -I lib/third_party/ruy -I sensors-lib/camera \
+        tools/arena_sizer/main.cpp sensors-lib/camera/model/ArenaSizer.cpp \
+        $(find lib/tensorflow -name '*.cc' -not -path '*mbed*' -not -path '*testing*' \
+            -not -path '*benchmarks*' -not -name 'test_helpers.cc') \
+        -x c lib/tensorflow/lite/c/common.c -x none \
+        -o arena_sizer
+    ./arena_sizer sensors-lib/camera/model_data/model_arena_size.h \
+        sensors-lib/camera/model_data/person_detection_int8/model_data.cc
+
+    Models are read from .tflite files or from model_data.cc style C arrays.
+    This directory is listed in .mbedignore, so the tool is not part of the firmware.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "model/ArenaSizer.h"
+#include "model_data/model_op_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+
+// Bytes left free after the largest model, for the recording of TFLM debug tools and rounding
+static constexpr size_t arena_headroom = 500;
+static constexpr size_t scratch_arena_size = 4 * 1024 * 1024;
+alignas(16) static uint8_t scratch_arena[scratch_arena_size];
+
+// TFLM debug output, provided by lib/tensorflow/lite/micro/mbed on the device
+extern "C" void DebugLog(const char* s)
+{
+    fputs(s, stderr);
+}
+
+// Read a .tflite file, or the hexadecimal bytes of the array in a C source file
+static bool load_model(const std::string& path, std::vector<unsigned char>& data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string text = contents.str();
+    if (path.size() > 7 && path.compare(path.size() - 7, 7, ".tflite") == 0) {
+        data.assign(text.begin(), text.end());
+        return !data.empty();
+    }
+    size_t pos = text.find('{', text.find("[]"));
+    size_t end = text.rfind('}');
+    if (pos == std::string::npos || end == std::string::npos) {
+        return false;
+    }
+    while ((pos = text.find("0x", pos)) != std::string::npos && pos < end) {
+        data.push_back(strtoul(text.substr(pos + 2, 2).c_str(), nullptr, 16));
+        pos += 4;
+    }
+    return !data.empty();
+}
+
+static void print_usage(const char* path, const arena_usage_t& usage, FILE* out, const char* prefix)
+{
+    fprintf(out, "%s%s: %zu bytes\n", prefix, path, usage.used_bytes);
+    fprintf(out, "%s  head (tensor data and scratch buffers): %zu\n", prefix, usage.head_bytes);
+    fprintf(out, "%s  tail (persistent): %zu\n", prefix, usage.tail_bytes);
+    fprintf(out, "%s    TfLiteTensor structs and quantization: %zu\n", prefix, usage.tensor_struct_bytes);
+    fprintf(out, "%s    node and registration structs: %zu\n", prefix, usage.node_registration_bytes);
+    fprintf(out, "%s    operator data: %zu\n", prefix, usage.op_data_bytes);
+    fprintf(out, "%s    variable tensors: %zu\n", prefix, usage.variable_bytes);
+    fprintf(out, "%s    allocator bookkeeping: %zu\n", prefix, usage.other_bytes);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <out.h> <model.tflite|model_data.cc>...\n", argv[0]);
+        return 1;
+    }
+    static tflite::MicroErrorReporter error_reporter;
+    static ModelOpResolver resolver(&error_reporter);
+    if (RegisterModelOps(resolver) != kTfLiteOk) {
+        return 1;
+    }
+
+    std::vector<arena_usage_t> usages;
+    size_t largest = 0;
+    for (int i = 2; i < argc; i++) {
+        // The model is kept in an aligned copy, as the flatbuffer in flash is
+        std::vector<unsigned char> data;
+        if (!load_model(argv[i], data)) {
+            fprintf(stderr, "Cannot read model %s\n", argv[i]);
+            return 1;
+        }
+        std::vector<uint64_t> aligned((data.size() + 7) / 8);
+        memcpy(aligned.data(), data.data(), data.size());
+
+        arena_usage_t usage;
+        if (!ArenaSizer::Measure(tflite::GetModel(aligned.data()), resolver,
+                scratch_arena, scratch_arena_size, &error_reporter, usage)) {
+            fprintf(stderr, "Cannot allocate model %s\n", argv[i]);
+            return 1;
+        }
+        print_usage(argv[i], usage, stdout, "");
+        usages.push_back(usage);
+        largest = (usage.used_bytes > largest) ? usage.used_bytes : largest;
+    }
+
+    FILE* out = fopen(argv[1], "w");
+    if (out == nullptr) {
+        fprintf(stderr, "Cannot write %s\n", argv[1]);
+        return 1;
+    }
+    fprintf(out, "// Generated by tools/arena_sizer (%zu-bit host) with:\n", 8 * sizeof(void*));
+    for (int i = 2; i < argc; i++) {
+        print_usage(argv[i], usages[i - 2], out, "//   ");
+    }
+    fprintf(out, "// Do not edit; rerun the tool when a model changes.\n");
+    fprintf(out, "# ifndef MODEL_ARENA_SIZE_H\n# define MODEL_ARENA_SIZE_H\n\n");
+    fprintf(out, "// Tensor arena bytes needed by the largest model\n");
+    fprintf(out, "constexpr int kModelArenaSize = %zu;\n", largest);
+    fprintf(out, "// Free bytes kept after the largest model\n");
+    fprintf(out, "constexpr int kModelArenaHeadroom = %zu;\n\n", arena_headroom);
+    fprintf(out, "# endif // MODEL_ARENA_SIZE_H\n");
+    fclose(out);
+    printf("Wrote %s: %zu + %zu bytes\n", argv[1], largest, arena_headroom);
+    return 0;
+}
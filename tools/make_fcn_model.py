@@ -0,0 +1,114 @@
+"""Convert the person detection classifier into a fully-convolutional model.
+
+The default model is a MobileNet backbone with an output stride of 32, followed
+by an average pool over the final 3 x 3 feature map and a 1 x 1 conv head.
+Every layer before the pool is convolutional, so the same weights can run on a
+larger input: this tool sets the input to <height> x <width> and changes the
+average pool to a <pool> x <pool> window with the same stride. The model then
+scores a grid of cells in one invoke, with output shape [cells, classes] in
+row-major cell order, where each cell covers 32 * <pool> input pixels.
+
+    pool 3, 288 x 384: 3 x 4 grid of 96 x 96 cells, i.e. the classifier's own
+                       input scale on every cell of a QVGA frame
+    pool 1,  96 x 128: 3 x 4 grid of 32 x 32 cells over a downscaled frame,
+                       much smaller arena but people appear at 1/3 of the
+                       scale the model was trained on
+
+Usage:
+    python tools/make_fcn_model.py <model.tflite|model_data.cc> <height> <width> <pool> <out.tflite|out.cc>
+
+Tensor shapes and pool options are patched in place, so weights and the
+operator graph are left untouched.
+"""
+
+import struct
+import sys
+
+import tflite_reader
+
+# Field indices in tflite::Conv2DOptions, DepthwiseConv2DOptions and Pool2DOptions
+PADDING, STRIDE_W, STRIDE_H, FILTER_W, FILTER_H = 0, 1, 2, 3, 4
+PADDING_SAME = 0
+
+
+def conv_out(length, kernel, stride, padding):
+    if padding == PADDING_SAME:
+        return (length + stride - 1) // stride
+    return (length - kernel + stride) // stride
+
+
+def set_shape(data, tensor, shape):
+    start, length = tensor.table.vector_pos(0)
+    if length != len(shape):
+        raise ValueError("cannot change rank of tensor %s" % tensor.name)
+    for i, dim in enumerate(shape):
+        struct.pack_into("<i", data, start + 4 * i, dim)
+    tensor.shape = list(shape)
+
+
+def set_scalar(data, table, index, value):
+    pos = table.field_pos(index)
+    if pos is None:
+        raise ValueError("pool option %d is not stored in the model" % index)
+    struct.pack_into("<i", data, pos, value)
+
+
+def make_fcn(data, height, width, pool):
+    model = tflite_reader.Model(data)
+    tensors = model.tensors
+    set_shape(data, tensors[model.inputs[0]], [1, height, width, tensors[model.inputs[0]].shape[3]])
+
+    for op in model.operators:
+        src = tensors[op.inputs[0]]
+        dst = tensors[op.outputs[0]]
+        options = op.table.table(4)
+        if op.name in ("CONV_2D", "DEPTHWISE_CONV_2D"):
+            kernel = tensors[op.inputs[1]].shape
+            padding = options.scalar(PADDING, "<b")
+            rows = conv_out(src.shape[1], kernel[1], options.scalar(STRIDE_H, "<i"), padding)
+            cols = conv_out(src.shape[2], kernel[2], options.scalar(STRIDE_W, "<i"), padding)
+            set_shape(data, dst, [1, rows, cols, dst.shape[3]])
+        elif op.name == "AVERAGE_POOL_2D":
+            for index in (STRIDE_W, STRIDE_H, FILTER_W, FILTER_H):
+                set_scalar(data, options, index, pool)
+            padding = options.scalar(PADDING, "<b")
+            rows = conv_out(src.shape[1], pool, pool, padding)
+            cols = conv_out(src.shape[2], pool, pool, padding)
+            set_shape(data, dst, [1, rows, cols, dst.shape[3]])
+        elif op.name == "RESHAPE":
+            classes = src.shape[-1]
+            cells = 1
+            for dim in src.shape[:-1]:
+                cells *= dim
+            set_shape(data, dst, [cells, classes])
+        elif op.name == "SOFTMAX":
+            set_shape(data, dst, src.shape)
+        else:
+            raise ValueError("unsupported op %s" % op.name)
+
+    output = tensors[model.outputs[0]]
+    return output.shape[0]
+
+
+def main(argv):
+    if len(argv) != 6:
+        print(__doc__)
+        return 1
+    data = tflite_reader.load_model_bytes(argv[1])
+    height, width, pool = int(argv[2]), int(argv[3]), int(argv[4])
+    if height % (32 * pool) or width % (32 * pool):
+        print("height and width must be multiples of 32 * pool")
+        return 1
+    cells = make_fcn(data, height, width, pool)
+    print("Input %d x %d, %d cells of %d x %d pixels" % (height, width, cells, 32 * pool, 32 * pool))
+    if argv[5].endswith(".tflite"):
+        with open(argv[5], "wb") as f:
+            f.write(data)
+    else:
+        tflite_reader.write_c_array(argv[5], data, "g_person_detect_model_data",
+                                    "model_data/person_detection_int8/model_data.h")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
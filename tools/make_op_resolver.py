@@ -0,0 +1,99 @@
+"""Generate a minimal TensorFlow Lite Micro op resolver for a set of models.
+
+tflite::AllOpsResolver registers every kernel in lib/tensorflow/lite/micro/kernels,
+so all of them are linked into the firmware. This tool reads the operator codes
+of the given models and writes a header declaring a MicroMutableOpResolver with
+exactly the union of their builtin ops, which TFLM_Model uses instead.
+
+Usage:
+    python tools/make_op_resolver.py <out.h> <model.tflite|model_data.cc>...
+
+List every model in the camera_models table of Ardu_Camera.cpp, and any model
+that will be sent over the air, then rebuild. The default output is
+sensors-lib/camera/model_data/model_op_resolver.h. A model using an op missing
+from the header fails to initialize; set "all-ops-resolver" in mbed_app.json to
+run such a model without regenerating.
+"""
+
+import os
+import re
+import sys
+
+import tflite_reader
+
+RESOLVER_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "lib",
+                               "tensorflow", "lite", "micro", "micro_mutable_op_resolver.h")
+
+
+def add_method(op_name):
+    """Name of the MicroMutableOpResolver method for a builtin op, e.g. CONV_2D -> AddConv2D."""
+    parts = op_name.split("_")
+    return "Add" + "".join(p.capitalize() if p[0].isalpha() else p.upper() for p in parts)
+
+
+def supported_methods():
+    with open(RESOLVER_HEADER) as f:
+        return set(re.findall(r"TfLiteStatus (Add\w+)\(\)", f.read()))
+
+
+def model_ops(path):
+    model = tflite_reader.Model(tflite_reader.load_model_bytes(path))
+    ops = set()
+    for index, (_, custom, _) in enumerate(model.opcodes):
+        if custom:
+            raise ValueError("%s: custom op %s is not supported" % (path, custom))
+        ops.add(model.op_name(index))
+    return ops
+
+
+def write_header(path, ops, sources):
+    methods = [add_method(op) for op in ops]
+    lines = [
+        "// Generated by tools/make_op_resolver.py from:",
+    ]
+    lines += ["//   %s" % source for source in sources]
+    lines += [
+        "// Do not edit; rerun the tool when a model changes.",
+        "# ifndef MODEL_OP_RESOLVER_H",
+        "# define MODEL_OP_RESOLVER_H",
+        "",
+        '#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"',
+        "",
+        "// Builtin ops used by the models: %s" % ", ".join(ops),
+        "constexpr unsigned int kModelOpCount = %d;" % len(ops),
+        "typedef tflite::MicroMutableOpResolver<kModelOpCount> ModelOpResolver;",
+        "",
+        "inline TfLiteStatus RegisterModelOps(ModelOpResolver& resolver)",
+        "{",
+    ]
+    lines += ["    TF_LITE_ENSURE_STATUS(resolver.%s());" % method for method in methods]
+    lines += [
+        "    return kTfLiteOk;",
+        "}",
+        "",
+        "# endif // MODEL_OP_RESOLVER_H",
+    ]
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main(argv):
+    if len(argv) < 3:
+        print(__doc__)
+        return 1
+    ops = set()
+    for source in argv[2:]:
+        ops |= model_ops(source)
+    ops = sorted(ops)
+    missing = [op for op in ops if add_method(op) not in supported_methods()]
+    if missing:
+        print("Ops without a MicroMutableOpResolver method: %s" % ", ".join(missing))
+        return 1
+    sources = [os.path.relpath(source).replace(os.sep, "/") for source in argv[2:]]
+    write_header(argv[1], ops, sources)
+    print("Wrote %d ops to %s: %s" % (len(ops), argv[1], ", ".join(ops)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
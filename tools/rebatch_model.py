@@ -0,0 +1,51 @@
+"""Rewrite the batch dimension of a TensorFlow Lite model.
+
+TFLM_Model packs up to N sliding windows into one invoke when the model input
+has batch dimension N. This tool produces such a model from a batch-1 export by
+patching the leading dimension of every activation tensor in place, so weights
+and operator options are left untouched.
+
+Usage:
+    python tools/rebatch_model.py <model.tflite|model_data.cc> <N> <out.tflite|out.cc>
+
+When writing a .cc file the array keeps the g_person_detect_model_data symbol,
+so the output can replace sensors-lib/camera/model_data/*/model_data.cc as is.
+"""
+
+import struct
+import sys
+
+import tflite_reader
+
+
+def rebatch(data, batch):
+    model = tflite_reader.Model(data)
+    patched = 0
+    for tensor in model.tensors:
+        if tensor.is_constant or not tensor.shape or tensor.shape[0] != 1:
+            continue
+        start, _ = tensor.table.vector_pos(0)
+        struct.pack_into("<i", data, start, batch)
+        patched += 1
+    return patched
+
+
+def main(argv):
+    if len(argv) != 4:
+        print(__doc__)
+        return 1
+    data = tflite_reader.load_model_bytes(argv[1])
+    batch = int(argv[2])
+    patched = rebatch(data, batch)
+    print("Patched batch dimension of %d activation tensors to %d" % (patched, batch))
+    if argv[3].endswith(".tflite"):
+        with open(argv[3], "wb") as f:
+            f.write(data)
+    else:
+        tflite_reader.write_c_array(argv[3], data, "g_person_detect_model_data",
+                                    "model_data/person_detection_int8/model_data.h")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,184 @@
+"""Minimal, dependency-free reader for TensorFlow Lite flatbuffers.
+
+Only the parts of the schema (lib/tensorflow/lite/schema/schema_generated.h)
+used by the model tools in this directory are exposed. Model bytes can be read
+from a .tflite file or from an `xxd -i` style C array such as
+sensors-lib/camera/model_data/person_detection_int8/model_data.cc.
+"""
+
+import re
+import struct
+
+# Subset of tflite::BuiltinOperator, enough to name the ops used by the
+# vendored kernels in lib/tensorflow/lite/micro/kernels.
+BUILTIN_OPS = {
+    0: "ADD", 1: "AVERAGE_POOL_2D", 2: "CONCATENATION", 3: "CONV_2D",
+    4: "DEPTHWISE_CONV_2D", 6: "DEQUANTIZE", 8: "FLOOR", 9: "FULLY_CONNECTED",
+    11: "L2_NORMALIZATION", 14: "LOGISTIC", 17: "MAX_POOL_2D", 18: "MUL",
+    19: "RELU", 21: "RELU6", 22: "RESHAPE", 23: "RESIZE_BILINEAR",
+    25: "SOFTMAX", 28: "TANH", 34: "PAD", 36: "GATHER", 39: "TRANSPOSE",
+    40: "MEAN", 41: "SUB", 42: "DIV", 45: "STRIDED_SLICE", 47: "EXP",
+    49: "SPLIT", 53: "CAST", 54: "PRELU", 55: "MAXIMUM", 56: "ARG_MAX",
+    57: "MINIMUM", 58: "LESS", 59: "NEG", 61: "GREATER",
+    62: "GREATER_EQUAL", 63: "LESS_EQUAL", 66: "SLICE", 71: "EQUAL",
+    72: "NOT_EQUAL", 73: "LOG", 74: "SUM", 75: "SQRT", 76: "RSQRT",
+    78: "POW", 79: "ARG_MIN", 80: "FAKE_QUANT", 82: "REDUCE_MAX",
+    83: "PACK", 84: "LOGICAL_OR", 86: "LOGICAL_AND", 87: "LOGICAL_NOT",
+    88: "UNPACK", 89: "REDUCE_MIN", 90: "FLOOR_DIV", 93: "SQUARE",
+    97: "RESIZE_NEAREST_NEIGHBOR", 98: "LEAKY_RELU", 101: "ABS",
+    104: "CEIL", 114: "QUANTIZE", 117: "HARD_SWISH", 35: "SVDF",
+    27: "SVDF_LEGACY_UNUSED", 10: "HASHTABLE_LOOKUP", 31: "CIRCULAR_BUFFER",
+    12: "LOCAL_RESPONSE_NORMALIZATION", 120: "ROUND",
+}
+
+# tflite::TensorType
+TENSOR_TYPES = {
+    0: ("float32", 4), 1: ("float16", 2), 2: ("int32", 4), 3: ("uint8", 1),
+    4: ("int64", 8), 5: ("string", 1), 6: ("bool", 1), 7: ("int16", 2),
+    8: ("complex64", 8), 9: ("int8", 1),
+}
+
+
+def load_model_bytes(path):
+    """Return the raw flatbuffer bytes of a .tflite file or C array source."""
+    if path.endswith(".tflite"):
+        with open(path, "rb") as f:
+            return bytearray(f.read())
+    with open(path) as f:
+        src = f.read()
+    body = src[src.index("{", src.index("[]")) + 1:src.rindex("}")]
+    return bytearray(int(x, 16) for x in re.findall(r"0x([0-9a-fA-F]{2})", body))
+
+
+def write_c_array(path, data, symbol, header):
+    """Write model bytes as a C array in the same layout as model_data.cc."""
+    lines = []
+    for i in range(0, len(data), 13):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 13]) + ",")
+    with open(path, "w") as f:
+        f.write('#include "%s"\n\n' % header)
+        f.write("// Keep model aligned to 8 bytes to guarantee aligned 64-bit accesses.\n")
+        f.write("alignas(8) const unsigned char %s[] = {\n" % symbol)
+        f.write("\n".join(lines) + "\n};\n")
+        f.write("const int %s_len = %d;\n" % (symbol, len(data)))
+
+
+class Table(object):
+    """A flatbuffer table located at absolute offset `pos` in `buf`."""
+
+    def __init__(self, buf, pos):
+        self.buf = buf
+        self.pos = pos
+        vtable = pos - struct.unpack_from("<i", buf, pos)[0]
+        self.vtable = vtable
+        self.vtable_len = struct.unpack_from("<H", buf, vtable)[0]
+
+    def field_pos(self, index):
+        """Absolute offset of field `index`, or None if it is absent."""
+        slot = 4 + 2 * index
+        if slot >= self.vtable_len:
+            return None
+        off = struct.unpack_from("<H", self.buf, self.vtable + slot)[0]
+        return self.pos + off if off else None
+
+    def scalar(self, index, fmt, default=0):
+        pos = self.field_pos(index)
+        return struct.unpack_from(fmt, self.buf, pos)[0] if pos is not None else default
+
+    def _indirect(self, pos):
+        return pos + struct.unpack_from("<I", self.buf, pos)[0]
+
+    def table(self, index):
+        pos = self.field_pos(index)
+        return Table(self.buf, self._indirect(pos)) if pos is not None else None
+
+    def string(self, index):
+        pos = self.field_pos(index)
+        if pos is None:
+            return None
+        start = self._indirect(pos)
+        length = struct.unpack_from("<I", self.buf, start)[0]
+        return bytes(self.buf[start + 4:start + 4 + length]).decode("utf-8", "replace")
+
+    def vector_pos(self, index):
+        """(absolute offset of the first element, length) of a vector field."""
+        pos = self.field_pos(index)
+        if pos is None:
+            return None, 0
+        start = self._indirect(pos)
+        return start + 4, struct.unpack_from("<I", self.buf, start)[0]
+
+    def scalars(self, index, fmt):
+        start, length = self.vector_pos(index)
+        size = struct.calcsize(fmt)
+        return [struct.unpack_from(fmt, self.buf, start + size * i)[0] for i in range(length)]
+
+    def tables(self, index):
+        start, length = self.vector_pos(index)
+        return [Table(self.buf, self._indirect(start + 4 * i)) for i in range(length)]
+
+
+class Model(object):
+    """Read-only view over the parts of tflite::Model used by the tools."""
+
+    def __init__(self, data):
+        self.data = data
+        self.root = Table(data, struct.unpack_from("<I", data, 0)[0])
+        self.version = self.root.scalar(0, "<I")
+        self.opcodes = []
+        for code in self.root.tables(1):
+            deprecated = code.scalar(0, "<b")
+            builtin = code.scalar(3, "<i")
+            self.opcodes.append((max(deprecated, builtin), code.string(1), code.scalar(2, "<i", 1)))
+        self.subgraph = self.root.tables(2)[0]
+        self.buffers = self.root.tables(4)
+        self.tensors = [Tensor(self, t, i) for i, t in enumerate(self.subgraph.tables(0))]
+        self.inputs = self.subgraph.scalars(1, "<i")
+        self.outputs = self.subgraph.scalars(2, "<i")
+        self.operators = [Operator(self, op, i) for i, op in enumerate(self.subgraph.tables(3))]
+
+    def op_name(self, opcode_index):
+        builtin, custom, _ = self.opcodes[opcode_index]
+        if custom:
+            return custom
+        return BUILTIN_OPS.get(builtin, "BUILTIN_%d" % builtin)
+
+    def metadata(self):
+        """List of (name, buffer index) model metadata entries."""
+        return [(m.string(0), m.scalar(1, "<I")) for m in self.root.tables(6)]
+
+
+class Tensor(object):
+    def __init__(self, model, table, index):
+        self.index = index
+        self.table = table
+        self.shape = table.scalars(0, "<i")
+        self.type = table.scalar(1, "<b")
+        self.buffer = table.scalar(2, "<I")
+        self.name = table.string(3)
+        buf = model.buffers[self.buffer] if self.buffer < len(model.buffers) else None
+        self.is_constant = bool(buf is not None and buf.vector_pos(0)[1] > 0)
+        quant = table.table(4)
+        self.scales = quant.scalars(2, "<f") if quant else []
+        self.zero_points = quant.scalars(3, "<q") if quant else []
+
+    @property
+    def type_name(self):
+        return TENSOR_TYPES.get(self.type, ("unknown", 1))[0]
+
+    @property
+    def num_bytes(self):
+        count = 1
+        for dim in self.shape:
+            count *= dim
+        return count * TENSOR_TYPES.get(self.type, ("unknown", 1))[1]
+
+
+class Operator(object):
+    def __init__(self, model, table, index):
+        self.index = index
+        self.table = table
+        self.opcode_index = table.scalar(0, "<I")
+        self.name = model.op_name(self.opcode_index)
+        self.inputs = table.scalars(1, "<i")
+        self.outputs = table.scalars(2, "<i")